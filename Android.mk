@@ -69,6 +69,11 @@ LOCAL_SRC_FILES := \
     src/survive_driverman.c \
     src/survive_kalman_lighthouses.c \
     src/survive_kalman_tracker.c \
+    src/survive_latency.c \
+    src/survive_lighthouse_cache.c \
+    src/survive_trace.c \
+    src/survive_startup_profile.c \
+    src/survive_thread_pool.c \
     src/survive_optimizer.c \
     src/survive_recording.c \
     src/survive_plugins.c \
@@ -143,6 +143,9 @@ typedef struct PoserDataGlobalScenes {
 	SurvivePose *world2lhs;
 	size_t scenes_cnt;
 	struct PoserDataGlobalScene *scenes;
+
+	// Only the newest scenes are passed; the earlier ones are represented by what the poser kept from its last solve
+	bool incremental;
 } PoserDataGlobalScenes;
 
 union PoserDataAll {
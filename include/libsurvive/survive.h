@@ -3,6 +3,9 @@
 
 #include "assert.h"
 #include "poser.h"
+#include "survive_latency.h"
+#include "survive_startup_profile.h"
+#include "survive_trace.h"
 #include "survive_types.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -231,6 +234,12 @@ struct SurviveObject {
 #define SURVIVE_CORRECTION_PARAMS 3
 	FLT lh_correction[NUM_GEN2_LIGHTHOUSES][SURVIVE_CORRECTION_PARAMS];
 	FLT lh_correction_variance[NUM_GEN2_LIGHTHOUSES][SURVIVE_CORRECTION_PARAMS];
+
+	// Hook and sensor-to-pose latency for this object; see survive_latency.h
+	struct SurviveLatencyStats *latency;
+
+	// When this object got through each startup phase; see survive_startup_profile.h
+	struct SurviveStartupObject *startup;
 };
 
 // These exports are mostly for language binding against
@@ -375,6 +384,19 @@ struct SurviveContext {
 	// Additional details that we don't want / need to expose to every single include
 	void *private_members;
 	bool request_floor_set;
+
+	// Hook latency histograms; see survive_latency.h. Only recorded into when latency_enabled is set
+	struct SurviveLatencyStats *latency;
+	bool latency_enabled;
+
+	// Calibration of known base stations by id; see survive_lighthouse_cache.h
+	struct SurviveLighthouseCache *lh_cache;
+
+	// When startup got through each phase; see survive_startup_profile.h
+	struct SurviveStartupProfile *startup;
+
+	// Background writer of the config file; see config_save
+	struct SurviveConfigWriter *config_writer;
 };
 
 SURVIVE_EXPORT void survive_verify_FLT_size(
@@ -422,6 +444,12 @@ SURVIVE_EXPORT int survive_poll(SurviveContext *ctx);
 SURVIVE_EXPORT void survive_close(SurviveContext *ctx);
 SURVIVE_EXPORT void survive_get_ctx_lock(SurviveContext *ctx);
 SURVIVE_EXPORT void survive_release_ctx_lock(SurviveContext *ctx);
+/**
+ * Takes the context lock, attributing the time spent waiting for and holding it to the given call site in the callback
+ * stats (--output-callback-stats). survive_get_ctx_lock records its caller's file and line this way.
+ */
+SURVIVE_EXPORT void survive_get_ctx_lock_at(SurviveContext *ctx, const char *file, int line);
+#define survive_get_ctx_lock(ctx) survive_get_ctx_lock_at(ctx, __FILE__, __LINE__)
 
 SURVIVE_EXPORT const char *survive_build_tag();
 
@@ -485,9 +513,13 @@ SURVIVE_EXPORT int8_t survive_get_bsd_idx(SurviveContext *ctx, survive_channel c
 #define SURVIVE_INVOKE_HOOK(hook, ctx, ...)                                                                            \
 	{                                                                                                                  \
 		if (ctx && ctx->hook##proc) {                                                                                         \
-			FLT start_time = OGRelativeTime();                                                                         \
+			uint64_t start_ns = survive_latency_now_ns();                                                              \
 			ctx->hook##proc(ctx, __VA_ARGS__);                                                                         \
-			FLT this_time = OGRelativeTime() - start_time;                                                             \
+			uint64_t this_ns = survive_latency_now_ns() - start_ns;                                                    \
+			if (ctx->latency_enabled)                                                                                  \
+				survive_latency_record_hook(ctx, 0, survive_hook_id_##hook, this_ns);                                  \
+			survive_trace_span(#hook, start_ns, this_ns);                                                              \
+			FLT this_time = this_ns * 1e-9;                                                                            \
 			if (this_time > ctx->hook##_max_call_time)                                                                 \
 				ctx->hook##_max_call_time = this_time;                                                                 \
 			if (this_time > .001)                                                                                      \
@@ -500,9 +532,13 @@ SURVIVE_EXPORT int8_t survive_get_bsd_idx(SurviveContext *ctx, survive_channel c
 #define SURVIVE_INVOKE_HOOK_SO(hook, so, ...)                                                                          \
 	{                                                                                                                  \
 		if (so->ctx->hook##proc) {                                                                                     \
-			FLT start_time = OGRelativeTime();                                                                         \
+			uint64_t start_ns = survive_latency_now_ns();                                                              \
 			so->ctx->hook##proc(so, ##__VA_ARGS__);                                                                    \
-			FLT this_time = OGRelativeTime() - start_time;                                                             \
+			uint64_t this_ns = survive_latency_now_ns() - start_ns;                                                    \
+			if (so->ctx->latency_enabled)                                                                              \
+				survive_latency_record_hook(so->ctx, so, survive_hook_id_##hook, this_ns);                             \
+			survive_trace_span(#hook, start_ns, this_ns);                                                              \
+			FLT this_time = this_ns * 1e-9;                                                                            \
 			if (this_time > so->ctx->hook##_max_call_time)                                                             \
 				so->ctx->hook##_max_call_time = this_time;                                                             \
 			if (this_time > .001)                                                                                      \
@@ -647,6 +683,19 @@ SURVIVE_EXPORT void survive_add_driver(SurviveContext *ctx, void *driver_data, D
 									   DeviceDriverCb close);
 SURVIVE_EXPORT bool *survive_add_threaded_driver(SurviveContext *ctx, void *driver_data, const char *name,
 												 void *(routine)(void *), DeviceDriverCb close);
+
+/**
+ * Registers a file descriptor with the reactor survive_poll waits on. `events` is a mask of POLLIN / POLLOUT; when the
+ * fd is ready `fn` is called from survive_poll with the context lock held. A non-zero return from `fn` is returned by
+ * survive_poll, the same as for a driver poll function.
+ *
+ * Returns non-zero where the reactor isn't available (currently everything but linux); drivers should then keep
+ * servicing the fd from their poll function.
+ */
+SURVIVE_EXPORT int survive_add_poll_fd(SurviveContext *ctx, int fd, int events, survive_poll_fd_fn fn, void *user);
+SURVIVE_EXPORT void survive_remove_poll_fd(SurviveContext *ctx, int fd);
+// Makes a blocked survive_poll return early; safe to call from any thread.
+SURVIVE_EXPORT void survive_wake_poll(SurviveContext *ctx);
 SURVIVE_EXPORT char *survive_export_config(SurviveObject *so);
 SURVIVE_EXPORT void survive_reset_lighthouse_positions(SurviveContext *ctx);
 SURVIVE_EXPORT void survive_reset_lighthouse_position(SurviveContext *ctx, int bsd_idx);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "survive_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Latency histograms for the hook instrumentation.
+ *
+ * Every hook invoked through SURVIVE_INVOKE_HOOK / SURVIVE_INVOKE_HOOK_SO records its call time into a histogram for
+ * the context, and -- for object hooks -- one for the object. On top of that, each object tracks the time from a raw
+ * packet being received by the driver to the pose derived from it reaching the pose hook.
+ *
+ * Histograms are log-linear: values are bucketed by their power of two and each power of two is split into
+ * 2^SURVIVE_LATENCY_SUB_BUCKET_BITS linear sub-buckets, so percentiles are exact to within 1/16th. Recording is a
+ * handful of relaxed atomic adds, so hooks called from driver threads don't need the context lock to record.
+ *
+ * Nothing is recorded unless ctx->latency_enabled is set, which survive_init does for --latency-report and
+ * --output-callback-stats.
+ */
+
+#define SURVIVE_LATENCY_SUB_BUCKET_BITS 4
+#define SURVIVE_LATENCY_SUB_BUCKETS (1 << SURVIVE_LATENCY_SUB_BUCKET_BITS)
+// Values at or above 2^SURVIVE_LATENCY_MAX_EXPONENT ns (~68s) all land in the last bucket
+#define SURVIVE_LATENCY_MAX_EXPONENT 36
+#define SURVIVE_LATENCY_BUCKET_CNT                                                                                     \
+	((SURVIVE_LATENCY_MAX_EXPONENT - SURVIVE_LATENCY_SUB_BUCKET_BITS + 1) * SURVIVE_LATENCY_SUB_BUCKETS)
+
+typedef struct survive_latency_histogram {
+	uint32_t counts[SURVIVE_LATENCY_BUCKET_CNT];
+	uint64_t cnt;
+	uint64_t total_ns;
+	uint64_t max_ns;
+} survive_latency_histogram;
+
+enum survive_hook_id {
+#define SURVIVE_HOOK_PROCESS_DEF(hook) survive_hook_id_##hook,
+#include "survive_hooks.h"
+	survive_hook_id_count
+};
+
+// Histograms are allocated the first time something is recorded into them
+struct SurviveLatencyStats {
+	survive_latency_histogram *hooks[survive_hook_id_count];
+	survive_latency_histogram *sensor_to_pose;
+};
+
+// All times in seconds
+typedef struct SurviveLatencySummary {
+	uint64_t cnt;
+	FLT mean;
+	FLT p50, p90, p99, p999;
+	FLT max;
+} SurviveLatencySummary;
+
+SURVIVE_EXPORT const char *survive_hook_name(enum survive_hook_id id);
+
+// Monotonic clock the histograms are recorded against
+SURVIVE_EXPORT uint64_t survive_latency_now_ns();
+
+SURVIVE_EXPORT void survive_latency_histogram_add(survive_latency_histogram *h, uint64_t ns);
+// Upper bound of the bucket the given quantile (0..1) falls in, in ns; 0 for an empty histogram
+SURVIVE_EXPORT uint64_t survive_latency_histogram_percentile(const survive_latency_histogram *h, FLT quantile);
+SURVIVE_EXPORT void survive_latency_histogram_summary(const survive_latency_histogram *h, SurviveLatencySummary *out);
+SURVIVE_EXPORT void survive_latency_histogram_reset(survive_latency_histogram *h);
+
+/**
+ * Called by the hook invoke macros. `so` is null for hooks that aren't attached to an object.
+ */
+SURVIVE_EXPORT void survive_latency_record_hook(SurviveContext *ctx, SurviveObject *so, enum survive_hook_id id,
+												uint64_t ns);
+/**
+ * Records the time between now and when the raw data for `timecode` was received, using the driver's mapping from
+ * device time to receive time. Nothing is recorded for objects whose driver doesn't provide that mapping.
+ */
+SURVIVE_EXPORT void survive_latency_record_sensor_to_pose(SurviveObject *so, survive_long_timecode timecode);
+
+/**
+ * Queries fill in `out` and return the number of samples; all zeros if nothing was recorded yet.
+ */
+SURVIVE_EXPORT uint64_t survive_latency_hook(const SurviveContext *ctx, enum survive_hook_id id,
+											 SurviveLatencySummary *out);
+SURVIVE_EXPORT uint64_t survive_latency_object_hook(const SurviveObject *so, enum survive_hook_id id,
+													SurviveLatencySummary *out);
+SURVIVE_EXPORT uint64_t survive_latency_sensor_to_pose(const SurviveObject *so, SurviveLatencySummary *out);
+
+// Logs every non-empty histogram of the context and its objects
+SURVIVE_EXPORT void survive_latency_dump(SurviveContext *ctx);
+SURVIVE_EXPORT void survive_latency_reset(SurviveContext *ctx);
+
+SURVIVE_EXPORT void survive_latency_free(struct SurviveLatencyStats *stats);
+
+#ifdef __cplusplus
+};
+#endif
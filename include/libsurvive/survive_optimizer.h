@@ -119,6 +119,8 @@ typedef struct survive_optimizer {
 	int cameraLength;
 	int ptsLength;
 	bool nofilter;
+	// Keeps survive_optimizer_run from writing to the recording; for copies that are solved concurrently
+	bool norecord;
 
 	mp_config *cfg;
 
@@ -175,6 +177,11 @@ typedef struct survive_optimizer {
 
 SURVIVE_EXPORT void *survive_optimizer_realloc(void *old_ptr, size_t size);
 
+// Deep copy of a set up optimizer into heap buffers, so it can run independently of the source. Free it with
+// survive_optimizer_free_clone.
+SURVIVE_EXPORT void survive_optimizer_clone(survive_optimizer *dst, const survive_optimizer *src);
+SURVIVE_EXPORT void survive_optimizer_free_clone(survive_optimizer *opt);
+
 SURVIVE_EXPORT int survive_optimizer_get_max_measurements_count(const survive_optimizer *ctx);
 SURVIVE_EXPORT int survive_optimizer_get_max_parameters_count(const survive_optimizer *ctx);
 SURVIVE_EXPORT int survive_optimizer_get_parameters_count(const survive_optimizer *ctx);
@@ -235,6 +242,8 @@ SURVIVE_EXPORT survive_optimizer *survive_optimizer_load(const char *fn);
 SURVIVE_EXPORT FLT survive_optimizer_current_norm(const survive_optimizer *optimizer);
 
 SURVIVE_EXPORT mp_config *survive_optimizer_precise_config();
+// What survive_optimizer_run uses when the optimizer has no cfg of its own; built from the optimizer-* config items
+SURVIVE_EXPORT mp_config *survive_optimizer_default_config(SurviveContext *ctx);
 
 SURVIVE_EXPORT int survive_optimizer_nonfixed_cnt(const survive_optimizer *optimizer);
 
@@ -0,0 +1,44 @@
+#ifndef _SURVIVE_PUBLISHER_H
+#define _SURVIVE_PUBLISHER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Stream format of the publisher plugin (driver_publisher.c, enabled with --publisher). Like survive_udp.h this header
+ * has no libsurvive dependencies so that consumers can include it on its own.
+ *
+ * Raw TCP clients receive a plain sequence of survive_publisher_record. Websocket clients receive one binary frame per
+ * record. All fields are little-endian.
+ *
+ * Clients which can't keep up don't get a growing backlog; they get the most recent value for each object instead.
+ * `sequence` is global and increases with every published value, so gaps show how much was coalesced.
+ */
+
+#define SURVIVE_PUBLISHER_DEFAULT_PORT 5555
+#define SURVIVE_PUBLISHER_DEFAULT_WS_PORT 8081
+
+enum survive_publisher_record_type {
+	SURVIVE_PUBLISHER_POSE = 1,			   // values are pos xyz, rot wxyz
+	SURVIVE_PUBLISHER_VELOCITY = 2,		   // values are linear xyz, angular axis-angle xyz
+	SURVIVE_PUBLISHER_LIGHTHOUSE_POSE = 3, // values are pos xyz, rot wxyz; `lighthouse` is set, `codename` is empty
+};
+
+typedef struct survive_publisher_record {
+	uint8_t type;		// survive_publisher_record_type
+	uint8_t lighthouse; // Lighthouse index for SURVIVE_PUBLISHER_LIGHTHOUSE_POSE
+	uint16_t reserved;
+	char codename[4];  // Null terminated object name
+	uint64_t timecode; // Object timecode, in ticks of the objects timebase
+	uint32_t sequence;
+	float values[7];
+} survive_publisher_record;
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef _SURVIVE_SHM_H
+#define _SURVIVE_SHM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Shared memory layout written by the shm plugin (driver_shm.c, enabled with --shm) and a header-only reader for it.
+ * Like survive_udp.h, this has no libsurvive dependencies; a consumer process only needs this file.
+ *
+ * The segment holds the latest state of each object. Every object is guarded by its own seqlock: the writer makes
+ * `seq` odd, updates the fields and makes `seq` even again, so readers never block the writer and never make a syscall.
+ * Use survive_shm_read rather than reading the fields directly.
+ *
+ * Usage:
+ *   survive_shm_segment *seg = survive_shm_open(SURVIVE_SHM_DEFAULT_NAME);
+ *   const survive_shm_object *hmd = survive_shm_find(seg, "HMD");
+ *   survive_shm_object_state state;
+ *   if (hmd && survive_shm_read(hmd, &state)) ...
+ *   survive_shm_close(seg);
+ */
+
+#define SURVIVE_SHM_DEFAULT_NAME "/libsurvive"
+#define SURVIVE_SHM_MAGIC 0x4d485353u // "SSHM"
+#define SURVIVE_SHM_VERSION 1
+#define SURVIVE_SHM_MAX_OBJECTS 32
+
+typedef struct survive_shm_object_state {
+	char codename[8];
+	uint64_t timecode;		  // Object timecode of the last pose, in ticks of the objects timebase
+	uint32_t pose_cnt;		  // Number of poses written so far; 0 if only velocity has been seen
+	uint32_t velocity_cnt;	  // Number of velocities written so far
+	double pose[7];			  // pos xyz, rot wxyz
+	double velocity[6];		  // linear xyz, angular axis-angle xyz
+	double pose_variance[7]; // Diagonal of the tracker covariance over the pose; 0 when not available
+} survive_shm_object_state;
+
+typedef struct survive_shm_object {
+	uint32_t seq; // Odd while the writer is updating `state`
+	uint32_t reserved;
+	survive_shm_object_state state;
+} survive_shm_object;
+
+typedef struct survive_shm_segment {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t object_size; // sizeof(survive_shm_object), for sanity checking
+	uint32_t object_cnt;  // Objects [0, object_cnt) are valid; only ever grows
+	int32_t writer_pid;	  // 0 once the writer has shut down
+	uint32_t reserved;
+	survive_shm_object objects[SURVIVE_SHM_MAX_OBJECTS];
+} survive_shm_segment;
+
+/**
+ * Maps an existing segment read-only. Returns 0 if it doesn't exist, is still being set up by the writer or doesn't
+ * match this header.
+ */
+static inline survive_shm_segment *survive_shm_open(const char *name) {
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return 0;
+
+	// Touching pages past the end of a shorter segment would raise SIGBUS, so it's refused before mapping
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(survive_shm_segment)) {
+		close(fd);
+		return 0;
+	}
+
+	void *mem = mmap(0, sizeof(survive_shm_segment), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+		return 0;
+
+	// The writer stores the magic last, so a matching magic means the rest of the header is in place
+	survive_shm_segment *seg = (survive_shm_segment *)mem;
+	if (__atomic_load_n(&seg->magic, __ATOMIC_ACQUIRE) != SURVIVE_SHM_MAGIC || seg->version != SURVIVE_SHM_VERSION ||
+		seg->object_size != sizeof(survive_shm_object)) {
+		munmap(mem, sizeof(survive_shm_segment));
+		return 0;
+	}
+	return seg;
+}
+
+static inline void survive_shm_close(survive_shm_segment *seg) {
+	if (seg)
+		munmap(seg, sizeof(survive_shm_segment));
+}
+
+static inline uint32_t survive_shm_object_cnt(const survive_shm_segment *seg) {
+	uint32_t cnt = __atomic_load_n(&seg->object_cnt, __ATOMIC_ACQUIRE);
+	return cnt < SURVIVE_SHM_MAX_OBJECTS ? cnt : SURVIVE_SHM_MAX_OBJECTS;
+}
+
+static inline bool survive_shm_writer_alive(const survive_shm_segment *seg) {
+	return __atomic_load_n(&seg->writer_pid, __ATOMIC_RELAXED) != 0;
+}
+
+/** Finds an object by codename; the codename of a published object never changes so the result can be cached. */
+static inline const survive_shm_object *survive_shm_find(const survive_shm_segment *seg, const char *codename) {
+	uint32_t cnt = survive_shm_object_cnt(seg);
+	for (uint32_t i = 0; i < cnt; i++) {
+		if (strncmp(seg->objects[i].state.codename, codename, sizeof(seg->objects[i].state.codename)) == 0)
+			return &seg->objects[i];
+	}
+	return 0;
+}
+
+/** Copies out a consistent snapshot of the object. Returns false if the writer kept it busy for too long. */
+static inline bool survive_shm_read(const survive_shm_object *obj, survive_shm_object_state *out) {
+	for (int attempt = 0; attempt < 1000; attempt++) {
+		uint32_t start = __atomic_load_n(&obj->seq, __ATOMIC_ACQUIRE);
+		if (start & 1)
+			continue;
+
+		memcpy(out, &obj->state, sizeof(*out));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&obj->seq, __ATOMIC_RELAXED) == start)
+			return true;
+	}
+	return false;
+}
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "survive_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Timestamps of the phases of a cold start, so that time-to-first-pose can be broken down and optimized.
+ *
+ * Every mark records the wall time since survive_init started and the run time (survive_run_time) it was reached at.
+ * For replays the run time is the time in the recording, so it measures how much data each phase needs independent of
+ * how fast the replay ran; the wall time measures how long the work took.
+ *
+ * Phases are recorded for the context as a whole, per object and per lighthouse. Each is only recorded the first time
+ * it is reached. With --startup-report the whole profile is logged when the context closes.
+ */
+
+enum survive_startup_phase {
+	survive_startup_phase_plugins_loaded,
+	survive_startup_phase_config_read,
+	// survive_startup returned; USB enumeration and driver init are done
+	survive_startup_phase_drivers_started,
+	survive_startup_phase_lh_version_detected,
+	survive_startup_phase_count
+};
+
+enum survive_startup_object_phase {
+	survive_startup_object_phase_added,
+	// Device config downloaded and parsed
+	survive_startup_object_phase_config,
+	survive_startup_object_phase_first_light,
+	survive_startup_object_phase_first_pose,
+	// First pose of the first stretch of SURVIVE_STARTUP_STABLE_TIME seconds in which the pose stayed within
+	// SURVIVE_STARTUP_STABLE_DISTANCE / SURVIVE_STARTUP_STABLE_ANGLE of it
+	survive_startup_object_phase_stable_pose,
+	survive_startup_object_phase_count
+};
+
+enum survive_startup_lighthouse_phase {
+	survive_startup_lighthouse_phase_ootx,
+	survive_startup_lighthouse_phase_pose,
+	survive_startup_lighthouse_phase_count
+};
+
+#define SURVIVE_STARTUP_STABLE_TIME 1.
+#define SURVIVE_STARTUP_STABLE_DISTANCE .005
+#define SURVIVE_STARTUP_STABLE_ANGLE .01
+
+typedef struct SurviveStartupMark {
+	bool reached;
+	FLT wall_time;
+	FLT run_time;
+} SurviveStartupMark;
+
+struct SurviveStartupObject {
+	SurviveStartupMark marks[survive_startup_object_phase_count];
+
+	// Start of the current stretch of poses that stayed close to each other
+	SurvivePose stable_pose;
+	SurviveStartupMark stable_since;
+};
+
+struct SurviveStartupProfile {
+	double init_time;
+	SurviveStartupMark marks[survive_startup_phase_count];
+	SurviveStartupMark lighthouses[NUM_GEN2_LIGHTHOUSES][survive_startup_lighthouse_phase_count];
+};
+
+SURVIVE_EXPORT const char *survive_startup_phase_name(enum survive_startup_phase phase);
+SURVIVE_EXPORT const char *survive_startup_object_phase_name(enum survive_startup_object_phase phase);
+SURVIVE_EXPORT const char *survive_startup_lighthouse_phase_name(enum survive_startup_lighthouse_phase phase);
+
+// `init_time` is the OGGetAbsoluteTime at which survive_init started
+SURVIVE_EXPORT void survive_startup_profile_init(SurviveContext *ctx, double init_time);
+SURVIVE_EXPORT void survive_startup_profile_free(SurviveContext *ctx);
+
+SURVIVE_EXPORT void survive_startup_mark(SurviveContext *ctx, enum survive_startup_phase phase);
+SURVIVE_EXPORT void survive_startup_mark_object(SurviveObject *so, enum survive_startup_object_phase phase);
+SURVIVE_EXPORT void survive_startup_mark_lighthouse(SurviveContext *ctx, int lh,
+													enum survive_startup_lighthouse_phase phase);
+// Marks the first pose, and tracks the pose until it is stable
+SURVIVE_EXPORT void survive_startup_observe_pose(SurviveObject *so, const SurvivePose *pose);
+
+/**
+ * Queries return null when nothing was recorded for that phase (yet).
+ */
+SURVIVE_EXPORT const SurviveStartupMark *survive_startup_get(const SurviveContext *ctx,
+															 enum survive_startup_phase phase);
+SURVIVE_EXPORT const SurviveStartupMark *survive_startup_get_object(const SurviveObject *so,
+																	enum survive_startup_object_phase phase);
+SURVIVE_EXPORT const SurviveStartupMark *survive_startup_get_lighthouse(const SurviveContext *ctx, int lh,
+																		enum survive_startup_lighthouse_phase phase);
+
+SURVIVE_EXPORT void survive_startup_dump(SurviveContext *ctx);
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "survive_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Span tracing of the pipeline, written out as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+ *
+ * Enabled with --trace-file <file.json>. Every thread records into its own buffer, so recording a span takes no locks;
+ * the buffers are merged and written when the context that started the trace closes. When tracing is off the calls
+ * below reduce to a flag check.
+ *
+ * Span names must outlive the trace -- string literals, typically.
+ */
+
+// Upper bound on the spans kept per thread; spans past it are counted and dropped
+#define SURVIVE_TRACE_MAX_EVENTS_PER_THREAD (1 << 21)
+
+SURVIVE_EXPORT bool survive_trace_start(const char *filename);
+// Stops recording, waits for spans being recorded right now, then writes the trace file and frees the buffers. Threads
+// can keep calling the span functions; they record nothing until the next start.
+SURVIVE_EXPORT void survive_trace_stop(SurviveContext *ctx);
+SURVIVE_EXPORT bool survive_trace_enabled();
+
+// Returns the start of a span for survive_trace_end; 0 when tracing is off
+SURVIVE_EXPORT uint64_t survive_trace_begin();
+SURVIVE_EXPORT void survive_trace_end(const char *name, uint64_t start_ns);
+// For callers that already timed the span, against survive_latency_now_ns
+SURVIVE_EXPORT void survive_trace_span(const char *name, uint64_t start_ns, uint64_t duration_ns);
+
+#ifdef __cplusplus
+};
+#endif
@@ -374,6 +374,7 @@ typedef enum SurviveDeviceDriverReturn {
 } SurviveDeviceDriverReturn;
 
 typedef int (*DeviceDriverCb)(struct SurviveContext *ctx, void *driver);
+typedef int (*survive_poll_fd_fn)(struct SurviveContext *ctx, void *user, int fd);
 typedef int (*DeviceDriverMagicCb)( struct SurviveContext * ctx, void * driver, int magic_code, void * data, int datalen );
 
 SURVIVE_EXPORT const char *SurviveInputEventStr(enum SurviveInputEvent evt);
@@ -0,0 +1,84 @@
+#ifndef _SURVIVE_UDP_H
+#define _SURVIVE_UDP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Wire format for the UDP driver (driver_udp.c). This header is intentionally free of any libsurvive dependencies so
+ * that remote front-ends -- e.g. a Pi Zero attached to a tracker -- can include it directly.
+ *
+ * Every datagram starts with a survive_udp_header. For SURVIVE_UDP_PACKET_EVENTS the header is followed by
+ * `event_cnt` events; each event is a survive_udp_event, optionally followed by a type specific payload (see
+ * survive_udp_event_payload_size). For SURVIVE_UDP_PACKET_CONFIG the header is followed by the JSON device config, which
+ * creates (or recreates) the object named in `codename`.
+ *
+ * All fields are little-endian. Events within a datagram must be in timecode order; a datagram only ever carries data
+ * for a single object.
+ *
+ * Datagrams whose first word is 1 or 2 are treated as the legacy unversioned config / pose packets.
+ */
+
+#define SURVIVE_UDP_PORT 2333
+#define SURVIVE_UDP_GROUP "224.0.2.122"
+
+#define SURVIVE_UDP_MAGIC 0x56535653u // "SVSV"
+#define SURVIVE_UDP_VERSION 1
+#define SURVIVE_UDP_MAX_DATAGRAM 4096
+
+enum survive_udp_packet_type {
+	SURVIVE_UDP_PACKET_CONFIG = 1,
+	SURVIVE_UDP_PACKET_EVENTS = 2,
+};
+
+enum survive_udp_event_type {
+	SURVIVE_UDP_EVENT_SYNC = 1,		// Gen2 sync; channel, timecode, flags OOTX / GEN
+	SURVIVE_UDP_EVENT_SWEEP = 2,	// Gen2 sweep; channel, sensor_id, timecode, flags HALF_CLOCK
+	SURVIVE_UDP_EVENT_LIGHTCAP = 3, // Gen1 lightcap; sensor_id, timecode, payload is the uint16_t pulse length
+	SURVIVE_UDP_EVENT_RAW_IMU = 4,	// Unscaled IMU; channel is the mask, sensor_id the id, payload float[6]
+	SURVIVE_UDP_EVENT_IMU = 5,		// Scaled IMU; same layout as SURVIVE_UDP_EVENT_RAW_IMU
+};
+
+enum survive_udp_event_flags {
+	SURVIVE_UDP_FLAG_OOTX = 1,
+	SURVIVE_UDP_FLAG_GEN = 2,
+	SURVIVE_UDP_FLAG_HALF_CLOCK = 4,
+};
+
+typedef struct survive_udp_header {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t type;		// survive_udp_packet_type
+	uint16_t event_cnt; // Number of events following; unused for config packets
+	uint32_t sequence;	// Per-object counter, lets the receiver count dropped datagrams
+	char codename[4];	// Null terminated object name, ie "TR0"
+} survive_udp_header;
+
+typedef struct survive_udp_event {
+	uint8_t type; // survive_udp_event_type
+	uint8_t channel;
+	uint8_t sensor_id;
+	uint8_t flags; // survive_udp_event_flags
+	uint32_t timecode;
+} survive_udp_event;
+
+static inline uint32_t survive_udp_event_payload_size(uint8_t type) {
+	switch (type) {
+	case SURVIVE_UDP_EVENT_LIGHTCAP:
+		return sizeof(uint16_t);
+	case SURVIVE_UDP_EVENT_RAW_IMU:
+	case SURVIVE_UDP_EVENT_IMU:
+		return 6 * sizeof(float);
+	default:
+		return 0;
+	}
+}
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif
@@ -3,6 +3,7 @@
 #include "stdbool.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 #include "survive.h"
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
 #include <cnmatrix/cn_matrix.h>
@@ -85,6 +86,9 @@ void bc_svd_bc_svd(bc_svd *self, void *user, bc_svd_fill_M_fn fillFn, const Linm
 	self->setup.alphas = SV_CALLOC_N(obj_cnt, sizeof(self->setup.alphas[0]));
 	self->object_pts_in_camera = SV_CALLOC_N(obj_cnt, sizeof(self->setup.alphas[0]));
 
+	self->meas_space = 2 * obj_cnt;
+	self->meas = SV_CALLOC_N(self->meas_space, sizeof(self->meas[0]));
+
 	bc_svd_choose_control_points(self);
 	bc_svd_compute_barycentric_coordinates(self);
 }
@@ -135,20 +139,93 @@ void bc_svd_add_correspondence(bc_svd *self, size_t idx, FLT u, FLT v) {
 	}
 }
 
-void bc_svd_fill_M(bc_svd *self, CnMat *_M, const int row, const FLT *as, int axis, FLT angle) {
-	FLT *M = CN_RAW_PTR(_M) + row * 12;
-
+static void bc_svd_fill_row(bc_svd *self, FLT *row, const FLT *as, int axis, FLT angle) {
 	FLT eq[3] = {NAN, NAN, NAN};
 	self->setup.fillFn(self->setup.user, eq, axis, angle);
 
 	for (int i = 0; i < 4; i++) {
 		for (int j = 0; j < 3; j++) {
-			cnMatrixSet(_M, row, i * 3 + j, eq[j] * as[i]);
-			assert(isfinite(cnMatrixGet(_M, row, i * 3 + j)));
+			row[i * 3 + j] = eq[j] * as[i];
+			assert(isfinite(row[i * 3 + j]));
 		}
 	}
 }
 
+/**
+ * Eigen decomposition of the symmetric 12x12 ws->MtM with cyclic Jacobi rotations; MtM is destroyed. The eigenvectors
+ * are written to the rows of ws->ut sorted by decreasing eigenvalue, which for the positive semi-definite MtM is the
+ * U^t cnSVD would give. Jacobi is accurate for the small eigenvalues, and those are the ones the solve uses.
+ */
+static void bc_svd_eigen12(bc_svd_workspace *ws, CnMat *Ut) {
+	FLT(*A)[12] = ws->MtM;
+	FLT(*V)[12] = ws->eigenvectors;
+	FLT *d = ws->eigenvalues;
+
+	for (int i = 0; i < 12; i++) {
+		for (int j = 0; j < 12; j++)
+			V[i][j] = i == j;
+	}
+
+	for (int sweep = 0; sweep < 50; sweep++) {
+		FLT off = 0, diag = 0;
+		for (int p = 0; p < 12; p++) {
+			diag += A[p][p] * A[p][p];
+			for (int q = p + 1; q < 12; q++)
+				off += A[p][q] * A[p][q];
+		}
+		if (off <= diag * 1e-30 || off == 0)
+			break;
+
+		for (int p = 0; p < 11; p++) {
+			for (int q = p + 1; q < 12; q++) {
+				FLT apq = A[p][q];
+				if (apq == 0)
+					continue;
+
+				FLT theta = (A[q][q] - A[p][p]) / (2 * apq);
+				FLT t = 1. / (fabs(theta) + sqrt(theta * theta + 1));
+				if (theta < 0)
+					t = -t;
+				FLT c = 1. / sqrt(t * t + 1), s = t * c;
+
+				for (int k = 0; k < 12; k++) {
+					FLT akp = A[k][p], akq = A[k][q];
+					A[k][p] = c * akp - s * akq;
+					A[k][q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < 12; k++) {
+					FLT apk = A[p][k], aqk = A[q][k];
+					A[p][k] = c * apk - s * aqk;
+					A[q][k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < 12; k++) {
+					FLT vkp = V[k][p], vkq = V[k][q];
+					V[k][p] = c * vkp - s * vkq;
+					V[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	int order[12];
+	for (int i = 0; i < 12; i++) {
+		d[i] = A[i][i];
+		order[i] = i;
+	}
+	for (int i = 1; i < 12; i++) {
+		for (int j = i; j > 0 && d[order[j]] > d[order[j - 1]]; j--) {
+			int tmp = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = tmp;
+		}
+	}
+
+	for (int r = 0; r < 12; r++) {
+		for (int k = 0; k < 12; k++)
+			cnMatrixSet(Ut, r, k, V[k][order[r]]);
+	}
+}
+
 static void bc_svd_compute_ccs(bc_svd *self, const FLT *betas, const CnMat *ut) {
 	for (int i = 0; i < 4; i++)
 		self->control_points_in_camera[i][0] = self->control_points_in_camera[i][1] =
@@ -259,9 +336,9 @@ static void compute_A_and_b_gauss_newton(const CnMat *L_6x10, const FLT *rho, FL
 static void gauss_newton(const CnMat *L_6x10, const CnMat *Rho, FLT betas[4]) {
 	const int iterations_number = 5;
 
-	FLT x[4] = {0};
-	CN_CREATE_STACK_MAT(A, 6, 4);
-	CN_CREATE_STACK_MAT(B, 6, 1);
+	FLT x[4] = {0}, a[6 * 4], b[6];
+	CnMat A = cnMat(6, 4, a);
+	CnMat B = cnMat(6, 1, b);
 	CnMat X = cnMat(4, 1, x);
 
 	for (int k = 0; k < iterations_number; k++) {
@@ -270,13 +347,11 @@ static void gauss_newton(const CnMat *L_6x10, const CnMat *Rho, FLT betas[4]) {
 		for (int i = 0; i < 4; i++)
 			betas[i] += x[i];
 	}
-	CN_FREE_STACK_MAT(B);
-	CN_FREE_STACK_MAT(A);
 }
 
 static void find_betas_approx_2(const CnMat *L_6x10, const CnMat *Rho, FLT *betas) {
-	FLT b3[3];
-	CN_CREATE_STACK_MAT(L_6x3, 6, 3);
+	FLT l_6x3[6 * 3], b3[3];
+	CnMat L_6x3 = cnMat(6, 3, l_6x3);
 	CnMat B3 = cnMat(3, 1, b3);
 
 	for (int i = 0; i < 6; i++) {
@@ -300,7 +375,6 @@ static void find_betas_approx_2(const CnMat *L_6x10, const CnMat *Rho, FLT *beta
 
 	betas[2] = 0.0;
 	betas[3] = 0.0;
-	CN_FREE_STACK_MAT(L_6x3);
 }
 
 // betas10        = [B11 B12 B22 B13 B23 B33 B14 B24 B34 B44]
@@ -347,20 +421,23 @@ FLT bc_svd_compute_pose(bc_svd *self, FLT R[3][3], FLT t[3]) {
 	FLT Rs[4][3][3] = {0}, ts[4][3] = {0};
 	int N = 0;
 
-	CN_CREATE_STACK_MAT(M, self->meas_cnt, 12);
+	bc_svd_workspace *ws = &self->ws;
+	memset(ws->MtM, 0, sizeof(ws->MtM));
+
 	bool colCovered[12] = { 0 };
 	bool has_axis[2] = {false, false};
 	for (int i = 0; i < self->meas_cnt; i++) {
 		size_t obj_pt_idx = self->meas[i].obj_idx;
 		const bc_svd_meas_t *meas = &self->meas[i];
-		bc_svd_fill_M(self, &M, i, self->setup.alphas[obj_pt_idx], meas->axis, meas->angle);
+		FLT row[12];
+		bc_svd_fill_row(self, row, self->setup.alphas[obj_pt_idx], meas->axis, meas->angle);
 		has_axis[meas->axis] = true;
 
 		for (int j = 0; j < 12; j++) {
-			FLT v = cnMatrixGet(&M, i, j);
-			assert(isfinite(v));
-			if (v != 0.0)
+			if (row[j] != 0.0)
 				colCovered[j] = true;
+			for (int k = j; k < 12; k++)
+				ws->MtM[j][k] += row[j] * row[k];
 		}
 	}
 
@@ -374,13 +451,13 @@ FLT bc_svd_compute_pose(bc_svd *self, FLT R[3][3], FLT t[3]) {
 			return -1;
 	}
 
-	CN_CREATE_STACK_MAT(MtM, 12, 12);
-	CN_CREATE_STACK_MAT(D, 12, 1);
-	CN_CREATE_STACK_MAT(Ut, 12, 12);
-
-	cnMulTransposed(&M, &MtM, 1, 0, 1);
+	for (int j = 0; j < 12; j++) {
+		for (int k = 0; k < j; k++)
+			ws->MtM[j][k] = ws->MtM[k][j];
+	}
 
-	cnSVD(&MtM, &D, &Ut, 0, CN_SVD_MODIFY_A | CN_SVD_U_T);
+	CnMat Ut = cnMat(12, 12, ws->ut);
+	bc_svd_eigen12(ws, &Ut);
 
 	FLT l_6x10[6 * 10], rho[6];
 	CnMat L_6x10 = cnMat(6, 10, l_6x10);
@@ -412,11 +489,6 @@ FLT bc_svd_compute_pose(bc_svd *self, FLT R[3][3], FLT t[3]) {
 
 	copy_R_and_t(Rs[N + 1], ts[N + 1], R, t);
 
-	CN_FREE_STACK_MAT(Ut);
-	CN_FREE_STACK_MAT(D);
-	CN_FREE_STACK_MAT(MtM);
-	CN_FREE_STACK_MAT(M);
-
 	return rep_errors[N];
 }
 
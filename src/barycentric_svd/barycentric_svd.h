@@ -24,6 +24,15 @@ typedef struct {
 	FLT angle;
 } bc_svd_meas_t;
 
+// Scratch space of bc_svd_compute_pose, kept with the solver so that solves don't allocate. M^t * M is accumulated a
+// measurement at a time, so nothing here depends on the number of measurements.
+typedef struct {
+	FLT MtM[12][12];
+	FLT eigenvalues[12];
+	FLT eigenvectors[12][12];
+	FLT ut[12 * 12];
+} bc_svd_workspace;
+
 typedef struct {
 	bc_svd_setup setup;
 
@@ -32,8 +41,11 @@ typedef struct {
 
 	LinmathPoint3d *object_pts_in_camera; // [obj_cnt]
 	LinmathPoint3d control_points_in_camera[4];
+
+	bc_svd_workspace ws;
 } bc_svd;
 
+// Room for both axes of every object point is reserved up front
 void bc_svd_bc_svd(bc_svd *self, void *user, bc_svd_fill_M_fn fillFn, const LinmathPoint3d *obj_pts, size_t obj_cnt);
 void bc_svd_dtor(bc_svd *self);
 
@@ -2,35 +2,82 @@
 #include "survive.h"
 #include "survive_recording.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <survive_optimizer.h>
 #include <survive_reproject_gen2.h>
 
 STATIC_CONFIG_ITEM(GSS_ENABLE, "globalscenesolver", 'b', "Enable global scene solver", 0)
+STATIC_CONFIG_ITEM(GSS_WINDOW, "gss-window", 'i',
+				   "Once all lighthouses have a pose, only optimize this many of the newest scenes per solve and keep the "
+				   "earlier ones as a prior. 0 re-solves all stored scenes every time.",
+				   0)
 
 #ifndef GSS_NUM_STORED_SCENES
 #define GSS_NUM_STORED_SCENES 32
 #endif
 
+#ifndef GSS_MAX_OBJECTS
+#define GSS_MAX_OBJECTS 32
+#endif
+
 typedef struct global_scene_solver {
 	struct SurviveContext *ctx;
 
+	// Ring of the last GSS_NUM_STORED_SCENES scenes; scenes_cnt counts every scene ever added
 	size_t scenes_cnt;
 	struct PoserDataGlobalScene scenes[GSS_NUM_STORED_SCENES];
 
+	// Backing storage of the measurements of all scenes, meas_per_scene for each. It only grows when an object with
+	// more sensors or another lighthouse shows up, so once those are known no scene allocates.
+	PoserDataGlobalSceneMeasurement *meas_arena;
+	size_t meas_per_scene;
+
 	size_t last_capture_time_cnt;
-	survive_long_timecode *last_capture_time;
+	survive_long_timecode last_capture_time[GSS_MAX_OBJECTS];
 
 	bool needsSolve;
 	FLT last_addition;
 
+	int window;
+	uint32_t solves, failed_solves;
+	FLT solve_time, max_solve_time;
+
 	imu_process_func imu_fn;
 	sync_process_func prior_sync_fn;
 	light_pulse_process_func prior_light_pulse;
 	ootx_received_process_func prior_ootx_fn;
 } global_scene_solver;
 
+static size_t stored_scenes_cnt(const global_scene_solver *gss) {
+	return gss->scenes_cnt < GSS_NUM_STORED_SCENES ? gss->scenes_cnt : GSS_NUM_STORED_SCENES;
+}
+
+// The scene added `age` scenes before the newest one
+static struct PoserDataGlobalScene *scene_at(global_scene_solver *gss, size_t age) {
+	assert(age < stored_scenes_cnt(gss));
+	return &gss->scenes[(gss->scenes_cnt - 1 - age) % GSS_NUM_STORED_SCENES];
+}
+
+static void reserve_scene_meas(global_scene_solver *gss, size_t meas_per_scene) {
+	if (meas_per_scene <= gss->meas_per_scene)
+		return;
+
+	PoserDataGlobalSceneMeasurement *arena =
+		SV_CALLOC_N(GSS_NUM_STORED_SCENES * meas_per_scene, sizeof(PoserDataGlobalSceneMeasurement));
+	for (int i = 0; i < GSS_NUM_STORED_SCENES; i++) {
+		PoserDataGlobalSceneMeasurement *meas = arena + i * meas_per_scene;
+		if (gss->scenes[i].meas_cnt)
+			memcpy(meas, gss->scenes[i].meas, gss->scenes[i].meas_cnt * sizeof(PoserDataGlobalSceneMeasurement));
+		gss->scenes[i].meas = meas;
+	}
+
+	free(gss->meas_arena);
+	gss->meas_arena = arena;
+	gss->meas_per_scene = meas_per_scene;
+}
+
 static size_t add_scenes(struct global_scene_solver *gss, SurviveObject *so) {
 	size_t rtn = 0;
 	SurviveContext *ctx = so->ctx;
@@ -39,6 +86,7 @@ static size_t add_scenes(struct global_scene_solver *gss, SurviveObject *so) {
 
 	SurviveSensorActivations *activations = &so->activations;
 
+	reserve_scene_meas(gss, 2 * so->sensor_ct * ctx->activeLighthouses);
 	struct PoserDataGlobalScene *scene = &gss->scenes[gss->scenes_cnt % GSS_NUM_STORED_SCENES];
 
 	scene->pose = so->OutPoseIMU;
@@ -46,7 +94,6 @@ static size_t add_scenes(struct global_scene_solver *gss, SurviveObject *so) {
 	scene->so = so;
 	copy3d(scene->accel, activations->accel);
 	scene->meas_cnt = 0;
-	scene->meas = SV_REALLOC(scene->meas, 32 * 2 * ctx->activeLighthouses * sizeof(scene->meas[0]));
 
 	size_t lh_meas[NUM_GEN2_LIGHTHOUSES] = {0};
 	for (uint8_t lh = 0; lh < ctx->activeLighthouses; lh++) {
@@ -82,13 +129,58 @@ static size_t add_scenes(struct global_scene_solver *gss, SurviveObject *so) {
 	return rtn;
 }
 
+static bool all_lighthouses_solved(SurviveContext *ctx) {
+	for (int lh = 0; lh < ctx->activeLighthouses; lh++) {
+		if (!ctx->bsd[lh].PositionSet)
+			return false;
+	}
+	return ctx->activeLighthouses > 0;
+}
+
 static bool run_optimization(global_scene_solver *gss) {
-	PoserDataGlobalScenes pgss = {
-		.hdr = {.pt = POSERDATA_GLOBAL_SCENES}, .scenes_cnt = gss->scenes_cnt, .scenes = gss->scenes};
-	if (pgss.scenes_cnt > GSS_NUM_STORED_SCENES)
-		pgss.scenes_cnt = GSS_NUM_STORED_SCENES;
+	SurviveContext *ctx = gss->ctx;
+	PoserDataGlobalScenes pgss = {.hdr = {.pt = POSERDATA_GLOBAL_SCENES}, .scenes_cnt = stored_scenes_cnt(gss)};
+	if (gss->window > 0 && gss->window < pgss.scenes_cnt && all_lighthouses_solved(ctx)) {
+		pgss.scenes_cnt = gss->window;
+		pgss.incremental = true;
+	}
+
+	// The solved scenes, oldest first. The poser warm starts from and writes back to the scene poses, but it releases
+	// the context lock while it solves and new scenes can replace stored ones meanwhile. So it works on a copy, and
+	// each pose is copied back only if the scene it belongs to is still stored.
+	struct PoserDataGlobalScene window[GSS_NUM_STORED_SCENES];
+	size_t scene_ids[GSS_NUM_STORED_SCENES];
+	for (size_t i = 0; i < pgss.scenes_cnt; i++) {
+		scene_ids[i] = gss->scenes_cnt - pgss.scenes_cnt + i;
+		window[i] = gss->scenes[scene_ids[i] % GSS_NUM_STORED_SCENES];
+	}
+	pgss.scenes = window;
+
+	double start = OGGetAbsoluteTime();
+	bool success = ctx->PoserFn(ctx->objs[0], &ctx->objs[0]->PoserFnData, (PoserData *)&pgss) == 0;
+	FLT solve_time = OGGetAbsoluteTime() - start;
 
-	return gss->ctx->PoserFn(gss->ctx->objs[0], &gss->ctx->objs[0]->PoserFnData, (PoserData *)&pgss) == 0;
+	size_t replaced = 0;
+	for (size_t i = 0; i < pgss.scenes_cnt; i++) {
+		if (gss->scenes_cnt - scene_ids[i] > GSS_NUM_STORED_SCENES) {
+			replaced++;
+			continue;
+		}
+		gss->scenes[scene_ids[i] % GSS_NUM_STORED_SCENES].pose = window[i].pose;
+	}
+	if (replaced) {
+		SV_VERBOSE(10, "%d scenes were replaced during the global solve", (int)replaced);
+	}
+
+	gss->solves++;
+	gss->failed_solves += !success;
+	gss->solve_time += solve_time;
+	if (solve_time > gss->max_solve_time)
+		gss->max_solve_time = solve_time;
+	SV_VERBOSE(10, "Global %s solve of %d scenes %s in %7.3fms", pgss.incremental ? "incremental" : "full",
+			   (int)pgss.scenes_cnt, success ? "succeeded" : "failed", solve_time * 1000.);
+
+	return success;
 }
 
 static void notify_global_data_available(global_scene_solver *gss, SurviveObject *so) {
@@ -99,14 +191,14 @@ static void notify_global_data_available(global_scene_solver *gss, SurviveObject
 
 static void check_for_new_objects(global_scene_solver *gss) {
 	SurviveContext *ctx = gss->ctx;
-	if (ctx->objs_ct > gss->last_capture_time_cnt) {
-		gss->last_capture_time = SV_REALLOC(gss->last_capture_time, ctx->objs_ct * sizeof(survive_long_timecode));
-		for (int i = gss->last_capture_time_cnt; i < ctx->objs_ct; i++) {
+	size_t objs_ct = ctx->objs_ct < GSS_MAX_OBJECTS ? ctx->objs_ct : GSS_MAX_OBJECTS;
+	if (objs_ct > gss->last_capture_time_cnt) {
+		for (int i = gss->last_capture_time_cnt; i < objs_ct; i++) {
 			gss->last_capture_time[i] = 0;
 
 			notify_global_data_available(gss, ctx->objs[i]);
 		}
-		gss->last_capture_time_cnt = ctx->objs_ct;
+		gss->last_capture_time_cnt = objs_ct;
 	}
 }
 
@@ -163,10 +255,12 @@ static int DriverRegGlobalSceneSolverPoll(struct SurviveContext *ctx, void *driv
 
 static int DriverRegGlobalSceneSolverClose(struct SurviveContext *ctx, void *driver) {
 	global_scene_solver *gss = (global_scene_solver *)driver;
-	free(gss->last_capture_time);
-	for (int i = 0; i < GSS_NUM_STORED_SCENES; i++) {
-		free(gss->scenes[i].meas);
+	if (gss->solves) {
+		SV_VERBOSE(5, "Global scene solver: %u solves (%u failed), avg %7.3fms, max %7.3fms", gss->solves,
+				   gss->failed_solves, gss->solve_time / gss->solves * 1000., gss->max_solve_time * 1000.);
 	}
+
+	free(gss->meas_arena);
 	free(driver);
 	return 0;
 }
@@ -180,6 +274,12 @@ static int survive_get_so_idx(const SurviveObject *so) {
 	return -1;
 }
 
+static void check_so(global_scene_solver *gss, SurviveObject *so) {
+	int idx = survive_get_so_idx(so);
+	if (idx >= 0 && idx < gss->last_capture_time_cnt)
+		check_object(gss, idx, so);
+}
+
 static void light_pulse_fn(SurviveObject *so, int sensor_id, int acode, survive_timecode timecode, FLT length,
 						   uint32_t lh) {
 	global_scene_solver *gss =
@@ -187,7 +287,7 @@ static void light_pulse_fn(SurviveObject *so, int sensor_id, int acode, survive_
 	gss->prior_light_pulse(so, sensor_id, acode, timecode, length, lh);
 
 	check_for_new_objects(gss);
-	check_object(gss, survive_get_so_idx(so), so);
+	check_so(gss, so);
 }
 static void imu_fn(SurviveObject *so, int mask, const FLT *accelgyro, survive_timecode timecode, int id) {
 	global_scene_solver *gss =
@@ -195,7 +295,7 @@ static void imu_fn(SurviveObject *so, int mask, const FLT *accelgyro, survive_ti
 	gss->imu_fn(so, mask, accelgyro, timecode, id);
 
 	check_for_new_objects(gss);
-	check_object(gss, survive_get_so_idx(so), so);
+	check_so(gss, so);
 }
 static void sync_fn(SurviveObject *so, survive_channel channel, survive_timecode timeofsync, bool ootx, bool gen) {
 	global_scene_solver *gss =
@@ -203,13 +303,13 @@ static void sync_fn(SurviveObject *so, survive_channel channel, survive_timecode
 	gss->prior_sync_fn(so, channel, timeofsync, ootx, gen);
 
 	check_for_new_objects(gss);
-	check_object(gss, survive_get_so_idx(so), so);
+	check_so(gss, so);
 }
 
 global_scene_solver *global_scene_solver_init(global_scene_solver *driver, SurviveContext *ctx) {
 	driver->ctx = ctx;
+	driver->window = survive_configi(ctx, GSS_WINDOW_TAG, SC_GET, 0);
 	driver->last_capture_time_cnt = 0;
-	driver->last_capture_time = SV_CALLOC_N(driver->last_capture_time_cnt, sizeof(survive_long_timecode) * 4);
 
 	return driver;
 }
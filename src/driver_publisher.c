@@ -0,0 +1,585 @@
+// All MIT/x11 Licensed Code in this file may be relicensed freely under the GPL
+// or LGPL licenses.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "os_generic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <survive.h>
+#include <survive_publisher.h>
+
+STATIC_CONFIG_ITEM(PUBLISHER_ENABLE, "publisher", 'b', "Serve poses as a binary stream over TCP and websockets", 0)
+STATIC_CONFIG_ITEM(PUBLISHER_PORT, "publisher-port", 'i', "TCP port for the pose publisher; 0 disables raw TCP",
+				   SURVIVE_PUBLISHER_DEFAULT_PORT)
+STATIC_CONFIG_ITEM(PUBLISHER_WS_PORT, "publisher-ws-port", 'i',
+				   "Websocket port for the pose publisher; 0 disables websockets", SURVIVE_PUBLISHER_DEFAULT_WS_PORT)
+
+#define PUBLISHER_MAX_CLIENTS 32
+#define PUBLISHER_MAX_SLOTS 128
+#define PUBLISHER_CLIENT_BUFFER 8192
+#define PUBLISHER_MAX_REQUEST 2048
+
+// Websocket frames for a record are always a 2 byte header; the payload is < 126 bytes
+#define PUBLISHER_WS_HEADER 2
+
+typedef struct publisher_slot {
+	survive_publisher_record record;
+	uint32_t sequence;
+} publisher_slot;
+
+typedef struct publisher_client {
+	int fd;
+	bool websocket;
+	bool handshake_done;
+
+	char request[PUBLISHER_MAX_REQUEST];
+	size_t request_len;
+
+	// Sequence of the last value of each slot that was queued to this client
+	uint32_t queued_sequence[PUBLISHER_MAX_SLOTS];
+	size_t next_slot;
+
+	uint8_t out[PUBLISHER_CLIENT_BUFFER];
+	size_t out_start, out_len;
+	bool want_write;
+
+	size_t coalesced;
+} publisher_client;
+
+typedef struct SurviveDriverPublisher {
+	SurviveContext *ctx;
+
+	// Guards slots; taken from the hooks and from the network thread
+	og_mutex_t lock;
+	publisher_slot slots[PUBLISHER_MAX_SLOTS];
+	size_t slots_cnt;
+	uint32_t sequence;
+
+	int wake_pending;
+	int epoll_fd, event_fd, tcp_fd, ws_fd;
+	publisher_client *clients[PUBLISHER_MAX_CLIENTS];
+
+	volatile bool keep_running;
+	og_thread_t thread;
+
+	pose_process_func pose_fn;
+	velocity_process_func velocity_fn;
+	lighthouse_pose_process_func lighthouse_pose_fn;
+	// Set by publisher_close; from then on the hooks only forward. When something got chained on top of one of our
+	// hooks, ours can't be taken out and the driver is left allocated for it to keep forwarding.
+	bool closed;
+} SurviveDriverPublisher;
+
+static int publisher_close(struct SurviveContext *ctx, void *_driver);
+
+/* Websocket handshake helpers */
+static uint32_t sha1_rol(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+static void sha1(const uint8_t *data, size_t len, uint8_t digest[20]) {
+	uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+	uint64_t bit_len = (uint64_t)len * 8;
+
+	size_t padded_len = ((len + 8) / 64 + 1) * 64;
+	uint8_t *msg = SV_CALLOC(padded_len);
+	memcpy(msg, data, len);
+	msg[len] = 0x80;
+	for (int i = 0; i < 8; i++)
+		msg[padded_len - 1 - i] = (uint8_t)(bit_len >> (8 * i));
+
+	for (size_t chunk = 0; chunk < padded_len; chunk += 64) {
+		uint32_t w[80];
+		for (int i = 0; i < 16; i++) {
+			const uint8_t *p = msg + chunk + i * 4;
+			w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+		}
+		for (int i = 16; i < 80; i++)
+			w[i] = sha1_rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+		for (int i = 0; i < 80; i++) {
+			uint32_t f, k;
+			if (i < 20) {
+				f = (b & c) | (~b & d), k = 0x5A827999;
+			} else if (i < 40) {
+				f = b ^ c ^ d, k = 0x6ED9EBA1;
+			} else if (i < 60) {
+				f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+			} else {
+				f = b ^ c ^ d, k = 0xCA62C1D6;
+			}
+			uint32_t t = sha1_rol(a, 5) + f + e + k + w[i];
+			e = d, d = c, c = sha1_rol(b, 30), b = a, a = t;
+		}
+		h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+	}
+	free(msg);
+
+	for (int i = 0; i < 20; i++)
+		digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static size_t base64_encode(const uint8_t *data, size_t len, char *out) {
+	static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t o = 0;
+	for (size_t i = 0; i < len; i += 3) {
+		uint32_t v = data[i] << 16;
+		if (i + 1 < len)
+			v |= data[i + 1] << 8;
+		if (i + 2 < len)
+			v |= data[i + 2];
+		out[o++] = table[(v >> 18) & 0x3F];
+		out[o++] = table[(v >> 12) & 0x3F];
+		out[o++] = i + 1 < len ? table[(v >> 6) & 0x3F] : '=';
+		out[o++] = i + 2 < len ? table[v & 0x3F] : '=';
+	}
+	out[o] = 0;
+	return o;
+}
+
+/* Per client output ring */
+static size_t client_free_space(const publisher_client *client) { return PUBLISHER_CLIENT_BUFFER - client->out_len; }
+
+static void client_write(publisher_client *client, const void *data, size_t len) {
+	const uint8_t *src = data;
+	size_t end = (client->out_start + client->out_len) % PUBLISHER_CLIENT_BUFFER;
+	size_t first = PUBLISHER_CLIENT_BUFFER - end;
+	if (first > len)
+		first = len;
+	memcpy(client->out + end, src, first);
+	memcpy(client->out, src + first, len - first);
+	client->out_len += len;
+}
+
+static void client_set_want_write(SurviveDriverPublisher *driver, publisher_client *client, bool want_write) {
+	if (client->want_write == want_write)
+		return;
+
+	struct epoll_event ev = {.events = EPOLLIN | (want_write ? EPOLLOUT : 0), .data = {.ptr = client}};
+	epoll_ctl(driver->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+	client->want_write = want_write;
+}
+
+static void client_close(SurviveDriverPublisher *driver, publisher_client *client) {
+	SurviveContext *ctx = driver->ctx;
+	SV_VERBOSE(10, "Publisher client %d disconnected; %u values coalesced", client->fd, (unsigned)client->coalesced);
+
+	epoll_ctl(driver->epoll_fd, EPOLL_CTL_DEL, client->fd, 0);
+	close(client->fd);
+	for (int i = 0; i < PUBLISHER_MAX_CLIENTS; i++) {
+		if (driver->clients[i] == client)
+			driver->clients[i] = 0;
+	}
+	free(client);
+}
+
+/**
+ * Queues every slot which changed since this client last saw it, as long as there is room in its ring. Whatever
+ * doesn't fit stays marked as changed; if a newer value arrives first only that one is sent.
+ */
+static void client_fill(SurviveDriverPublisher *driver, publisher_client *client) {
+	if (client->websocket && !client->handshake_done)
+		return;
+
+	size_t record_size = sizeof(survive_publisher_record) + (client->websocket ? PUBLISHER_WS_HEADER : 0);
+
+	OGLockMutex(driver->lock);
+	size_t slots_cnt = driver->slots_cnt;
+	for (size_t i = 0; i < slots_cnt; i++) {
+		size_t slot_idx = (client->next_slot + i) % slots_cnt;
+		publisher_slot *slot = &driver->slots[slot_idx];
+		uint32_t queued = client->queued_sequence[slot_idx];
+		if (slot->sequence == queued)
+			continue;
+
+		if (client_free_space(client) < record_size) {
+			// Resume here next time so that a slow client still sees every object
+			client->next_slot = slot_idx;
+			break;
+		}
+
+		if (queued != 0 && slot->sequence - queued > 1)
+			client->coalesced++;
+
+		if (client->websocket) {
+			uint8_t hdr[PUBLISHER_WS_HEADER] = {0x82, sizeof(survive_publisher_record)};
+			client_write(client, hdr, sizeof(hdr));
+		}
+		client_write(client, &slot->record, sizeof(slot->record));
+		client->queued_sequence[slot_idx] = slot->sequence;
+	}
+	OGUnlockMutex(driver->lock);
+}
+
+static void client_flush(SurviveDriverPublisher *driver, publisher_client *client) {
+	while (client->out_len > 0) {
+		size_t chunk = PUBLISHER_CLIENT_BUFFER - client->out_start;
+		if (chunk > client->out_len)
+			chunk = client->out_len;
+
+		ssize_t sent = send(client->fd, client->out + client->out_start, chunk, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				client_set_want_write(driver, client, true);
+				return;
+			}
+			client_close(driver, client);
+			return;
+		}
+
+		client->out_start = (client->out_start + sent) % PUBLISHER_CLIENT_BUFFER;
+		client->out_len -= sent;
+	}
+	client_set_want_write(driver, client, false);
+}
+
+static bool client_is_open(SurviveDriverPublisher *driver, publisher_client *client) {
+	for (int i = 0; i < PUBLISHER_MAX_CLIENTS; i++) {
+		if (driver->clients[i] == client)
+			return true;
+	}
+	return false;
+}
+
+static void client_service(SurviveDriverPublisher *driver, publisher_client *client) {
+	client_fill(driver, client);
+	client_flush(driver, client);
+}
+
+static void client_handshake(SurviveDriverPublisher *driver, publisher_client *client) {
+	client->request[client->request_len] = 0;
+	if (strstr(client->request, "\r\n\r\n") == 0) {
+		if (client->request_len >= PUBLISHER_MAX_REQUEST - 1)
+			client_close(driver, client);
+		return;
+	}
+
+	const char *key_field = strcasestr(client->request, "Sec-WebSocket-Key:");
+	if (key_field == 0) {
+		client_close(driver, client);
+		return;
+	}
+	key_field += strlen("Sec-WebSocket-Key:");
+	while (*key_field == ' ')
+		key_field++;
+
+	char key[128] = {0};
+	size_t key_len = 0;
+	while (key_field[key_len] && key_field[key_len] != '\r' && key_len < 64)
+		key_len++;
+	memcpy(key, key_field, key_len);
+	strcat(key, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+
+	uint8_t digest[20];
+	sha1((const uint8_t *)key, strlen(key), digest);
+	char accept[32];
+	base64_encode(digest, sizeof(digest), accept);
+
+	char response[256];
+	int len = snprintf(response, sizeof(response),
+					   "HTTP/1.1 101 Switching Protocols\r\n"
+					   "Upgrade: websocket\r\n"
+					   "Connection: Upgrade\r\n"
+					   "Sec-WebSocket-Accept: %s\r\n\r\n",
+					   accept);
+	client_write(client, response, len);
+	client->handshake_done = true;
+	client_service(driver, client);
+}
+
+static void client_read(SurviveDriverPublisher *driver, publisher_client *client) {
+	char discard[512];
+	for (;;) {
+		char *dst = discard;
+		size_t len = sizeof(discard);
+		if (client->websocket && !client->handshake_done) {
+			dst = client->request + client->request_len;
+			len = PUBLISHER_MAX_REQUEST - 1 - client->request_len;
+		}
+
+		ssize_t cnt = recv(client->fd, dst, len, MSG_DONTWAIT);
+		if (cnt == 0 || (cnt < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+			client_close(driver, client);
+			return;
+		}
+		if (cnt < 0)
+			return;
+
+		// Nothing a client sends after the handshake is meaningful to us; close frames are followed by a hangup.
+		if (client->websocket && !client->handshake_done) {
+			client->request_len += cnt;
+			client_handshake(driver, client);
+			return;
+		}
+	}
+}
+
+static void accept_client(SurviveDriverPublisher *driver, int listen_fd) {
+	SurviveContext *ctx = driver->ctx;
+	int fd = accept4(listen_fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	int slot = -1;
+	for (int i = 0; i < PUBLISHER_MAX_CLIENTS && slot == -1; i++) {
+		if (driver->clients[i] == 0)
+			slot = i;
+	}
+	if (slot == -1) {
+		SV_WARN("Publisher is at its limit of %d clients", PUBLISHER_MAX_CLIENTS);
+		close(fd);
+		return;
+	}
+
+	int one = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	publisher_client *client = SV_CALLOC(sizeof(publisher_client));
+	client->fd = fd;
+	client->websocket = listen_fd == driver->ws_fd;
+	driver->clients[slot] = client;
+
+	struct epoll_event ev = {.events = EPOLLIN, .data = {.ptr = client}};
+	epoll_ctl(driver->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+
+	SV_VERBOSE(10, "Publisher client %d connected (%s)", fd, client->websocket ? "websocket" : "tcp");
+	client_service(driver, client);
+}
+
+static void *publisher_thread(void *_driver) {
+	SurviveDriverPublisher *driver = _driver;
+	SurviveContext *ctx = driver->ctx;
+
+	struct epoll_event events[PUBLISHER_MAX_CLIENTS + 3];
+	while (driver->keep_running) {
+		int cnt = epoll_wait(driver->epoll_fd, events, SURVIVE_ARRAY_SIZE(events), 100);
+		for (int i = 0; i < cnt; i++) {
+			void *ptr = events[i].data.ptr;
+			if (ptr == &driver->event_fd) {
+				uint64_t v;
+				if (read(driver->event_fd, &v, sizeof(v)) < 0 && errno != EAGAIN)
+					SV_WARN("Publisher failed to read its eventfd: %s", strerror(errno));
+				__atomic_store_n(&driver->wake_pending, 0, __ATOMIC_RELEASE);
+				for (int j = 0; j < PUBLISHER_MAX_CLIENTS; j++) {
+					if (driver->clients[j])
+						client_service(driver, driver->clients[j]);
+				}
+			} else if (ptr == &driver->tcp_fd) {
+				accept_client(driver, driver->tcp_fd);
+			} else if (ptr == &driver->ws_fd) {
+				accept_client(driver, driver->ws_fd);
+			} else {
+				// An earlier event in this batch may have closed the client already
+				publisher_client *client = ptr;
+				if (!client_is_open(driver, client))
+					continue;
+				if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+					client_close(driver, client);
+					continue;
+				}
+				if (events[i].events & EPOLLIN) {
+					client_read(driver, client);
+					if (!client_is_open(driver, client))
+						continue;
+				}
+				if (events[i].events & EPOLLOUT)
+					client_service(driver, client);
+			}
+		}
+	}
+	return 0;
+}
+
+/* Hooks; these run on the data thread and only touch the slot table */
+static publisher_slot *find_slot(SurviveDriverPublisher *driver, uint8_t type, const char *codename,
+								 uint8_t lighthouse) {
+	for (size_t i = 0; i < driver->slots_cnt; i++) {
+		survive_publisher_record *r = &driver->slots[i].record;
+		if (r->type == type && r->lighthouse == lighthouse && strncmp(r->codename, codename, sizeof(r->codename)) == 0)
+			return &driver->slots[i];
+	}
+
+	if (driver->slots_cnt >= PUBLISHER_MAX_SLOTS)
+		return 0;
+
+	publisher_slot *slot = &driver->slots[driver->slots_cnt++];
+	slot->record.type = type;
+	slot->record.lighthouse = lighthouse;
+	strncpy(slot->record.codename, codename, sizeof(slot->record.codename) - 1);
+	return slot;
+}
+
+static void publish(SurviveDriverPublisher *driver, uint8_t type, const char *codename, uint8_t lighthouse,
+					survive_long_timecode timecode, const FLT *values, size_t values_cnt) {
+	OGLockMutex(driver->lock);
+	publisher_slot *slot = find_slot(driver, type, codename, lighthouse);
+	if (slot) {
+		// 0 is reserved to mean 'never queued' on the client side
+		if (++driver->sequence == 0)
+			driver->sequence = 1;
+
+		slot->record.timecode = timecode;
+		slot->record.sequence = driver->sequence;
+		for (size_t i = 0; i < values_cnt; i++)
+			slot->record.values[i] = (float)values[i];
+		slot->sequence = driver->sequence;
+	}
+	OGUnlockMutex(driver->lock);
+
+	// Only the first value since the network thread last woke up needs to poke it
+	if (__atomic_exchange_n(&driver->wake_pending, 1, __ATOMIC_ACQ_REL) == 0) {
+		uint64_t one = 1;
+		if (write(driver->event_fd, &one, sizeof(one)) < 0) {
+			__atomic_store_n(&driver->wake_pending, 0, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+static void publisher_pose(SurviveObject *so, survive_long_timecode timecode, const SurvivePose *pose) {
+	SurviveDriverPublisher *driver =
+		(SurviveDriverPublisher *)survive_get_driver_by_closefn(so->ctx, publisher_close);
+	driver->pose_fn(so, timecode, pose);
+	if (!__atomic_load_n(&driver->closed, __ATOMIC_SEQ_CST))
+		publish(driver, SURVIVE_PUBLISHER_POSE, so->codename, 0, timecode, pose->Pos, 7);
+}
+
+static void publisher_velocity(SurviveObject *so, survive_long_timecode timecode, const SurviveVelocity *velocity) {
+	SurviveDriverPublisher *driver =
+		(SurviveDriverPublisher *)survive_get_driver_by_closefn(so->ctx, publisher_close);
+	driver->velocity_fn(so, timecode, velocity);
+	if (!__atomic_load_n(&driver->closed, __ATOMIC_SEQ_CST))
+		publish(driver, SURVIVE_PUBLISHER_VELOCITY, so->codename, 0, timecode, velocity->Pos, 6);
+}
+
+static void publisher_lighthouse_pose(SurviveContext *ctx, uint8_t lighthouse, const SurvivePose *lighthouse_pose) {
+	SurviveDriverPublisher *driver = (SurviveDriverPublisher *)survive_get_driver_by_closefn(ctx, publisher_close);
+	driver->lighthouse_pose_fn(ctx, lighthouse, lighthouse_pose);
+	if (!__atomic_load_n(&driver->closed, __ATOMIC_SEQ_CST) && lighthouse_pose)
+		publish(driver, SURVIVE_PUBLISHER_LIGHTHOUSE_POSE, "", lighthouse, 0, lighthouse_pose->Pos, 7);
+}
+
+// Puts back the hooks DriverRegPublisher replaced, where ours is still the one installed; false if any of ours has to
+// stay because something was chained on top of it
+static bool publisher_remove_hooks(SurviveContext *ctx, SurviveDriverPublisher *driver) {
+	bool removed = true;
+
+	pose_process_func pose_fn = survive_install_pose_fn(ctx, driver->pose_fn);
+	if (pose_fn != publisher_pose) {
+		survive_install_pose_fn(ctx, pose_fn);
+		removed = false;
+	}
+
+	velocity_process_func velocity_fn = survive_install_velocity_fn(ctx, driver->velocity_fn);
+	if (velocity_fn != publisher_velocity) {
+		survive_install_velocity_fn(ctx, velocity_fn);
+		removed = false;
+	}
+
+	lighthouse_pose_process_func lighthouse_pose_fn =
+		survive_install_lighthouse_pose_fn(ctx, driver->lighthouse_pose_fn);
+	if (lighthouse_pose_fn != publisher_lighthouse_pose) {
+		survive_install_lighthouse_pose_fn(ctx, lighthouse_pose_fn);
+		removed = false;
+	}
+	return removed;
+}
+
+static int publisher_close(struct SurviveContext *ctx, void *_driver) {
+	SurviveDriverPublisher *driver = _driver;
+	bool hooks_removed = publisher_remove_hooks(ctx, driver);
+	__atomic_store_n(&driver->closed, true, __ATOMIC_SEQ_CST);
+
+	driver->keep_running = false;
+	OGJoinThread(driver->thread);
+
+	for (int i = 0; i < PUBLISHER_MAX_CLIENTS; i++) {
+		if (driver->clients[i])
+			client_close(driver, driver->clients[i]);
+	}
+
+	if (driver->tcp_fd >= 0)
+		close(driver->tcp_fd);
+	if (driver->ws_fd >= 0)
+		close(driver->ws_fd);
+	close(driver->event_fd);
+	close(driver->epoll_fd);
+	OGDeleteMutex(driver->lock);
+
+	if (hooks_removed)
+		free(driver);
+	return 0;
+}
+
+static int open_listener(SurviveContext *ctx, int port) {
+	if (port <= 0)
+		return -1;
+
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	int one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	struct sockaddr_in addr = {0};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+		SV_WARN("Publisher could not listen on port %d: %s", port, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int DriverRegPublisher(SurviveContext *ctx) {
+	SurviveDriverPublisher *driver = SV_CALLOC(sizeof(SurviveDriverPublisher));
+	driver->ctx = ctx;
+	driver->lock = OGCreateMutex();
+
+	driver->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	driver->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	driver->tcp_fd =
+		open_listener(ctx, survive_configi(ctx, PUBLISHER_PORT_TAG, SC_GET, SURVIVE_PUBLISHER_DEFAULT_PORT));
+	driver->ws_fd =
+		open_listener(ctx, survive_configi(ctx, PUBLISHER_WS_PORT_TAG, SC_GET, SURVIVE_PUBLISHER_DEFAULT_WS_PORT));
+
+	// The fd fields double as tags so the network thread can tell its own descriptors apart from clients
+	int *fds[] = {&driver->event_fd, &driver->tcp_fd, &driver->ws_fd};
+	for (int i = 0; i < SURVIVE_ARRAY_SIZE(fds); i++) {
+		if (*fds[i] < 0)
+			continue;
+		struct epoll_event ev = {.events = EPOLLIN, .data = {.ptr = fds[i]}};
+		epoll_ctl(driver->epoll_fd, EPOLL_CTL_ADD, *fds[i], &ev);
+	}
+
+	SV_INFO("Publishing poses on tcp port %d and websocket port %d",
+			driver->tcp_fd >= 0 ? survive_configi(ctx, PUBLISHER_PORT_TAG, SC_GET, 0) : 0,
+			driver->ws_fd >= 0 ? survive_configi(ctx, PUBLISHER_WS_PORT_TAG, SC_GET, 0) : 0);
+
+	driver->keep_running = true;
+	driver->thread = OGCreateThread(publisher_thread, "publisher", driver);
+
+	// Added before the hooks go in, so that they always find the driver
+	survive_add_driver(ctx, driver, NULL, publisher_close);
+	driver->pose_fn = survive_install_pose_fn(ctx, publisher_pose);
+	driver->velocity_fn = survive_install_velocity_fn(ctx, publisher_velocity);
+	driver->lighthouse_pose_fn = survive_install_lighthouse_pose_fn(ctx, publisher_lighthouse_pose);
+	return SURVIVE_DRIVER_PASSIVE;
+}
+
+REGISTER_LINKTIME(DriverRegPublisher)
@@ -0,0 +1,192 @@
+// All MIT/x11 Licensed Code in this file may be relicensed freely under the GPL
+// or LGPL licenses.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <survive.h>
+#include <survive_shm.h>
+
+#include "survive_kalman_tracker.h"
+
+STATIC_CONFIG_ITEM(SHM_ENABLE, "shm", 'b', "Publish object state into a shared memory segment", 0)
+STATIC_CONFIG_ITEM(SHM_NAME, "shm-name", 's', "Name of the shared memory segment used by --shm",
+				   SURVIVE_SHM_DEFAULT_NAME)
+
+typedef struct SurviveDriverShm {
+	SurviveContext *ctx;
+	char name[64];
+	survive_shm_segment *seg;
+
+	// Object published at each index of seg->objects
+	const SurviveObject *objects[SURVIVE_SHM_MAX_OBJECTS];
+
+	pose_process_func pose_fn;
+	velocity_process_func velocity_fn;
+	// Set by shm_close, after which the hooks only forward; the driver stays allocated if they couldn't be taken out
+	bool closed;
+} SurviveDriverShm;
+
+static int shm_close(struct SurviveContext *ctx, void *_driver);
+
+static survive_shm_object *shm_object(SurviveDriverShm *driver, SurviveObject *so) {
+	SurviveContext *ctx = driver->ctx;
+	uint32_t idx = driver->seg->object_cnt;
+	for (uint32_t i = 0; i < idx; i++) {
+		if (driver->objects[i] == so)
+			return &driver->seg->objects[i];
+	}
+
+	if (idx >= SURVIVE_SHM_MAX_OBJECTS)
+		return 0;
+
+	// The codename is written before the object becomes visible, so readers never need the seqlock for it
+	survive_shm_object *obj = &driver->seg->objects[idx];
+	strncpy(obj->state.codename, so->codename, sizeof(obj->state.codename) - 1);
+	__atomic_store_n(&driver->seg->object_cnt, idx + 1, __ATOMIC_RELEASE);
+	driver->objects[idx] = so;
+
+	SV_VERBOSE(10, "Publishing %s at shared memory slot %u", so->codename, idx);
+	return obj;
+}
+
+static inline void shm_write_begin(survive_shm_object *obj) {
+	__atomic_store_n(&obj->seq, obj->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void shm_write_end(survive_shm_object *obj) {
+	__atomic_store_n(&obj->seq, obj->seq + 1, __ATOMIC_RELEASE);
+}
+
+static void shm_write_pose(SurviveDriverShm *driver, SurviveObject *so, survive_long_timecode timecode,
+						   const SurvivePose *pose) {
+	survive_shm_object *obj = shm_object(driver, so);
+	if (obj == 0)
+		return;
+
+	// Pose part of the diagonal: 7 entries for the full state model, 6 (pos, axis angle) for the error state model
+	FLT variance[7] = {0};
+	if (so->tracker && so->tracker->model.P.rows > 0) {
+		int cnt = linmath_imin(7, so->tracker->model.P.rows);
+		for (int i = 0; i < cnt; i++)
+			variance[i] = cnMatrixGet(&so->tracker->model.P, i, i);
+	}
+
+	shm_write_begin(obj);
+	obj->state.timecode = timecode;
+	obj->state.pose_cnt++;
+	for (int i = 0; i < 3; i++)
+		obj->state.pose[i] = pose->Pos[i];
+	for (int i = 0; i < 4; i++)
+		obj->state.pose[3 + i] = pose->Rot[i];
+	for (int i = 0; i < 7; i++)
+		obj->state.pose_variance[i] = variance[i];
+	shm_write_end(obj);
+}
+
+static void shm_write_velocity(SurviveDriverShm *driver, SurviveObject *so, survive_long_timecode timecode,
+							   const SurviveVelocity *velocity) {
+	survive_shm_object *obj = shm_object(driver, so);
+	if (obj == 0)
+		return;
+
+	shm_write_begin(obj);
+	obj->state.velocity_cnt++;
+	for (int i = 0; i < 3; i++) {
+		obj->state.velocity[i] = velocity->Pos[i];
+		obj->state.velocity[3 + i] = velocity->AxisAngleRot[i];
+	}
+	shm_write_end(obj);
+}
+
+static void shm_pose(SurviveObject *so, survive_long_timecode timecode, const SurvivePose *pose) {
+	SurviveDriverShm *driver = (SurviveDriverShm *)survive_get_driver_by_closefn(so->ctx, shm_close);
+	driver->pose_fn(so, timecode, pose);
+	if (!__atomic_load_n(&driver->closed, __ATOMIC_SEQ_CST))
+		shm_write_pose(driver, so, timecode, pose);
+}
+
+static void shm_velocity(SurviveObject *so, survive_long_timecode timecode, const SurviveVelocity *velocity) {
+	SurviveDriverShm *driver = (SurviveDriverShm *)survive_get_driver_by_closefn(so->ctx, shm_close);
+	driver->velocity_fn(so, timecode, velocity);
+	if (!__atomic_load_n(&driver->closed, __ATOMIC_SEQ_CST))
+		shm_write_velocity(driver, so, timecode, velocity);
+}
+
+// Puts back the hooks DriverRegShm replaced, where ours is still the one installed; false if any of ours has to stay
+// because something was chained on top of it
+static bool shm_remove_hooks(SurviveContext *ctx, SurviveDriverShm *driver) {
+	bool removed = true;
+
+	pose_process_func pose_fn = survive_install_pose_fn(ctx, driver->pose_fn);
+	if (pose_fn != shm_pose) {
+		survive_install_pose_fn(ctx, pose_fn);
+		removed = false;
+	}
+
+	velocity_process_func velocity_fn = survive_install_velocity_fn(ctx, driver->velocity_fn);
+	if (velocity_fn != shm_velocity) {
+		survive_install_velocity_fn(ctx, velocity_fn);
+		removed = false;
+	}
+	return removed;
+}
+
+static int shm_close(struct SurviveContext *ctx, void *_driver) {
+	SurviveDriverShm *driver = _driver;
+	bool hooks_removed = shm_remove_hooks(ctx, driver);
+	__atomic_store_n(&driver->closed, true, __ATOMIC_SEQ_CST);
+
+	// Readers that still have it mapped keep the last values and can see that nobody is writing anymore
+	__atomic_store_n(&driver->seg->writer_pid, 0, __ATOMIC_RELEASE);
+	munmap(driver->seg, sizeof(survive_shm_segment));
+	shm_unlink(driver->name);
+
+	if (hooks_removed)
+		free(driver);
+	return 0;
+}
+
+int DriverRegShm(SurviveContext *ctx) {
+	const char *name = survive_configs(ctx, SHM_NAME_TAG, SC_GET, SURVIVE_SHM_DEFAULT_NAME);
+
+	int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		SV_WARN("Could not open shared memory segment %s: %s", name, strerror(errno));
+		return -1;
+	}
+
+	void *mem = MAP_FAILED;
+	if (ftruncate(fd, sizeof(survive_shm_segment)) == 0)
+		mem = mmap(0, sizeof(survive_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		SV_WARN("Could not map shared memory segment %s: %s", name, strerror(errno));
+		shm_unlink(name);
+		return -1;
+	}
+
+	SurviveDriverShm *driver = SV_CALLOC(sizeof(SurviveDriverShm));
+	driver->ctx = ctx;
+	driver->seg = mem;
+	strncpy(driver->name, name, sizeof(driver->name) - 1);
+
+	// A stale segment from a previous run is reset; readers check magic/version only when they attach
+	memset(driver->seg, 0, sizeof(survive_shm_segment));
+	driver->seg->object_size = sizeof(survive_shm_object);
+	driver->seg->version = SURVIVE_SHM_VERSION;
+	driver->seg->writer_pid = getpid();
+	__atomic_store_n(&driver->seg->magic, SURVIVE_SHM_MAGIC, __ATOMIC_RELEASE);
+
+	SV_INFO("Publishing object state to shared memory segment %s", name);
+
+	// Added before the hooks go in, so that they always find the driver
+	survive_add_driver(ctx, driver, NULL, shm_close);
+	driver->pose_fn = survive_install_pose_fn(ctx, shm_pose);
+	driver->velocity_fn = survive_install_velocity_fn(ctx, shm_velocity);
+	return SURVIVE_DRIVER_PASSIVE;
+}
+
+REGISTER_LINKTIME(DriverRegShm)
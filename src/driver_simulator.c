@@ -20,28 +20,95 @@
 STATIC_CONFIG_ITEM(Simulator_DRIVER_ENABLE, "simulator", 'b', "Load a Simulator driver for testing.", 0)
 
 typedef struct SurviveDriverSimulatorLHState {
-	FLT last_eval_time;
-
 	FLT period_s;
 	FLT start_time;
 } SurviveDriverSimulatorLHState;
 
+// splitmix64; each simulated object owns one so that its noise doesn't depend on how many other objects there are
+typedef struct SurviveSimulatorRNG {
+	uint64_t state;
+} SurviveSimulatorRNG;
+
+static uint64_t sim_rng_next(SurviveSimulatorRNG *rng) {
+	uint64_t z = (rng->state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static SurviveSimulatorRNG sim_rng_stream(uint64_t seed, uint64_t stream) {
+	SurviveSimulatorRNG rng = {.state = seed};
+	rng.state ^= sim_rng_next(&(SurviveSimulatorRNG){.state = stream});
+	return rng;
+}
+
+static FLT sim_rand(SurviveSimulatorRNG *rng, FLT min, FLT max) {
+	FLT r = (sim_rng_next(rng) >> 11) * (1. / 9007199254740992.);
+	return min + r * (max - min);
+}
+
+static FLT sim_normrand(SurviveSimulatorRNG *rng, FLT mu, FLT sigma) {
+	FLT u1 = 1. - sim_rand(rng, 0, 1);
+	FLT u2 = sim_rand(rng, 0, 1);
+	return mu + sigma * sqrt(-2. * log(u1)) * cos(2. * LINMATHPI * u2);
+}
+
+enum SurviveSimulatorMotion {
+	SURVIVE_SIMULATOR_MOTION_ATTRACTORS, // Falls between the gravity attractors
+	SURVIVE_SIMULATOR_MOTION_STATIC,	 // Never moves
+	SURVIVE_SIMULATOR_MOTION_ORBIT,		 // Circles the origin while spinning about z
+	SURVIVE_SIMULATOR_MOTION_RANDOM,	 // Random walk in acceleration, pulled back to the origin
+};
+
+static const char *simulator_motion_names[] = {"attractors", "static", "orbit", "random", 0};
+
 typedef SurviveVelocity SurviveAcceleration;
-struct SurviveDriverSimulator {
-	int lh_version;
-	SurviveContext *ctx;
-	SurviveObject *so;
+struct SurviveDriverSimulator;
 
-	SurviveDriverSimulatorLHState lhstates[NUM_GEN2_LIGHTHOUSES];
-	BaseStationData bsd[NUM_GEN2_LIGHTHOUSES];
+typedef struct SurviveSimulatedObject {
+	struct SurviveDriverSimulator *driver;
+	SurviveObject *so;
+	int idx;
+	enum SurviveSimulatorMotion motion;
+	SurviveSimulatorRNG rng;
 
 	SurvivePose position;
 	SurviveVelocity velocity;
 	SurviveAcceleration accel;
 
+	FLT lh_last_eval_time[NUM_GEN2_LIGHTHOUSES];
 	FLT time_last_imu;
 	FLT time_last_light;
+	int acode;
+
+	FLT gyro_bias[3];
+	char gt_name[16];
+
+	struct variance_measure pose_variance;
+} SurviveSimulatedObject;
+
+struct SurviveDriverSimulator {
+	int lh_version;
+	SurviveContext *ctx;
+
+	SurviveSimulatedObject *objects;
+	int object_cnt;
+
+	// Scene setup: sensor layouts, lighthouse phases and calibration noise
+	SurviveSimulatorRNG rng;
+
+	SurviveDriverSimulatorLHState lhstates[NUM_GEN2_LIGHTHOUSES];
+	BaseStationData bsd[NUM_GEN2_LIGHTHOUSES];
+
 	FLT time_last_iterate;
+	FLT last_realtime;
+	FLT realtime_start;
+	int last_report_minute;
+
+	// Set when time-factor is 0; simulated time then advances as fast as the events are consumed and
+	// survive_run_time follows the simulation clock instead of the wall clock
+	bool free_running;
+	bool attractors_reported;
 
 	FLT noise_scale;
 	FLT sensor_var;
@@ -51,17 +118,13 @@ struct SurviveDriverSimulator {
 	FLT scale_error;
 	FLT timestart;
 	FLT current_timestamp;
-	int acode;
 
-	FLT gyro_bias[3];
 	FLT gyro_bias_scale;
 	FLT gyro_var;
 	FLT sensor_jitter;
 	FLT acc_var;
 	int show_gt_device_cfg;
 
-	struct variance_measure pose_variance;
-
 	pose_process_func pose_fn;
 	lighthouse_pose_process_func lh_fn;
 
@@ -72,6 +135,8 @@ struct SurviveDriverSimulator {
 		FLT time_factor;
 		int obj_sensors;
 		int attractors;
+		int objects;
+		int seed;
 
 		FLT lh_duty_cycle;
 		int report_in_imu;
@@ -79,6 +144,16 @@ struct SurviveDriverSimulator {
 };
 typedef struct SurviveDriverSimulator SurviveDriverSimulator;
 
+#define SIMULATOR_MAX_OBJECTS 100
+
+STATIC_CONFIG_ITEM(SIMULATOR_TIME_FACTOR, "time-factor", 'f',
+				   "Time factor of the simulator -- 1 runs in real time, 0 runs as fast as possible", 1.)
+
+STATIC_CONFIG_ITEM(SIMULATOR_MOTION, "simulator-motion", 's',
+				   "Comma separated motion profiles (attractors, static, orbit, random); object n uses entry n modulo "
+				   "the list length",
+				   "attractors")
+
 // clang-format off
 STRUCT_CONFIG_SECTION(SurviveDriverSimulator)
     STRUCT_CONFIG_ITEM("simulator-attractors",  "Number on gravity attractors in simulation", 3, t->settings.attractors)
@@ -97,17 +172,18 @@ STRUCT_CONFIG_SECTION(SurviveDriverSimulator)
     STRUCT_CONFIG_ITEM("simulator-sensor-droprate", "Chance to drop a sensor reading", .2, t->sensor_droprate)
     STRUCT_CONFIG_ITEM("simulator-noise-scale", "", 1., t->noise_scale)
     STRUCT_CONFIG_ITEM("simulator-lh-gen", "Lighthouse generation", 1, t->lh_version)
+    STRUCT_CONFIG_ITEM("simulator-objects", "Number of independently moving objects to simulate", 1, t->settings.objects)
+    STRUCT_CONFIG_ITEM("simulator-seed", "Seed for the simulation; runs with the same seed and settings are identical", 42, t->settings.seed)
 
     STRUCT_CONFIG_ITEM("simulator-lh-duty-cycle", "Duty cycle of lighthouses", 1., t->settings.lh_duty_cycle)
     STRUCT_EXISTING_CONFIG_ITEM("report-in-imu",t->settings.report_in_imu)
 END_STRUCT_CONFIG_SECTION(SurviveDriverSimulator)
 // clang-format on
 
-static double timestamp_in_s() {
-	static double start_time_s = 0;
-	if (start_time_s == 0.)
-		start_time_s = OGGetAbsoluteTime();
-	return OGGetAbsoluteTime() - start_time_s;
+static double timestamp_in_s(SurviveDriverSimulator *driver) {
+	if (driver->realtime_start == 0.)
+		driver->realtime_start = OGGetAbsoluteTime();
+	return OGGetAbsoluteTime() - driver->realtime_start;
 }
 
 static FLT lighthouse_lasttime_of_angle(SurviveDriverSimulator *driver, int lh, FLT timestamp, FLT angle) {
@@ -123,12 +199,13 @@ FLT lighthouse_angle(SurviveDriverSimulator *driver, int lh, FLT timestamp) {
 	FLT angle = fmod(timestamp - lhs->start_time, lhs->period_s) / lhs->period_s * 2. * LINMATHPI;
 	return angle;
 }
-static bool lighthouse_sensor_angle(SurviveDriverSimulator *driver, int lh, size_t idx, SurviveAngleReading ang) {
+static bool lighthouse_sensor_angle(SurviveSimulatedObject *obj, int lh, size_t idx, SurviveAngleReading ang) {
+	SurviveDriverSimulator *driver = obj->driver;
 	SurviveContext *ctx = driver->ctx;
 	LinmathVec3d pt;
-	copy3d(pt, driver->so->sensor_locations + idx * 3);
+	copy3d(pt, obj->so->sensor_locations + idx * 3);
 
-	SurvivePose imu2trackref = driver->so->imu2trackref;
+	SurvivePose imu2trackref = obj->so->imu2trackref;
 	SurvivePose trackref2imu = InvertPoseRtn(&imu2trackref);
 
 	ApplyPoseToPoint(pt, &imu2trackref, pt);
@@ -144,7 +221,7 @@ static bool lighthouse_sensor_angle(SurviveDriverSimulator *driver, int lh, size
 
 	LinmathVec3d ptInWorld;
 	LinmathVec3d normalInWorld;
-	ApplyPoseToPoint(ptInWorld, &driver->position, pt);
+	ApplyPoseToPoint(ptInWorld, &obj->position, pt);
 	SurvivePose world2lh = InvertPoseRtn(&driver->bsd[lh].Pose);
 	LinmathPoint3d ptInLh;
 	ApplyPoseToPoint(ptInLh, &world2lh, ptInWorld);
@@ -154,13 +231,13 @@ static bool lighthouse_sensor_angle(SurviveDriverSimulator *driver, int lh, size
 		normalize3d(dirLh, ptInLh);
 		scale3d(dirLh, dirLh, -1);
 
-		quatrotatevector(normalInWorld, driver->position.Rot, driver->so->sensor_normals + idx * 3);
+		quatrotatevector(normalInWorld, obj->position.Rot, obj->so->sensor_normals + idx * 3);
 
 		LinmathVec3d normalInLh;
 		quatrotatevector(normalInLh, world2lh.Rot, normalInWorld);
 
 		FLT facingness = dot3d(normalInLh, dirLh);
-		if (facingness > 0 && linmath_rand(0, 1.) > driver->sensor_droprate * driver->noise_scale) {
+		if (facingness > 0 && sim_rand(&obj->rng, 0, 1.) > driver->sensor_droprate * driver->noise_scale) {
 			if (driver->lh_version == 0) {
 				survive_reproject_xy(driver->bsd[lh].fcal, ptInLh, ang);
 				for (int i = 0; i < 2; i++) {
@@ -174,7 +251,7 @@ static bool lighthouse_sensor_angle(SurviveDriverSimulator *driver, int lh, size
 			}
 
 			for (int i = 0; i < 2; i++) {
-				ang[i] += linmath_normrand(0, driver->sensor_var * driver->noise_scale);
+				ang[i] += sim_normrand(&obj->rng, 0, driver->sensor_var * driver->noise_scale);
 			}
 			return true;
 		}
@@ -194,28 +271,29 @@ static int event_compare(const void *p, const void *q) {
 
 	return x->time > y->time;
 }
-static size_t run_lighthouse_v2(SurviveDriverSimulator *driver, int lh, FLT timestamp, struct lh_event *events) {
+static size_t run_lighthouse_v2(SurviveSimulatedObject *obj, int lh, FLT timestamp, struct lh_event *events) {
+	SurviveDriverSimulator *driver = obj->driver;
 	SurviveContext *ctx = driver->ctx;
-	SurviveDriverSimulatorLHState *lhs = &driver->lhstates[lh];
+	FLT last_eval_time = obj->lh_last_eval_time[lh];
 
 	size_t evt_idx = 0;
 
 	FLT sync_time = lighthouse_sync_time(driver, lh, timestamp);
 
-	if (sync_time >= lhs->last_eval_time && sync_time <= timestamp) {
+	if (sync_time >= last_eval_time && sync_time <= timestamp) {
 		// fprintf(stderr, "Sync %d %f %f\n", lh, sync_time, timestamp);
 		events[evt_idx].time = sync_time;
 		events[evt_idx].lh = lh;
 		events[evt_idx++].idx = -1;
 	}
 
-	for (size_t idx = 0; idx < driver->so->sensor_ct; idx++) {
+	for (size_t idx = 0; idx < obj->so->sensor_ct; idx++) {
 		SurviveAngleReading ang;
 
-		if (lighthouse_sensor_angle(driver, lh, idx, ang)) {
+		if (lighthouse_sensor_angle(obj, lh, idx, ang)) {
 			for (int axis = 0; axis < 2; axis++) {
 				FLT angle_time = lighthouse_lasttime_of_angle(driver, lh, timestamp, ang[axis]);
-				if (angle_time >= lhs->last_eval_time && angle_time <= timestamp) {
+				if (angle_time >= last_eval_time && angle_time <= timestamp) {
 					events[evt_idx].time = angle_time;
 					events[evt_idx].lh = lh;
 					events[evt_idx++].idx = idx;
@@ -224,103 +302,105 @@ static size_t run_lighthouse_v2(SurviveDriverSimulator *driver, int lh, FLT time
 		}
 	}
 
-	lhs->last_eval_time = timestamp;
+	obj->lh_last_eval_time[lh] = timestamp;
 
 	return evt_idx;
 }
-static void run_lighthouse_v1(SurviveDriverSimulator *driver, int lh, FLT timestamp) {
+static void run_lighthouse_v1(SurviveSimulatedObject *obj, int lh, FLT timestamp) {
+	SurviveDriverSimulator *driver = obj->driver;
 	SurviveContext *ctx = driver->ctx;
 	survive_timecode timecode = (survive_timecode)round(timestamp * 48000000.);
 
 	if (lh >= ctx->activeLighthouses || driver->bsd[lh].PositionSet == false) {
-		driver->acode = (driver->acode + 1) % 4;
+		obj->acode = (obj->acode + 1) % 4;
 	} else {
-		for (int idx = 0; idx < driver->so->sensor_ct; idx++) {
+		for (int idx = 0; idx < obj->so->sensor_ct; idx++) {
 			SurviveAngleReading ang = {0};
-			if (lighthouse_sensor_angle(driver, lh, idx, ang)) {
+			if (lighthouse_sensor_angle(obj, lh, idx, ang)) {
 				if (driver->lh_version == 0) {
-					int acode = (lh << 2) + (driver->acode & 1);
-					SURVIVE_INVOKE_HOOK_SO(angle, driver->so, idx, acode, timecode, .006, ang[driver->acode & 1], lh);
+					int acode = (lh << 2) + (obj->acode & 1);
+					SURVIVE_INVOKE_HOOK_SO(angle, obj->so, idx, acode, timecode, .006, ang[obj->acode & 1], lh);
 				} else {
-					SURVIVE_INVOKE_HOOK_SO(sweep_angle, driver->so, driver->bsd[lh].mode, idx, timecode,
-										   driver->acode & 1, ang[driver->acode & 1]);
+					SURVIVE_INVOKE_HOOK_SO(sweep_angle, obj->so, driver->bsd[lh].mode, idx, timecode, obj->acode & 1,
+										   ang[obj->acode & 1]);
 				}
 			}
 		}
 
 		if (driver->lh_version == 0) {
-			int acode = (lh << 2) + (driver->acode & 1);
-			SURVIVE_INVOKE_HOOK_SO(light, driver->so, -3, acode, 0, timecode, 100, lh);
-			driver->acode = (driver->acode + 1) % 4;
+			int acode = (lh << 2) + (obj->acode & 1);
+			SURVIVE_INVOKE_HOOK_SO(light, obj->so, -3, acode, 0, timecode, 100, lh);
+			obj->acode = (obj->acode + 1) % 4;
 		} else {
-			SURVIVE_INVOKE_HOOK_SO(sync, driver->so, driver->bsd[lh].mode, timecode, false, false);
-			driver->acode = (driver->acode + 1) % 4;
+			SURVIVE_INVOKE_HOOK_SO(sync, obj->so, driver->bsd[lh].mode, timecode, false, false);
+			obj->acode = (obj->acode + 1) % 4;
 		}
 	}
 }
 
-static bool run_imu(struct SurviveContext *ctx, SurviveDriverSimulator *driver, double timestamp,
+static bool run_imu(struct SurviveContext *ctx, SurviveSimulatedObject *obj, double timestamp,
 					double time_between_imu, survive_long_timecode timecode) {
+	SurviveDriverSimulator *driver = obj->driver;
 	bool update_gt = false;
-	if (timestamp > time_between_imu + driver->time_last_imu) {
+	if (timestamp > time_between_imu + obj->time_last_imu) {
 		update_gt = true;
 		// ( SurviveObject * so, int mask, FLT * accelgyro, survive_timecode timecode, int id );
 		FLT accelgyro[9] = {0, 0, 0,  // Acc
 							0, 0, 0,  // Gyro
 							0, 0, 0}; // Mag
 
-		add3d(accelgyro, accelgyro, driver->accel.Pos);
+		add3d(accelgyro, accelgyro, obj->accel.Pos);
 		scale3d(accelgyro, accelgyro, 1. / 9.80665);
 
 		SV_VERBOSE(200, "(Gt)Acc\t\t" Point3_format "\t%f", LINMATH_VEC3_EXPAND(accelgyro), norm3d(accelgyro));
 		accelgyro[2] += 1;
 
-		SurvivePose ip = InvertPoseRtn(&driver->position);
 		LinmathQuat q;
-		quatgetconjugate(q, driver->position.Rot);
+		quatgetconjugate(q, obj->position.Rot);
 		quatrotatevector(accelgyro, q, accelgyro);
-		quatrotatevector(accelgyro + 3, q, driver->velocity.AxisAngleRot);
-		add3d(accelgyro + 3, accelgyro + 3, driver->gyro_bias);
+		quatrotatevector(accelgyro + 3, q, obj->velocity.AxisAngleRot);
+		add3d(accelgyro + 3, accelgyro + 3, obj->gyro_bias);
 
 		for (int i = 0; i < 3; i++) {
-			accelgyro[i] += linmath_normrand(0, driver->acc_var * driver->noise_scale);
-			accelgyro[i + 3] += linmath_normrand(0, driver->gyro_var * driver->noise_scale);
+			accelgyro[i] += sim_normrand(&obj->rng, 0, driver->acc_var * driver->noise_scale);
+			accelgyro[i + 3] += sim_normrand(&obj->rng, 0, driver->gyro_var * driver->noise_scale);
 		}
 
-		SV_VERBOSE(200, "Ang: " Point3_format, LINMATH_VEC3_EXPAND(driver->velocity.AxisAngleRot));
-		SV_VERBOSE(200, "GT: " SurvivePose_format " %f", SURVIVE_POSE_EXPAND(driver->position),
-				   quatmagnitude(driver->position.Rot));
+		SV_VERBOSE(200, "Ang: " Point3_format, LINMATH_VEC3_EXPAND(obj->velocity.AxisAngleRot));
+		SV_VERBOSE(200, "GT: " SurvivePose_format " %f", SURVIVE_POSE_EXPAND(obj->position),
+				   quatmagnitude(obj->position.Rot));
 		if (driver->show_gt_device_cfg != 2) {
-			SURVIVE_INVOKE_HOOK_SO(imu, driver->so, 3, accelgyro, timecode, 0);
+			SURVIVE_INVOKE_HOOK_SO(imu, obj->so, 3, accelgyro, timecode, 0);
 		}
 
 		for (int i = 0; i < 3; i++) {
-			driver->gyro_bias[i] += linmath_normrand(0, driver->gyro_bias_scale * driver->noise_scale) * .001;
+			obj->gyro_bias[i] += sim_normrand(&obj->rng, 0, driver->gyro_bias_scale * driver->noise_scale) * .001;
 		}
-		driver->time_last_imu = timestamp - 1e-10;
+		obj->time_last_imu = timestamp - 1e-10;
 	}
 	return update_gt;
 }
-bool run_light(const struct SurviveContext *ctx, SurviveDriverSimulator *driver, double timestamp,
+bool run_light(const struct SurviveContext *ctx, SurviveSimulatedObject *obj, double timestamp,
 			   double time_between_pulses) {
+	SurviveDriverSimulator *driver = obj->driver;
 	bool update_gt = false;
 	if (driver->show_gt_device_cfg == 2) {
 		return false;
 	}
 
 	if (driver->lh_version == 0) {
-		if (timestamp > time_between_pulses + driver->time_last_light) {
+		if (timestamp > time_between_pulses + obj->time_last_light) {
 			update_gt = true;
-			int lh = driver->acode >> 1;
+			int lh = obj->acode >> 1;
 
-			run_lighthouse_v1(driver, lh, timestamp);
-			driver->time_last_light = timestamp;
+			run_lighthouse_v1(obj, lh, timestamp);
+			obj->time_last_light = timestamp;
 		}
 	} else {
 		struct lh_event events[NUM_GEN2_LIGHTHOUSES * (SENSORS_PER_OBJECT + 1)];
 		size_t evt_idx = 0;
 		for (int i = 0; i < ctx->activeLighthouses; i++) {
-			evt_idx += run_lighthouse_v2(driver, i, timestamp, events + evt_idx);
+			evt_idx += run_lighthouse_v2(obj, i, timestamp, events + evt_idx);
 		}
 
 		qsort(events, evt_idx, sizeof *events, event_compare);
@@ -329,47 +409,48 @@ bool run_light(const struct SurviveContext *ctx, SurviveDriverSimulator *driver,
 			survive_timecode timecode = (survive_timecode)round(events[i].time * 48000000.);
 			uint8_t lh = events[i].lh;
 			if (events[i].idx == -1) {
-				SURVIVE_INVOKE_HOOK_SO(sync, driver->so, driver->bsd[lh].mode, timecode, 0, 0);
+				SURVIVE_INVOKE_HOOK_SO(sync, obj->so, driver->bsd[lh].mode, timecode, 0, 0);
 			} else {
-				SURVIVE_INVOKE_HOOK_SO(sweep, driver->so, driver->bsd[lh].mode, events[i].idx, timecode, 0);
+				SURVIVE_INVOKE_HOOK_SO(sweep, obj->so, driver->bsd[lh].mode, events[i].idx, timecode, 0);
 			}
 		}
 	}
 	return update_gt;
 }
-static void propagate_state(SurviveDriverSimulator *driver, double time_diff) {
+static void propagate_state(SurviveSimulatedObject *obj, double time_diff) {
 	SurviveVelocity velGain;
-	scale3d(velGain.Pos, driver->accel.Pos, time_diff);
-	scale3d(velGain.AxisAngleRot, driver->accel.AxisAngleRot, time_diff);
+	scale3d(velGain.Pos, obj->accel.Pos, time_diff);
+	scale3d(velGain.AxisAngleRot, obj->accel.AxisAngleRot, time_diff);
 
-	add3d(driver->velocity.Pos, driver->velocity.Pos, velGain.Pos);
-	add3d(driver->velocity.AxisAngleRot, velGain.AxisAngleRot, driver->velocity.AxisAngleRot);
+	add3d(obj->velocity.Pos, obj->velocity.Pos, velGain.Pos);
+	add3d(obj->velocity.AxisAngleRot, velGain.AxisAngleRot, obj->velocity.AxisAngleRot);
 
 	SurviveVelocity posGain;
-	scale3d(posGain.Pos, driver->velocity.Pos, time_diff);
-	add3d(driver->position.Pos, driver->position.Pos, posGain.Pos);
+	scale3d(posGain.Pos, obj->velocity.Pos, time_diff);
+	add3d(obj->position.Pos, obj->position.Pos, posGain.Pos);
 
-	survive_apply_ang_velocity(driver->position.Rot, driver->velocity.AxisAngleRot, time_diff, driver->position.Rot);
+	survive_apply_ang_velocity(obj->position.Rot, obj->velocity.AxisAngleRot, time_diff, obj->position.Rot);
 }
-static void update_gt_device(struct SurviveContext *ctx, const SurviveDriverSimulator *driver) {
+static void update_gt_device(struct SurviveContext *ctx, const SurviveSimulatedObject *obj) {
+	const SurviveDriverSimulator *driver = obj->driver;
 	if (driver->show_gt_device_cfg == 0)
 		return;
 
-	SurvivePose head2world = driver->position;
+	SurvivePose head2world = obj->position;
 	if (!driver->settings.report_in_imu) {
-		ApplyPoseToPose(&head2world, &driver->position, &driver->so->head2imu);
+		ApplyPoseToPose(&head2world, &obj->position, &obj->so->head2imu);
 	}
 
-	survive_default_external_pose_process(ctx, "Sim_GT", &head2world);
-	survive_default_external_velocity_process(ctx, "Sim_GT", &driver->velocity);
-	survive_recording_write_to_output(ctx->recptr, "%s FULL_STATE " Point16_format "\n", "Sim_GT",
-									  SURVIVE_POSE_EXPAND(head2world), SURVIVE_VELOCITY_EXPAND(driver->velocity),
-									  LINMATH_VEC3_EXPAND(&driver->accel.Pos[0]));
+	survive_default_external_pose_process(ctx, obj->gt_name, &head2world);
+	survive_default_external_velocity_process(ctx, obj->gt_name, &obj->velocity);
+	survive_recording_write_to_output(ctx->recptr, "%s FULL_STATE " Point16_format "\n", obj->gt_name,
+									  SURVIVE_POSE_EXPAND(head2world), SURVIVE_VELOCITY_EXPAND(obj->velocity),
+									  LINMATH_VEC3_EXPAND(&obj->accel.Pos[0]));
 }
-void apply_attractors(struct SurviveContext *ctx, SurviveDriverSimulator *driver) {
+static void apply_attractors(struct SurviveContext *ctx, SurviveSimulatedObject *obj) {
+	SurviveDriverSimulator *driver = obj->driver;
 	SurviveVelocity accel = {0};
 
-	FLT time_since_init = driver->current_timestamp - driver->init_time;
 	FLT s = 1.;
 
 	LinmathVec3d attractors[] = {{1, 1, 1}, {-1, 0, 1}, {0, -1, .5}};
@@ -379,102 +460,153 @@ void apply_attractors(struct SurviveContext *ctx, SurviveDriverSimulator *driver
 		attractor_cnt = sizeof(attractors) / sizeof(LinmathVec3d);
 	}
 
-	static bool reported = false;
-
 	for (int i = 0; i < attractor_cnt; i++) {
 		LinmathVec3d acc;
-		sub3d(acc, attractors[i], driver->position.Pos);
+		sub3d(acc, attractors[i], obj->position.Pos);
 		FLT r = norm3d(acc);
 		scale3d(acc, acc, s / r / r);
 		if (r < .1) {
 			scale3d(acc, acc, -1);
 		}
 		add3d(accel.Pos, accel.Pos, acc);
-		if (reported == false && ctx->recptr) {
+		if (driver->attractors_reported == false && ctx->recptr) {
 			survive_recording_write_to_output(ctx->recptr, "SPHERE attractor_%d %f %d " Point3_format "\n", i, .05,
 											  0x00FF00, LINMATH_VEC3_EXPAND(attractors[i]));
 		}
 	}
-	reported = true;
+	driver->attractors_reported = true;
 
-	if (attractor_cnt == 0) {
-		// accel.Pos[0] = 1 * cos(timestamp);
-	}
+	memcpy(&obj->accel, &accel, sizeof(accel));
+}
 
-	for (int i = 0; i < 3; i++) {
-		// accel.AxisAngleRot[i] += (((rand() / (FLT)RAND_MAX) - .5) * 10);
-		// accel.AxisAngleRot[i] = cos(timestamp);
-	}
+static FLT orbit_radius(const SurviveSimulatedObject *obj) { return .5 + .1 * (obj->idx % 5); }
+static FLT orbit_rate(const SurviveSimulatedObject *obj) { return .5 + .05 * (obj->idx % 7); }
 
-	memcpy(&driver->accel, &accel, sizeof(accel));
+// Sets the motion of the object for the next timestep, depending on its profile
+static void apply_motion(struct SurviveContext *ctx, SurviveSimulatedObject *obj) {
+	switch (obj->motion) {
+	case SURVIVE_SIMULATOR_MOTION_ATTRACTORS:
+		apply_attractors(ctx, obj);
+		for (int i = 0; i < 3; i++) {
+			obj->accel.AxisAngleRot[i] += sim_rand(&obj->rng, -1e-1, 1e-1);
+		}
+		break;
+	case SURVIVE_SIMULATOR_MOTION_STATIC:
+		memset(&obj->accel, 0, sizeof(obj->accel));
+		memset(&obj->velocity, 0, sizeof(obj->velocity));
+		break;
+	case SURVIVE_SIMULATOR_MOTION_ORBIT: {
+		// Centripetal acceleration for the objects circle; the phase is set in apply_initial_velocity
+		FLT w = orbit_rate(obj);
+		memset(&obj->accel, 0, sizeof(obj->accel));
+		obj->accel.Pos[0] = -w * w * obj->position.Pos[0];
+		obj->accel.Pos[1] = -w * w * obj->position.Pos[1];
+		break;
+	}
+	case SURVIVE_SIMULATOR_MOTION_RANDOM:
+		for (int i = 0; i < 3; i++) {
+			obj->accel.Pos[i] = sim_normrand(&obj->rng, 0, 1) - obj->position.Pos[i] - obj->velocity.Pos[i];
+			obj->accel.AxisAngleRot[i] = sim_normrand(&obj->rng, 0, 1) - obj->velocity.AxisAngleRot[i];
+		}
+		obj->accel.Pos[2] += 1.;
+		break;
+	}
 }
-static void apply_initial_position(SurviveDriverSimulator *driver) {
+
+static void apply_initial_position(SurviveSimulatedObject *obj) {
 	FLT up[] = {0, 0, 1};
 	FLT ones[] = {1, -1, 1};
-	quatfrom2vectors(driver->position.Rot, up, ones);
+	quatfrom2vectors(obj->position.Rot, up, ones);
 	for (int i = 0; i < 3; i++)
-		driver->position.Pos[i] = 0;
+		obj->position.Pos[i] = 0;
+
+	// Additional objects start spread out on a circle so they aren't all on top of each other
+	if (obj->idx > 0 || obj->motion == SURVIVE_SIMULATOR_MOTION_ORBIT) {
+		FLT phase = obj->idx * 2.39996322972865332; // Golden angle
+		FLT r = obj->motion == SURVIVE_SIMULATOR_MOTION_ORBIT ? orbit_radius(obj) : .3 + .05 * (obj->idx % 10);
+		obj->position.Pos[0] = r * cos(phase);
+		obj->position.Pos[1] = r * sin(phase);
+		obj->position.Pos[2] = obj->motion == SURVIVE_SIMULATOR_MOTION_ORBIT ? 1. : 0.;
+	}
 }
 
-static void apply_initial_velocity(SurviveDriverSimulator *sp) {
-	SurviveContext *ctx = sp->ctx;
+static void apply_initial_velocity(SurviveSimulatedObject *obj) {
+	SurviveDriverSimulator *sp = obj->driver;
 
-	int attractor_cnt = sp->settings.attractors;
-	if (attractor_cnt >= 0) {
-		sp->velocity.AxisAngleRot[0] = sp->velocity.AxisAngleRot[1] = sp->velocity.AxisAngleRot[2] = 1.;
-	}
+	switch (obj->motion) {
+	case SURVIVE_SIMULATOR_MOTION_ATTRACTORS: {
+		int attractor_cnt = sp->settings.attractors;
+		if (attractor_cnt >= 0) {
+			obj->velocity.AxisAngleRot[0] = obj->velocity.AxisAngleRot[1] = obj->velocity.AxisAngleRot[2] = 1.;
+		}
 
-	if (attractor_cnt == 1) {
-		for (int i = 0; i < 3; i++)
-			sp->velocity.Pos[i] = 2. * rand() / RAND_MAX - 1;
+		if (attractor_cnt == 1) {
+			for (int i = 0; i < 3; i++)
+				obj->velocity.Pos[i] = sim_rand(&obj->rng, -1, 1);
+		}
+		break;
+	}
+	case SURVIVE_SIMULATOR_MOTION_ORBIT: {
+		FLT w = orbit_rate(obj);
+		obj->velocity.Pos[0] = -w * obj->position.Pos[1];
+		obj->velocity.Pos[1] = w * obj->position.Pos[0];
+		obj->velocity.AxisAngleRot[2] = w;
+		break;
+	}
+	default:
+		break;
 	}
 }
 
 static int Simulator_poll(struct SurviveContext *ctx, void *_driver) {
 	SurviveDriverSimulator *driver = _driver;
-	static FLT last_time = 0;
-	FLT realtime = timestamp_in_s();
+	FLT realtime = timestamp_in_s(driver);
 
 	FLT timefactor = driver->settings.time_factor;
 	FLT timestep = .01;
 
-	while (last_time != 0 && last_time + timefactor * timestep > realtime) {
+	while (!driver->free_running && driver->last_realtime != 0 &&
+		   driver->last_realtime + timefactor * timestep > realtime) {
 		survive_release_ctx_lock(ctx);
-		OGUSleep((timefactor * timestep + realtime - last_time) * 1e6);
+		OGUSleep((timefactor * timestep + realtime - driver->last_realtime) * 1e6);
 		survive_get_ctx_lock(ctx);
-		realtime = timestamp_in_s();
+		realtime = timestamp_in_s(driver);
+	}
+	driver->last_realtime = realtime;
+
+	int report_minute = driver->current_timestamp / 60.;
+	if (report_minute != driver->last_report_minute) {
+		SV_VERBOSE(10, "Simulated %6.2fs in %6.2fs real-time... (%6.2fx)", driver->current_timestamp, realtime,
+				   driver->current_timestamp / (realtime + 1e-10));
+		driver->last_report_minute = report_minute;
 	}
-	last_time = realtime;
 
 	bool wasIniting = driver->current_timestamp < driver->init_time;
 	FLT timestamp = (driver->current_timestamp += timestep);
-	FLT time_between_imu = 1. / driver->so->imu_freq;
 	FLT time_between_pulses = 0.00833333333;
-	FLT time_between_gt = time_between_imu;
 	bool isIniting = timestamp < driver->init_time || driver->init_time < 0;
 
-	bool update_gt = false;
-
-	FLT t = (timestamp - driver->timestart);
+	survive_long_timecode timecode = (survive_long_timecode)round(timestamp * 48000000.);
 
-	if (wasIniting == true && isIniting == false) {
-		apply_initial_velocity(driver);
-	}
+	for (int i = 0; i < driver->object_cnt; i++) {
+		SurviveSimulatedObject *obj = &driver->objects[i];
+		FLT time_between_imu = 1. / obj->so->imu_freq;
+		bool update_gt = false;
 
-	if (isIniting == false) {
-		apply_attractors(ctx, driver);
-		for (int i = 0; i < 3; i++) {
-			driver->accel.AxisAngleRot[i] += linmath_rand(-1e-1, 1e-1);
+		if (wasIniting == true && isIniting == false) {
+			apply_initial_velocity(obj);
 		}
-	}
 
-	survive_long_timecode timecode = (survive_long_timecode)round(timestamp * 48000000.);
+		if (isIniting == false) {
+			apply_motion(ctx, obj);
+		}
 
-	update_gt |= run_imu(ctx, driver, timestamp, time_between_imu, timecode);
-	update_gt |= run_light(ctx, driver, timestamp, time_between_pulses);
+		update_gt |= run_imu(ctx, obj, timestamp, time_between_imu, timecode);
+		update_gt |= run_light(ctx, obj, timestamp, time_between_pulses);
 
-	if (update_gt) {
-		update_gt_device(ctx, driver);
+		if (update_gt) {
+			update_gt_device(ctx, obj);
+		}
 	}
 
 	if (driver->time_last_iterate == 0) {
@@ -486,11 +618,14 @@ static int Simulator_poll(struct SurviveContext *ctx, void *_driver) {
 	// SV_INFO("%.013f", time_diff);
 	driver->time_last_iterate = timestamp;
 
-	propagate_state(driver, time_diff);
+	for (int i = 0; i < driver->object_cnt; i++) {
+		propagate_state(&driver->objects[i], time_diff);
+	}
 
 	FLT time = driver->settings.runtime;
 	if (timestamp - driver->timestart > time && time > 0) {
-		SV_INFO("Simulation finished after %f seconds", realtime);
+		SV_INFO("Simulation finished after %f seconds (%.2fx real-time)", realtime,
+				(timestamp - driver->timestart) / (realtime + 1e-10));
 		return 1;
 	}
 
@@ -534,43 +669,43 @@ static void simulation_lh_compare(SurviveContext *ctx, uint8_t lighthouse, const
 
 static void simulation_compare(SurviveObject *so, survive_long_timecode timecode, const SurvivePose *imupose) {
 	survive_default_imupose_process(so, timecode, imupose);
-	if (strcmp(so->drivername, "SIM") != 0) {
+	if (strcmp(so->drivername, "SIM") != 0 || so->driver == 0) {
 		return;
 	}
 	SurviveContext *ctx = so->ctx;
-	SurviveDriverSimulator *driver = so->driver;
+	SurviveSimulatedObject *obj = so->driver;
 
-	SurvivePose p = InvertPoseRtn(&driver->position);
+	SurvivePose p = InvertPoseRtn(&obj->position);
 	ApplyPoseToPose(&p, &p, &so->OutPoseIMU);
 
 	FLT error[7] = {0};
 	FLT verror[6] = {0};
 	FLT aerror[3] = {0};
-	subnd(error, driver->position.Pos, so->OutPoseIMU.Pos, 3);
+	subnd(error, obj->position.Pos, so->OutPoseIMU.Pos, 3);
 
 	for (int i = 0; i < 4; i++)
-		error[i + 3] = driver->position.Rot[i] * (driver->position.Rot[0] > 0 ? 1 : -1) -
+		error[i + 3] = obj->position.Rot[i] * (obj->position.Rot[0] > 0 ? 1 : -1) -
 					   so->OutPoseIMU.Rot[i] * (so->OutPoseIMU.Rot[0] > 0 ? 1 : -1);
 
-	subnd(verror, driver->velocity.Pos, so->velocity.Pos, 6);
-	subnd(aerror, driver->accel.Pos, so->acceleration, 3);
-	variance_measure_add(&driver->pose_variance, error);
+	subnd(verror, obj->velocity.Pos, so->velocity.Pos, 6);
+	subnd(aerror, obj->accel.Pos, so->acceleration, 3);
+	variance_measure_add(&obj->pose_variance, error);
 
 	FLT var[7];
-	variance_measure_calc(&driver->pose_variance, var);
-	SV_VERBOSE(110, "\tSimulation pose error     " Point7_format, LINMATH_VEC7_EXPAND(var));
-	SV_VERBOSE(110, "\tSimulation velocity error " Point6_format, LINMATH_VEC6_EXPAND(verror));
-	SV_VERBOSE(110, "\tSimulation acc error      " Point3_format, LINMATH_VEC3_EXPAND(aerror));
+	variance_measure_calc(&obj->pose_variance, var);
+	SV_VERBOSE(110, "\tSimulation %s pose error     " Point7_format, so->codename, LINMATH_VEC7_EXPAND(var));
+	SV_VERBOSE(110, "\tSimulation %s velocity error " Point6_format, so->codename, LINMATH_VEC6_EXPAND(verror));
+	SV_VERBOSE(110, "\tSimulation %s acc error      " Point3_format, so->codename, LINMATH_VEC3_EXPAND(aerror));
 	bool pos_unsync = norm3d(p.Pos) > .1 || norm3d(p.Rot + 1) > .2;
 	bool unsync = pos_unsync || normnd(verror, 6) > .1;
 	if (unsync || ctx->log_level >= 500) {
-		SV_VERBOSE(200, "Simulation diff:\t%+f\t%+f\t" SurvivePose_format, norm3d(p.Pos), norm3d(p.Rot + 1),
-				   SURVIVE_POSE_EXPAND(p));
+		SV_VERBOSE(200, "Simulation %s diff:\t%+f\t%+f\t" SurvivePose_format, so->codename, norm3d(p.Pos),
+				   norm3d(p.Rot + 1), SURVIVE_POSE_EXPAND(p));
 
-		SV_VERBOSE(200, "Simulation position " SurvivePose_format "\t", SURVIVE_POSE_EXPAND(driver->position));
-		SV_VERBOSE(200, "Simulation velocity " SurviveVel_format "\t", SURVIVE_VELOCITY_EXPAND(driver->velocity));
-		SV_VERBOSE(200, "Simulation acceleration " Point3_format "\t", LINMATH_VEC3_EXPAND(driver->accel.Pos));
-		SV_VERBOSE(200, "Simulation bias         " Point3_format "\t", LINMATH_VEC3_EXPAND(driver->gyro_bias));
+		SV_VERBOSE(200, "Simulation position " SurvivePose_format "\t", SURVIVE_POSE_EXPAND(obj->position));
+		SV_VERBOSE(200, "Simulation velocity " SurviveVel_format "\t", SURVIVE_VELOCITY_EXPAND(obj->velocity));
+		SV_VERBOSE(200, "Simulation acceleration " Point3_format "\t", LINMATH_VEC3_EXPAND(obj->accel.Pos));
+		SV_VERBOSE(200, "Simulation bias         " Point3_format "\t", LINMATH_VEC3_EXPAND(obj->gyro_bias));
 
 		SV_VERBOSE(200, "Object     position " SurvivePose_format "\t", SURVIVE_POSE_EXPAND(so->OutPoseIMU));
 		SV_VERBOSE(200, "Object     velocity " SurviveVel_format "\t", SURVIVE_VELOCITY_EXPAND(so->velocity));
@@ -580,29 +715,46 @@ static void simulation_compare(SurviveObject *so, survive_long_timecode timecode
 	}
 }
 
+static double simulator_run_time(const SurviveContext *ctx, void *_driver) {
+	const SurviveDriverSimulator *driver = _driver;
+	return driver->current_timestamp;
+}
+
 static int simulator_close(struct SurviveContext *ctx, void *_driver) {
 	SurviveDriverSimulator *driver = _driver;
 
-	FLT var[7];
-	variance_measure_calc(&driver->pose_variance, var);
-	SV_VERBOSE(5, "Simulation info");
-	SV_VERBOSE(5, "\tError         " Point7_format, LINMATH_VEC7_EXPAND(var));
-	SV_VERBOSE(5, "\tTracker bias  " Point3_format, LINMATH_VEC3_EXPAND(driver->gyro_bias));
+	FLT realtime = timestamp_in_s(driver);
+	SV_VERBOSE(5, "Simulated %6.2fs in %6.2fs real-time (%6.2fx)", driver->current_timestamp, realtime,
+			   driver->current_timestamp / (realtime + 1e-10));
+	if (driver->free_running) {
+		survive_install_run_time_fn(ctx, 0, 0);
+	}
+
+	SV_VERBOSE(5, "Simulation info (seed %d)", driver->settings.seed);
+	for (int i = 0; i < driver->object_cnt; i++) {
+		SurviveSimulatedObject *obj = &driver->objects[i];
+		FLT var[7];
+		variance_measure_calc(&obj->pose_variance, var);
+		SV_VERBOSE(5, "\t%s (%s)", obj->so->codename, simulator_motion_names[obj->motion]);
+		SV_VERBOSE(5, "\t\tError         " Point7_format, LINMATH_VEC7_EXPAND(var));
+		SV_VERBOSE(5, "\t\tTracker bias  " Point3_format, LINMATH_VEC3_EXPAND(obj->gyro_bias));
+	}
 
 	SurviveDriverSimulator_detach_config(ctx, driver);
+	free(driver->objects);
 	free(driver);
 	return 0;
 }
 
-cstring generate_simulated_object(FLT r, size_t sensor_ct) {
+cstring generate_simulated_object(SurviveSimulatorRNG *rng, FLT r, size_t sensor_ct) {
 	cstring cfg = {0};
 	cstring loc = {0}, nor_buf = {0};
 
 	char buffer[1024] = {0};
 
 	for (int i = 0; i < sensor_ct; i++) {
-		FLT azi = rand();
-		FLT pol = rand();
+		FLT azi = sim_rand(rng, 0, 2 * LINMATHPI);
+		FLT pol = sim_rand(rng, 0, 2 * LINMATHPI);
 		LinmathVec3d normals, locations;
 		normals[0] = locations[0] = r * cos(azi) * sin(pol);
 		normals[1] = locations[1] = r * sin(azi) * sin(pol);
@@ -658,16 +810,19 @@ cstring generate_simulated_object(FLT r, size_t sensor_ct) {
 
 SURVIVE_EXPORT SurviveObject *survive_create_simulation_device(SurviveContext *ctx, SurviveDriverSimulator *driver,
 															   const char *device_name) {
+	SurviveSimulatorRNG default_rng = sim_rng_stream(42, 0);
+	SurviveSimulatorRNG *rng = driver ? &driver->rng : &default_rng;
+
 	SurviveObject *device = survive_create_device(ctx, "SIM", driver, device_name, 0);
-	device->sensor_ct = driver->settings.obj_sensors;
+	device->sensor_ct = driver ? driver->settings.obj_sensors : 20;
 
 	device->head2imu.Rot[0] = 1;
 	device->head2trackref.Rot[0] = 1;
 	device->imu2trackref.Rot[0] = 1;
 
-	FLT r = driver->settings.obj_radius;
+	FLT r = driver ? driver->settings.obj_radius : .05;
 
-	cstring cfg = generate_simulated_object(r, device->sensor_ct);
+	cstring cfg = generate_simulated_object(rng, r, device->sensor_ct);
 
 	SURVIVE_INVOKE_HOOK_SO(config, device, cfg.d, strlen(cfg.d));
 	device->object_type = SURVIVE_OBJECT_TYPE_CONTROLLER;
@@ -678,29 +833,91 @@ SURVIVE_EXPORT SurviveObject *survive_create_simulation_device(SurviveContext *c
 	return device;
 }
 
+static enum SurviveSimulatorMotion parse_motion(SurviveContext *ctx, const char *name, size_t len) {
+	for (int i = 0; simulator_motion_names[i]; i++) {
+		if (strlen(simulator_motion_names[i]) == len && strncmp(simulator_motion_names[i], name, len) == 0)
+			return (enum SurviveSimulatorMotion)i;
+	}
+	SV_WARN("Unknown simulator motion profile '%.*s'; using attractors", (int)len, name);
+	return SURVIVE_SIMULATOR_MOTION_ATTRACTORS;
+}
+
+static void setup_simulated_objects(SurviveContext *ctx, SurviveDriverSimulator *sp) {
+	enum SurviveSimulatorMotion motions[SIMULATOR_MAX_OBJECTS];
+	int motion_cnt = 0;
+
+	const char *motion_cfg = survive_configs(ctx, SIMULATOR_MOTION_TAG, SC_GET, "attractors");
+	for (const char *p = motion_cfg; p && *p && motion_cnt < SIMULATOR_MAX_OBJECTS;) {
+		size_t len = strcspn(p, ",");
+		if (len > 0)
+			motions[motion_cnt++] = parse_motion(ctx, p, len);
+		p += len;
+		if (*p == ',')
+			p++;
+	}
+	if (motion_cnt == 0)
+		motions[motion_cnt++] = SURVIVE_SIMULATOR_MOTION_ATTRACTORS;
+
+	sp->object_cnt = sp->settings.objects;
+	if (sp->object_cnt < 1)
+		sp->object_cnt = 1;
+	if (sp->object_cnt > SIMULATOR_MAX_OBJECTS) {
+		SV_WARN("Simulator only supports %d objects", SIMULATOR_MAX_OBJECTS);
+		sp->object_cnt = SIMULATOR_MAX_OBJECTS;
+	}
+	sp->objects = SV_CALLOC(sp->object_cnt * sizeof(SurviveSimulatedObject));
+
+	for (int i = 0; i < sp->object_cnt; i++) {
+		SurviveSimulatedObject *obj = &sp->objects[i];
+		obj->driver = sp;
+		obj->idx = i;
+		obj->motion = motions[i % motion_cnt];
+		obj->rng = sim_rng_stream((uint64_t)sp->settings.seed, i + 1);
+		obj->pose_variance.size = 7;
+
+		char codename[8];
+		snprintf(codename, sizeof(codename), i < 10 ? "SM%d" : "S%02d", i);
+		if (i == 0) {
+			snprintf(obj->gt_name, sizeof(obj->gt_name), "Sim_GT");
+		} else {
+			snprintf(obj->gt_name, sizeof(obj->gt_name), "Sim_GT%d", i);
+		}
+
+		obj->so = survive_create_simulation_device(ctx, sp, codename);
+		obj->so->driver = obj;
+
+		for (int j = 0; j < 3; j++)
+			obj->gyro_bias[j] = sim_normrand(&obj->rng, 0, sp->gyro_bias_scale * sp->noise_scale);
+
+		apply_initial_position(obj);
+		SV_VERBOSE(10, "Simulated object %s uses motion profile %s", codename, simulator_motion_names[obj->motion]);
+	}
+}
+
 int DriverRegSimulator(SurviveContext *ctx) {
 	SurviveDriverSimulator *sp = SV_CALLOC(sizeof(SurviveDriverSimulator));
 	sp->ctx = ctx;
 	ctx->poll_min_time_ms = 0;
 
-	apply_initial_position(sp);
-
 	SV_INFO("Setting up Simulator driver.");
 
 	SurviveDriverSimulator_attach_config(ctx, sp);
-	sp->settings.time_factor = linmath_max(survive_configf(ctx, "time-factor", SC_GET, 1.), .00001);
+	sp->settings.time_factor = survive_configf(ctx, SIMULATOR_TIME_FACTOR_TAG, SC_GET, 1.);
+	sp->free_running = sp->settings.time_factor <= 0;
+	if (sp->free_running) {
+		SV_INFO("Simulator is free running; time is driven by the simulation clock");
+		survive_install_run_time_fn(ctx, simulator_run_time, sp);
+	}
 
-	sp->pose_variance.size = 7;
+	// Everything random in the scene comes from the seed; the objects draw from their own streams
+	srand(sp->settings.seed);
+	sp->rng = sim_rng_stream((uint64_t)sp->settings.seed, 0);
 
-	for (int i = 0; i < 3; i++)
-		sp->gyro_bias[i] = linmath_normrand(0, sp->gyro_bias_scale * sp->noise_scale);
 	sp->scale_error = .97; // linmath_normrand(1, .05);
 	int use_lh2 = sp->lh_version == 2;
 	int max_lighthouses = use_lh2 ? 16 : 2;
-	// Create a new SurviveObject...
-	SurviveObject *device = survive_create_simulation_device(ctx, sp, "SM0");
 
-	srand(42);
+	setup_simulated_objects(ctx, sp);
 
 	FLT freq_per_channel[NUM_GEN2_LIGHTHOUSES] = {
 		50.0521, 50.1567, 50.3673, 50.5796, 50.6864, 50.9014, 51.0096, 51.1182,
@@ -718,7 +935,7 @@ int DriverRegSimulator(SurviveContext *ctx) {
 
 		ctx->bsd_map[ctx->bsd[i].mode] = i;
 
-		sp->lhstates[i].start_time = (rand() / (FLT)RAND_MAX);
+		sp->lhstates[i].start_time = sim_rand(&sp->rng, 0, 1);
 
 		assert(ctx->bsd[i].mode < NUM_GEN2_LIGHTHOUSES);
 
@@ -743,14 +960,14 @@ int DriverRegSimulator(SurviveContext *ctx) {
 
 			for (int axis = 0; axis < 2; axis++) {
 				for (int cal_idx = 0; cal_idx < sizeof(fcalNoise) / sizeof(FLT); cal_idx++) {
-					((FLT *)(&ctx->bsd[i].fcal[axis]))[cal_idx] =
-						linmath_rand(-((FLT *)&fcalNoise)[cal_idx], ((FLT *)&fcalNoise)[cal_idx]);
+					FLT noise = ((FLT *)&fcalNoise)[cal_idx];
+					((FLT *)(&ctx->bsd[i].fcal[axis]))[cal_idx] = sim_rand(&sp->rng, -noise, noise);
 				}
 			}
 			ctx->activeLighthouses++;
 
 			ctx->bsd_map[ctx->bsd[i].mode] = i;
-			sp->lhstates[i].start_time = (rand() / (FLT)RAND_MAX);
+			sp->lhstates[i].start_time = sim_rand(&sp->rng, 0, 1);
 			sp->lhstates[i].period_s = 1. / freq_per_channel[ctx->bsd[i].mode];
 
 			sp->bsd[i] = ctx->bsd[i];
@@ -761,8 +978,8 @@ int DriverRegSimulator(SurviveContext *ctx) {
 	for (int i = 0; i < ctx->activeLighthouses; i++) {
 		for (int axis = 0; axis < 2; axis++) {
 			for (int cal_idx = 0; cal_idx < sizeof(fcalNoise) / sizeof(FLT); cal_idx++) {
-				((FLT *)(&ctx->bsd[i].fcal[axis]))[cal_idx] +=
-					fcal_noise * linmath_rand(-((FLT *)&fcalNoise)[cal_idx], ((FLT *)&fcalNoise)[cal_idx]);
+				FLT noise = ((FLT *)&fcalNoise)[cal_idx];
+				((FLT *)(&ctx->bsd[i].fcal[axis]))[cal_idx] += fcal_noise * sim_rand(&sp->rng, -noise, noise);
 			}
 		}
 	}
@@ -770,16 +987,19 @@ int DriverRegSimulator(SurviveContext *ctx) {
 	// ctx->bsd[0].Pose = sp->bsd[0].Pose;
 	// ctx->bsd[0].PositionSet = 1;
 
-	sp->so = device;
-	survive_add_object(ctx, device);
 	sp->lh_version = use_lh2 ? 1 : 0;
 	ctx->lh_version = sp->lh_version;
 	ctx->lh_version_configed = ctx->lh_version;
 
-	if (use_lh2) {
-		survive_notify_gen2(device, "Simulator setup for lh2");
-	} else {
-		survive_notify_gen1(device, "Simulator setup for lh1");
+	for (int i = 0; i < sp->object_cnt; i++) {
+		SurviveObject *device = sp->objects[i].so;
+		survive_add_object(ctx, device);
+
+		if (use_lh2) {
+			survive_notify_gen2(device, "Simulator setup for lh2");
+		} else {
+			survive_notify_gen1(device, "Simulator setup for lh1");
+		}
 	}
 
 	sp->pose_fn = survive_install_imupose_fn(ctx, simulation_compare);
@@ -1,12 +1,19 @@
 // All MIT/x11 Licensed Code in this file may be relicensed freely under the GPL
 // or LGPL licenses.
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #ifdef _WIN32
 #include "winsock2.h"
 #else
 #include <arpa/inet.h>
+#include <errno.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
 #endif
 
 #ifndef MSG_NOSIGNAL
@@ -18,61 +25,286 @@
 #include "survive_default_devices.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <survive.h>
+#include <survive_udp.h>
 #include <sys/types.h>
 #include <time.h>
 
-#define EXAMPLE_PORT 2333
-#define EXAMPLE_GROUP "224.0.2.122"
+// How many datagrams are pulled out of the socket per wakeup. Everything in one batch is injected under a single
+// acquisition of the context lock.
+#define UDP_BATCH_SIZE 32
+#define UDP_MAX_OBJECTS 16
+// Sequence jumps further than this, either way, are taken as the sender restarting rather than loss or reordering
+#define UDP_MAX_SEQUENCE_GAP 1024
+
+typedef struct SurviveDriverUDPObject {
+	char codename[4];
+	SurviveObject *so;
+	uint32_t next_sequence;
+	uint32_t dropped_datagrams, reordered_datagrams, restarts;
+} SurviveDriverUDPObject;
 
 struct SurviveDriverUDP {
 	SurviveContext *ctx;
-	SurviveObject *so;
+	SurviveObject *so; // Target of legacy pose / config datagrams
 	struct sockaddr_in addr;
 	int sock;
 	socklen_t addrlen;
 	struct ip_mreq mreq;
+	bool *keepRunning;
+
+	SurviveDriverUDPObject objects[UDP_MAX_OBJECTS];
+	size_t objects_cnt;
+
+	size_t datagrams, events, bad_datagrams;
+
+	// Receive buffers are set up once and reused for every batch
+	uint8_t buffers[UDP_BATCH_SIZE][SURVIVE_UDP_MAX_DATAGRAM];
+	size_t lengths[UDP_BATCH_SIZE];
+	struct iovec iovecs[UDP_BATCH_SIZE];
+#ifdef __linux__
+	struct mmsghdr msgs[UDP_BATCH_SIZE];
+#endif
 };
 typedef struct SurviveDriverUDP SurviveDriverUDP;
 
+static SurviveDriverUDPObject *find_object(SurviveDriverUDP *driver, const char *codename) {
+	for (size_t i = 0; i < driver->objects_cnt; i++) {
+		if (strncmp(driver->objects[i].codename, codename, sizeof(driver->objects[i].codename)) == 0)
+			return &driver->objects[i];
+	}
+	return 0;
+}
+
+static void process_config(SurviveDriverUDP *driver, const survive_udp_header *hdr, const uint8_t *payload,
+						   size_t len) {
+	SurviveContext *ctx = driver->ctx;
+	char codename[4] = {0};
+	memcpy(codename, hdr->codename, sizeof(codename) - 1);
+
+	// Front-ends repeat their config periodically so that a late starting receiver can still pick them up. It also
+	// starts every session, so the sequence count starts over from it.
+	SurviveDriverUDPObject *known = find_object(driver, codename);
+	if (known) {
+		known->next_sequence = hdr->sequence + 1;
+		return;
+	}
+
+	if (driver->objects_cnt >= UDP_MAX_OBJECTS) {
+		SV_WARN("UDP driver can't track more than %d objects; ignoring %s", UDP_MAX_OBJECTS, codename);
+		return;
+	}
+
+	SurviveObject *so = survive_create_device(ctx, "UDP", driver, codename, 0);
+	if (so == 0) {
+		return;
+	}
+	survive_add_object(ctx, so);
+
+	SurviveDriverUDPObject *obj = &driver->objects[driver->objects_cnt++];
+	memcpy(obj->codename, codename, sizeof(obj->codename));
+	obj->so = so;
+	obj->next_sequence = hdr->sequence + 1;
+
+	char *config = SV_CALLOC(len + 1);
+	memcpy(config, payload, len);
+	if (ctx->configproc(so, config, len) == 0) {
+		SV_INFO("Found %s via UDP", survive_colorize(so->codename));
+	} else {
+		SV_WARN("Found %s via UDP, but could not read config description", survive_colorize(so->codename));
+	}
+}
+
+static void process_events(SurviveDriverUDP *driver, const survive_udp_header *hdr, const uint8_t *data, size_t len) {
+	SurviveContext *ctx = driver->ctx;
+	SurviveDriverUDPObject *obj = find_object(driver, hdr->codename);
+	if (obj == 0) {
+		// No config seen for this object yet; nothing useful can be done with the data.
+		driver->bad_datagrams++;
+		return;
+	}
+
+	int32_t gap = (int32_t)(hdr->sequence - obj->next_sequence);
+	if (gap >= 0 && gap <= UDP_MAX_SEQUENCE_GAP) {
+		obj->dropped_datagrams += gap;
+		obj->next_sequence = hdr->sequence + 1;
+	} else if (gap < 0 && gap >= -UDP_MAX_SEQUENCE_GAP) {
+		// Arrived after a later datagram; it was counted as dropped then
+		obj->reordered_datagrams++;
+		if (obj->dropped_datagrams)
+			obj->dropped_datagrams--;
+	} else {
+		obj->restarts++;
+		obj->next_sequence = hdr->sequence + 1;
+	}
+
+	SurviveObject *so = obj->so;
+	const uint8_t *end = data + len;
+	for (uint16_t i = 0; i < hdr->event_cnt; i++) {
+		survive_udp_event evt;
+		if (data + sizeof(evt) > end) {
+			break;
+		}
+		memcpy(&evt, data, sizeof(evt));
+		data += sizeof(evt);
+
+		uint32_t payload_size = survive_udp_event_payload_size(evt.type);
+		if (data + payload_size > end) {
+			break;
+		}
+
+		switch (evt.type) {
+		case SURVIVE_UDP_EVENT_SYNC:
+			SURVIVE_INVOKE_HOOK_SO(sync, so, evt.channel, evt.timecode, (evt.flags & SURVIVE_UDP_FLAG_OOTX) != 0,
+								   (evt.flags & SURVIVE_UDP_FLAG_GEN) != 0);
+			break;
+		case SURVIVE_UDP_EVENT_SWEEP:
+			SURVIVE_INVOKE_HOOK_SO(sweep, so, evt.channel, survive_map_sensor_id(so, evt.sensor_id), evt.timecode,
+								   (evt.flags & SURVIVE_UDP_FLAG_HALF_CLOCK) != 0);
+			break;
+		case SURVIVE_UDP_EVENT_LIGHTCAP: {
+			uint16_t length;
+			memcpy(&length, data, sizeof(length));
+			LightcapElement le = {.sensor_id = evt.sensor_id, .length = length, .timestamp = evt.timecode};
+			handle_lightcap(so, &le);
+			break;
+		}
+		case SURVIVE_UDP_EVENT_RAW_IMU:
+		case SURVIVE_UDP_EVENT_IMU: {
+			float raw[6];
+			memcpy(raw, data, sizeof(raw));
+			FLT accelgyro[6];
+			for (int j = 0; j < 6; j++)
+				accelgyro[j] = raw[j];
+
+			if (evt.type == SURVIVE_UDP_EVENT_RAW_IMU) {
+				SURVIVE_INVOKE_HOOK_SO(raw_imu, so, evt.channel, accelgyro, evt.timecode, evt.sensor_id);
+			} else {
+				SURVIVE_INVOKE_HOOK_SO(imu, so, evt.channel, accelgyro, evt.timecode, evt.sensor_id);
+			}
+			break;
+		}
+		default:
+			// Unknown event types from a newer minor revision are skipped; the payload size table tells us how far.
+			break;
+		}
+
+		data += payload_size;
+		driver->events++;
+	}
+}
+
+static void process_legacy(SurviveDriverUDP *driver, const uint8_t *buffer, size_t cnt) {
+	uint32_t type;
+	memcpy(&type, buffer, sizeof(type));
+
+	switch (type) {
+	case 1: {
+		// The object keeps the config around, so it can't point into the receive buffers
+		char *config = SV_CALLOC(cnt - 4 + 1);
+		memcpy(config, buffer + 4, cnt - 4);
+		SURVIVE_INVOKE_HOOK_SO(config, driver->so, config, cnt - 4);
+		break;
+	}
+	case 2: {
+		SurvivePose pose;
+		if (cnt < 4 + sizeof(pose))
+			break;
+		memcpy(&pose, buffer + 4, sizeof(pose));
+		SURVIVE_INVOKE_HOOK_SO(pose, driver->so, OGRelativeTime() * 48000000., &pose);
+		break;
+	}
+	default:
+		driver->bad_datagrams++;
+		break;
+	}
+}
+
+static void process_datagram(SurviveDriverUDP *driver, const uint8_t *buffer, size_t cnt) {
+	driver->datagrams++;
+
+	survive_udp_header hdr;
+	if (cnt < sizeof(hdr)) {
+		if (cnt >= sizeof(uint32_t))
+			process_legacy(driver, buffer, cnt);
+		return;
+	}
+
+	memcpy(&hdr, buffer, sizeof(hdr));
+	if (hdr.magic != SURVIVE_UDP_MAGIC) {
+		process_legacy(driver, buffer, cnt);
+		return;
+	}
+
+	if (hdr.version != SURVIVE_UDP_VERSION) {
+		driver->bad_datagrams++;
+		return;
+	}
+
+	hdr.codename[sizeof(hdr.codename) - 1] = 0;
+	switch (hdr.type) {
+	case SURVIVE_UDP_PACKET_CONFIG:
+		process_config(driver, &hdr, buffer + sizeof(hdr), cnt - sizeof(hdr));
+		break;
+	case SURVIVE_UDP_PACKET_EVENTS:
+		process_events(driver, &hdr, buffer + sizeof(hdr), cnt - sizeof(hdr));
+		break;
+	default:
+		driver->bad_datagrams++;
+		break;
+	}
+}
+
+/**
+ * Blocks until at least one datagram is available (or the socket timeout elapses) and then pulls in as many more as
+ * are already queued, up to UDP_BATCH_SIZE. Returns the number of datagrams received; < 0 on error.
+ */
+static int receive_batch(SurviveDriverUDP *driver) {
+#ifdef __linux__
+	for (int i = 0; i < UDP_BATCH_SIZE; i++) {
+		driver->msgs[i].msg_hdr.msg_namelen = 0;
+	}
+	int cnt = recvmmsg(driver->sock, driver->msgs, UDP_BATCH_SIZE, MSG_WAITFORONE, 0);
+	for (int i = 0; i < cnt; i++) {
+		driver->lengths[i] = driver->msgs[i].msg_len;
+	}
+	return cnt;
+#else
+	int cnt = recvfrom(driver->sock, (char *)driver->buffers[0], sizeof(driver->buffers[0]), MSG_NOSIGNAL,
+					   (struct sockaddr *)&driver->addr, &driver->addrlen);
+	if (cnt < 0)
+		return cnt;
+	driver->lengths[0] = cnt;
+	return 1;
+#endif
+}
+
 static void *UDP_poll(void *_driver) {
 	SurviveDriverUDP *driver = _driver;
-	struct SurviveContext *ctx = driver->so->ctx;
+	struct SurviveContext *ctx = driver->ctx;
 
 #ifdef __APPLE__
 	int opt = 1;
 	setsockopt(driver->sock, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt));
 #endif
 
-	int cnt;
-	for (;;) {
-		uint32_t buffer[1000] = {0};
-		cnt = recvfrom(driver->sock, (char *)buffer, sizeof(buffer), MSG_NOSIGNAL, (struct sockaddr *)&driver->addr,
-					   &driver->addrlen);
+	while (driver->keepRunning == 0 || *driver->keepRunning) {
+		int cnt = receive_batch(driver);
 		if (cnt < 0) {
-			// perror("recvfrom");
-			//  exit(1);
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				continue;
 			break;
 		} else if (cnt == 0) {
-			break;
+			continue;
 		}
 
 		survive_get_ctx_lock(ctx);
-		switch (buffer[0]) {
-		case 1: {
-			SURVIVE_INVOKE_HOOK_SO(config, driver->so, (char *)&buffer[1], cnt - 4);
-			break;
-		}
-		case 2: {
-			SURVIVE_INVOKE_HOOK_SO(pose, driver->so, OGRelativeTime() * 48000000., (const SurvivePose *)&buffer[1]);
-			break;
-		}
+		for (int i = 0; i < cnt; i++) {
+			process_datagram(driver, driver->buffers[i], driver->lengths[i]);
 		}
 		survive_release_ctx_lock(ctx);
-		// printf("On %s: Header - %s | Device_Number - %d | Sensor_no - %d | Event_length - %5d | Ccount - %u \n",
-		// inet_ntoa(driver->addr.sin_addr), (char *) &sendbuf.header, sendbuf.dev_no, sendbuf.sensor_no,
-		// sendbuf.length_event, sendbuf.ccount_struc);
 	}
 
 	return 0;
@@ -81,11 +313,16 @@ static void *UDP_poll(void *_driver) {
 static int UDP_close(struct SurviveContext *ctx, void *_driver) {
 	SurviveDriverUDP *driver = _driver;
 
-	/*
-		If you need to handle any cleanup here, like closing handles, etc.
-		you can perform it here.
-	*/
+	SV_VERBOSE(5, "UDP driver received %u datagrams, %u events, %u bad datagrams", (unsigned)driver->datagrams,
+			   (unsigned)driver->events, (unsigned)driver->bad_datagrams);
+	for (size_t i = 0; i < driver->objects_cnt; i++) {
+		SV_VERBOSE(5, "\t%s dropped %u datagrams, %u reordered, %u sender restarts", driver->objects[i].codename,
+				   (unsigned)driver->objects[i].dropped_datagrams, (unsigned)driver->objects[i].reordered_datagrams,
+				   (unsigned)driver->objects[i].restarts);
+	}
 
+	close(driver->sock);
+	free(driver);
 	return 0;
 }
 
@@ -108,21 +345,34 @@ int DriverRegUDP(SurviveContext *ctx) {
 	memset((char *)&sp->addr, 0, sizeof(sp->addr));
 	sp->addr.sin_family = AF_INET;
 	sp->addr.sin_addr.s_addr = htonl(INADDR_ANY);
-	sp->addr.sin_port = htons(EXAMPLE_PORT);
+	sp->addr.sin_port = htons(SURVIVE_UDP_PORT);
 	sp->addrlen = sizeof(sp->addr);
 
 	if (bind(sp->sock, (struct sockaddr *)&sp->addr, sizeof(sp->addr)) < 0) {
 		perror("bind");
 		exit(1);
 	}
-	sp->mreq.imr_multiaddr.s_addr = inet_addr(EXAMPLE_GROUP);
+	sp->mreq.imr_multiaddr.s_addr = inet_addr(SURVIVE_UDP_GROUP);
 	sp->mreq.imr_interface.s_addr = htonl(INADDR_ANY);
 	if (setsockopt(sp->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &sp->mreq, sizeof(sp->mreq)) < 0) {
 		perror("setsockopt mreq");
 		exit(1);
 	}
 
-	survive_add_threaded_driver(ctx, sp, "UDP", UDP_poll, UDP_close);
+	// Wake up periodically so the poll thread notices when it is asked to shut down
+	struct timeval timeout = {.tv_sec = 0, .tv_usec = 100000};
+	setsockopt(sp->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	for (int i = 0; i < UDP_BATCH_SIZE; i++) {
+		sp->iovecs[i].iov_base = sp->buffers[i];
+		sp->iovecs[i].iov_len = sizeof(sp->buffers[i]);
+#ifdef __linux__
+		sp->msgs[i].msg_hdr.msg_iov = &sp->iovecs[i];
+		sp->msgs[i].msg_hdr.msg_iovlen = 1;
+#endif
+	}
+
+	sp->keepRunning = survive_add_threaded_driver(ctx, sp, "UDP", UDP_poll, UDP_close);
 	return 0;
 }
 
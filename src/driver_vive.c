@@ -445,6 +445,9 @@ struct SurviveViveData {
 
 	FLT lastPairTime;
 	bool requestPairing;
+
+	// USB fds are serviced by the survive_poll reactor rather than from survive_vive_usb_poll
+	bool usb_poll_fds;
 #ifndef HIDAPI
 	libusb_hotplug_callback_handle callback_handle;
 #endif
@@ -682,7 +685,16 @@ static int AttachInterface(SurviveViveData *sv, struct SurviveUSBInfo *usbObject
 	iface->uh = usbObject->handle->interfaces[endpoint - usbObject->device_info->endpoints];
 	assert(iface->uh);
 
-#ifndef HID_NONBLOCKING
+#if defined(SURVIVE_HIDRAW)
+	iface->hidraw_fd = usbObject->handle->hidraw_fds[endpoint - usbObject->device_info->endpoints];
+
+	// Empty the queue out. If you don't, you might get stale data
+	while (read(iface->hidraw_fd, iface->buffer, sizeof(iface->swap_buffer[0])) > 0) {
+	}
+
+	if (sv->usb_poll_fds)
+		survive_hidraw_register_poll_fd(iface);
+#elif !defined(HID_NONBLOCKING)
 	iface->servicethread = OGCreateThread(HAPIReceiver, iface);
 	OGUSleep(100000);
 #else
@@ -1004,7 +1016,10 @@ int survive_vive_usb_poll(SurviveContext *ctx, void *v) {
 	}
 
 #ifdef HIDAPI
-#ifdef HID_NONBLOCKING
+#if defined(SURVIVE_HIDRAW)
+	// Interfaces on the reactor are read by it; the rest only get a check without blocking then
+	survive_hidraw_poll(sv, sv->usb_poll_fds ? 0 : 10);
+#elif defined(HID_NONBLOCKING)
 	survive_release_ctx_lock(ctx);
 	for (int i = 0; i < sv->udev_cnt; i++) {
 		for (int j = 0; j < sv->udev[i]->interface_cnt; j++) {
@@ -1019,6 +1034,9 @@ int survive_vive_usb_poll(SurviveContext *ctx, void *v) {
 	return 0;
 #endif
 #else
+	if (sv->usb_poll_fds)
+		return 0;
+
 	// int r = libusb_handle_events(sv->usbctx);
 	struct timeval tv = {.tv_usec = 10 * 1000};
 	survive_release_ctx_lock(ctx);
@@ -3218,6 +3236,10 @@ void survive_data_cb_locked(uint64_t time_received_us, SurviveUSBInterface *si)
 
 int survive_vive_close(SurviveContext *ctx, void *driver) {
 	SurviveViveData *sv = driver;
+	if (sv->usb_poll_fds) {
+		survive_usb_unregister_poll_fds(sv);
+		sv->usb_poll_fds = false;
+	}
 #ifndef HIDAPI
 	libusb_hotplug_deregister_callback(sv->usbctx, sv->callback_handle);
 #endif
@@ -3276,6 +3298,8 @@ int DriverRegHTCVive(SurviveContext *ctx) {
 
 	if (sv->udev_cnt || hasHotplug) {
 		survive_add_driver(ctx, sv, survive_vive_usb_poll, survive_vive_close);
+		sv->usb_poll_fds = survive_usb_register_poll_fds(sv);
+		SV_VERBOSE(10, "USB events are %s", sv->usb_poll_fds ? "event driven" : "polled");
 	} else {
 		SV_INFO("No USB devices detected");
 		goto fail_gracefully;
@@ -3294,8 +3318,10 @@ int DriverRegHTCVive(SurviveContext *ctx) {
 	sv->uiface[USB_DEV_TRACKER1_LIGHTCAP].actual_len = 64;
 */
 #endif
-	// Note: don't sleep for HTCVive, the handle_events call can block
-	ctx->poll_min_time_ms = 0;
+	// Note: don't sleep for HTCVive, the handle_events call can block. When the USB fds are on the reactor they wake
+	// survive_poll themselves, and the poll function only does housekeeping.
+	if (!sv->usb_poll_fds)
+		ctx->poll_min_time_ms = 0;
 
 	return 0;
 fail_gracefully:
@@ -65,6 +65,10 @@ typedef void (*usb_callback)(uint64_t time_recv_us, struct SurviveUSBInterface *
 #ifdef HIDAPI
 struct HIDAPI_USB_Handle_t {
 	hid_device *interfaces[8];
+#ifdef SURVIVE_HIDRAW
+	// Interrupt reports are read straight from the hidraw nodes; hidapi is only used for feature reports
+	int hidraw_fds[8];
+#endif
 };
 typedef struct HIDAPI_USB_Handle_t libsurvive_usb_handle;
 #define USB_INTERFACE_HANDLE hid_device *
@@ -83,7 +87,11 @@ typedef struct SurviveUSBInterface {
 
 #ifdef HIDAPI
 	USB_INTERFACE_HANDLE uh;
-#ifndef HID_NONBLOCKING
+#if defined(SURVIVE_HIDRAW)
+	int hidraw_fd;
+	// Whether hidraw_fd is on the context's poll reactor
+	bool hidraw_polled;
+#elif !defined(HID_NONBLOCKING)
 	og_thread_t servicethread;
 #endif
 #else
@@ -3,6 +3,13 @@
 #include <errno.h>
 #include <hidapi.h>
 #include <survive.h>
+
+#ifdef SURVIVE_HIDRAW
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 #define LIBUSB_TRANSFER_COMPLETED 0
 #define LIBUSB_TRANSFER_STALL -1
 #define LIBUSB_TRANSFER_TIMED_OUT -2
@@ -81,6 +88,91 @@ static inline int update_feature_report(USBHANDLE dev, uint16_t iface, uint8_t *
 	return hid_send_feature_report(dev->interfaces[iface], data, datalen);
 }
 
+#ifdef SURVIVE_HIDRAW
+#define SURVIVE_HIDRAW_MAX_REPORTS 32
+
+void survive_data_cb_locked(uint64_t time_received_us, SurviveUSBInterface *si);
+
+// Drains up to SURVIVE_HIDRAW_MAX_REPORTS reports; false when the interface failed and its device is to be closed
+static bool survive_hidraw_read_reports(SurviveUSBInterface *iface) {
+	SurviveContext *ctx = iface->ctx;
+	for (int n = 0; n < SURVIVE_HIDRAW_MAX_REPORTS; n++) {
+		ssize_t len = read(iface->hidraw_fd, iface->buffer, sizeof(iface->swap_buffer[0]));
+		if (len < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				SV_WARN("Reading %s failed: %s", iface->hname, strerror(errno));
+				iface->usbInfo->request_close = true;
+				return false;
+			}
+			break;
+		}
+
+		iface->actual_len = (int)len;
+		iface->packet_count++;
+		survive_data_cb_locked(OGGetAbsoluteTimeUS(), iface);
+	}
+	return true;
+}
+
+static int survive_hidraw_fd_ready(SurviveContext *ctx, void *user, int fd) {
+	SurviveUSBInterface *iface = user;
+	if (!survive_hidraw_read_reports(iface)) {
+		// A failed fd stays readable; take it off the reactor until the device is closed
+		survive_remove_poll_fd(ctx, fd);
+		iface->hidraw_polled = false;
+	}
+	return 0;
+}
+
+// Puts the interface on the poll reactor; survive_hidraw_poll handles the ones that aren't
+static void survive_hidraw_register_poll_fd(SurviveUSBInterface *iface) {
+	iface->hidraw_polled =
+		survive_add_poll_fd(iface->ctx, iface->hidraw_fd, POLLIN, survive_hidraw_fd_ready, iface) == 0;
+}
+
+/*
+ * Waits on every attached interface that isn't on the poll reactor with a single poll() and drains up to
+ * SURVIVE_HIDRAW_MAX_REPORTS reports from each ready one, all under one acquisition of the context lock. Must be called
+ * with the context lock held; it is released while waiting.
+ */
+static void survive_hidraw_poll(SurviveViveData *sv, int timeout_ms) {
+	SurviveContext *ctx = sv->ctx;
+	struct pollfd fds[MAX_USB_DEVS * MAX_INTERFACES_PER_DEVICE];
+	SurviveUSBInterface *ifaces[MAX_USB_DEVS * MAX_INTERFACES_PER_DEVICE];
+	nfds_t cnt = 0;
+
+	for (int i = 0; i < sv->udev_cnt; i++) {
+		for (int j = 0; j < sv->udev[i]->interface_cnt; j++) {
+			SurviveUSBInterface *iface = &sv->udev[i]->interfaces[j];
+			if (iface->assoc_obj && iface->hidraw_fd >= 0 && !iface->hidraw_polled) {
+				fds[cnt] = (struct pollfd){.fd = iface->hidraw_fd, .events = POLLIN};
+				ifaces[cnt++] = iface;
+			}
+		}
+	}
+
+	survive_release_ctx_lock(ctx);
+	int ready = cnt ? poll(fds, cnt, timeout_ms) : 0;
+	if (cnt == 0 && timeout_ms > 0)
+		OGUSleep(timeout_ms * 1000);
+	survive_get_ctx_lock(ctx);
+
+	for (nfds_t i = 0; i < cnt && ready > 0; i++) {
+		SurviveUSBInterface *iface = ifaces[i];
+		if (fds[i].revents == 0)
+			continue;
+		ready--;
+
+		if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+			iface->usbInfo->request_close = true;
+			continue;
+		}
+
+		survive_hidraw_read_reports(iface);
+	}
+}
+#endif
+
 static void *HAPIReceiver(void *v) {
 	SurviveUSBInterface *iface = v;
 	USB_INTERFACE_HANDLE *hp = &iface->uh;
@@ -119,6 +211,10 @@ static const char *survive_usb_error_name(int ret) { return ""; }
 
 static int survive_open_usb_device(SurviveViveData *sv, survive_usb_device_t d, struct SurviveUSBInfo *usbInfo) {
 	usbInfo->handle = SV_CALLOC(sizeof(struct HIDAPI_USB_Handle_t));
+#ifdef SURVIVE_HIDRAW
+	for (int i = 0; i < 8; i++)
+		usbInfo->handle->hidraw_fds[i] = -1;
+#endif
 	survive_usb_device_t c = d;
 
 	struct SurviveContext *ctx = sv->ctx;
@@ -148,6 +244,16 @@ static int survive_open_usb_device(SurviveViveData *sv, survive_usb_device_t d,
 				SV_INFO("Warning: Could not find vive device %04x:%04x", d->vendor_id, d->product_id);
 				return -1;
 			}
+
+#ifdef SURVIVE_HIDRAW
+			// With the hidraw backend of hidapi the path is the device node itself
+			usbInfo->handle->hidraw_fds[interface_num] = open(c->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+			if (usbInfo->handle->hidraw_fds[interface_num] < 0) {
+				SV_INFO("Warning: Could not open %s for vive device %04x:%04x: %s", c->path, d->vendor_id,
+						d->product_id, strerror(errno));
+				return -1;
+			}
+#endif
 		}
 	}
 
@@ -178,6 +284,12 @@ static bool setup_hotplug(SurviveViveData *sv) { return true; }
 static inline void survive_close_usb_device(struct SurviveUSBInfo *usbInfo) {
 	for (int j = 0; j < 8; j++) {
 		hid_close(usbInfo->handle->interfaces[j]);
+#ifdef SURVIVE_HIDRAW
+		if (usbInfo->handle->hidraw_fds[j] >= 0) {
+			survive_remove_poll_fd(usbInfo->viveData->ctx, usbInfo->handle->hidraw_fds[j]);
+			close(usbInfo->handle->hidraw_fds[j]);
+		}
+#endif
 	}
 
 	free(usbInfo->handle);
@@ -189,3 +301,40 @@ static inline void survive_close_usb_device(struct SurviveUSBInfo *usbInfo) {
 }
 
 void survive_usb_close(SurviveViveData *sv) {}
+#ifdef SURVIVE_HIDRAW
+static void survive_usb_unregister_poll_fds(SurviveViveData *sv) {
+	for (int i = 0; i < sv->udev_cnt; i++) {
+		for (int j = 0; j < sv->udev[i]->interface_cnt; j++) {
+			SurviveUSBInterface *iface = &sv->udev[i]->interfaces[j];
+			if (iface->hidraw_polled) {
+				survive_remove_poll_fd(sv->ctx, iface->hidraw_fd);
+				iface->hidraw_polled = false;
+			}
+		}
+	}
+}
+
+/*
+ * Hands the hidraw fds of the attached interfaces to survive_poll so reports are read as soon as they arrive; the ones
+ * attached later are added by AttachInterface.
+ */
+static bool survive_usb_register_poll_fds(SurviveViveData *sv) {
+	for (int i = 0; i < sv->udev_cnt; i++) {
+		for (int j = 0; j < sv->udev[i]->interface_cnt; j++) {
+			SurviveUSBInterface *iface = &sv->udev[i]->interfaces[j];
+			if (!iface->assoc_obj || iface->hidraw_fd < 0 || iface->hidraw_polled)
+				continue;
+
+			survive_hidraw_register_poll_fd(iface);
+			if (!iface->hidraw_polled) {
+				survive_usb_unregister_poll_fds(sv);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+#else
+static bool survive_usb_register_poll_fds(SurviveViveData *sv) { return false; }
+static void survive_usb_unregister_poll_fds(SurviveViveData *sv) {}
+#endif
@@ -300,3 +300,72 @@ static inline void survive_close_usb_device(struct SurviveUSBInfo *usbInfo) {
 }
 
 void survive_usb_close(SurviveViveData *sv) { libusb_exit(sv->usbctx); }
+
+static int survive_usb_fd_ready(SurviveContext *ctx, void *user, int fd) {
+	SurviveViveData *sv = user;
+	struct timeval tv = {0};
+
+	survive_release_ctx_lock(ctx);
+	int r = libusb_handle_events_timeout(sv->usbctx, &tv);
+	survive_get_ctx_lock(ctx);
+
+	if (r) {
+		SV_WARN("Libusb poll failed. %d (%s)", r, libusb_error_name(r));
+	}
+	return 0;
+}
+
+static void LIBUSB_CALL survive_usb_pollfd_added(int fd, short events, void *user_data) {
+	SurviveViveData *sv = user_data;
+	survive_add_poll_fd(sv->ctx, fd, events, survive_usb_fd_ready, sv);
+}
+
+static void LIBUSB_CALL survive_usb_pollfd_removed(int fd, void *user_data) {
+	SurviveViveData *sv = user_data;
+	survive_remove_poll_fd(sv->ctx, fd);
+}
+
+static void survive_usb_free_pollfds(const struct libusb_pollfd **fds) {
+#if LIBUSB_API_VERSION >= 0x01000104
+	libusb_free_pollfds(fds);
+#else
+	free((void *)fds);
+#endif
+}
+
+static void survive_usb_unregister_poll_fds(SurviveViveData *sv) {
+	libusb_set_pollfd_notifiers(sv->usbctx, 0, 0, 0);
+
+	const struct libusb_pollfd **fds = libusb_get_pollfds(sv->usbctx);
+	for (int i = 0; fds && fds[i]; i++) {
+		survive_remove_poll_fd(sv->ctx, fds[i]->fd);
+	}
+	survive_usb_free_pollfds(fds);
+}
+
+/*
+ * Hands libusb's fds to survive_poll so transfers are handled as soon as they complete, instead of blocking in
+ * libusb_handle_events_timeout every poll. Only possible when libusb handles its timeouts through an fd as well.
+ */
+static bool survive_usb_register_poll_fds(SurviveViveData *sv) {
+	if (!libusb_pollfds_handle_timeouts(sv->usbctx))
+		return false;
+
+	const struct libusb_pollfd **fds = libusb_get_pollfds(sv->usbctx);
+	if (fds == 0)
+		return false;
+
+	bool registered = true;
+	for (int i = 0; fds[i] && registered; i++) {
+		registered = survive_add_poll_fd(sv->ctx, fds[i]->fd, fds[i]->events, survive_usb_fd_ready, sv) == 0;
+	}
+	survive_usb_free_pollfds(fds);
+
+	if (!registered) {
+		survive_usb_unregister_poll_fds(sv);
+		return false;
+	}
+
+	libusb_set_pollfd_notifiers(sv->usbctx, survive_usb_pollfd_added, survive_usb_pollfd_removed, sv);
+	return true;
+}
@@ -70,37 +70,89 @@ lfsr_poly_t lsfr_mirror_poly(lfsr_poly_t p) {
 	return rtn;
 }
 
+struct lfsr_lookup_slot {
+	uint32_t state; // 0 marks an empty slot; the all-zero state never occurs in the sequence
+	uint32_t position;
+};
+
 struct lfsr_lookup_t {
 	uint32_t order;
+	uint32_t period;
 	lfsr_poly_t p;
-	uint32_t *table;
+	uint32_t slot_bits;
+	struct lfsr_lookup_slot *slots;
 };
 
+static inline uint32_t lfsr_lookup_hash(const struct lfsr_lookup_t *lookup, uint32_t state) {
+	return (state * 0x9E3779B1u) >> (32 - lookup->slot_bits);
+}
+
 struct lfsr_lookup_t *lfsr_lookup_ctor(lfsr_poly_t p) {
 	uint32_t order = lfsr_order(p);
-	struct lfsr_lookup_t *lookup = SV_MALLOC(sizeof(struct lfsr_lookup_t));
-	lookup->table = (uint32_t *)SV_CALLOC_N(1 << order, sizeof(uint32_t));
+	struct lfsr_lookup_t *lookup = SV_CALLOC(sizeof(struct lfsr_lookup_t));
 	lookup->order = order;
+	lookup->p = p;
+
+	// Keep the table at most half full
+	uint32_t checkpoints = (1u << order) / LFSR_LOOKUP_STRIDE + 1;
+	lookup->slot_bits = 1;
+	while ((1u << lookup->slot_bits) < 2 * checkpoints)
+		lookup->slot_bits++;
+	uint32_t slot_mask = (1u << lookup->slot_bits) - 1;
+	lookup->slots = SV_CALLOC_N(slot_mask + 1, sizeof(struct lfsr_lookup_slot));
+
 	uint32_t start = 1;
 	uint32_t state = start;
 	uint32_t mask = (1 << (order)) - 1;
 	uint32_t cnt = 0;
 
 	do {
-		// if(cnt > order) {
-		assert(lookup->table[state & mask] == 0);
-		lookup->table[state & mask] = cnt;
-		//}
+		if (cnt % LFSR_LOOKUP_STRIDE == 0) {
+			uint32_t idx = lfsr_lookup_hash(lookup, state & mask);
+			while (lookup->slots[idx].state != 0) {
+				assert(lookup->slots[idx].state != (state & mask));
+				idx = (idx + 1) & slot_mask;
+			}
+			lookup->slots[idx].state = state & mask;
+			lookup->slots[idx].position = cnt;
+		}
 		cnt++;
-		state = lsfr_iterate(state, p, 1);
+		state = lsfr_iterate(state, p, 1) & mask;
 	} while ((start & mask) != (state & mask));
 
+	lookup->period = cnt;
 	return lookup;
 }
 
+void lfsr_lookup_free(struct lfsr_lookup_t *lookup) {
+	if (lookup)
+		free(lookup->slots);
+	free(lookup);
+}
+
+static inline bool lfsr_lookup_find(const struct lfsr_lookup_t *lookup, uint32_t state, uint32_t *position) {
+	uint32_t slot_mask = (1u << lookup->slot_bits) - 1;
+	for (uint32_t idx = lfsr_lookup_hash(lookup, state); lookup->slots[idx].state != 0; idx = (idx + 1) & slot_mask) {
+		if (lookup->slots[idx].state == state) {
+			*position = lookup->slots[idx].position;
+			return true;
+		}
+	}
+	return false;
+}
+
 uint32_t lfsr_lookup_query(struct lfsr_lookup_t *lookup, uint32_t q) {
 	uint32_t mask = (1 << (lookup->order)) - 1;
-	return lookup->table[q & mask];
+	uint32_t state = q & mask;
+	for (uint32_t steps = 0; steps < LFSR_LOOKUP_STRIDE; steps++) {
+		uint32_t position;
+		if (lfsr_lookup_find(lookup, state, &position))
+			return (position + lookup->period - steps) % lookup->period;
+		state = lsfr_iterate(state, lookup->p, 1) & mask;
+	}
+
+	// Not on the sequence
+	return 0;
 }
 
 uint32_t lfsr_find_with_mask(lfsr_poly_t p, lfsr_state_t start, lfsr_state_t state, uint32_t mask) {
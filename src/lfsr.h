@@ -1,14 +1,24 @@
+#pragma once
 #include "stdint.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 typedef uint32_t lfsr_poly_t;
 typedef uint32_t lfsr_state_t;
 
 static inline uint8_t popcnt(uint32_t x) {
+#if defined(__GNUC__)
+	return (uint8_t)__builtin_popcount(x);
+#elif defined(_MSC_VER)
+	return (uint8_t)__popcnt(x);
+#else
 	int c;
 	for (c = 0; x != 0; x >>= 1u)
 		if (x & 1u)
 			c++;
 	return c;
+#endif
 }
 
 static inline uint32_t reverse32(uint32_t v) {
@@ -31,6 +41,13 @@ lfsr_state_t lsfr_iterate_rev(lfsr_state_t state, lfsr_poly_t poly, uint32_t cnt
 
 uint8_t lfsr_order(lfsr_poly_t v);
 
+/**
+ * Finds where in the sequence started from state 1 a given state occurs. Only every LFSR_LOOKUP_STRIDE'th state is
+ * stored, so a query steps the LFSR forward until it reaches one -- at most LFSR_LOOKUP_STRIDE steps, in exchange for a
+ * table that is that much smaller than one entry per state.
+ */
+#define LFSR_LOOKUP_STRIDE 32
 struct lfsr_lookup_t;
 struct lfsr_lookup_t *lfsr_lookup_ctor(lfsr_poly_t p);
+void lfsr_lookup_free(struct lfsr_lookup_t *lookup);
 uint32_t lfsr_lookup_query(struct lfsr_lookup_t *lookup, uint32_t q);
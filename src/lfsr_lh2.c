@@ -17,6 +17,7 @@ uint32_t inline clz(uint32_t value) {
 #endif
 #include "stdio.h"
 #include "string.h"
+#include <assert.h>
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
 #include <malloc.h>
 #endif
@@ -63,8 +64,24 @@ lfsr_poly_t poly_pairs[32] = {
 };
 
 struct lfsr_lookup_t *poly_pair_lookups[32] = {0};
+
+/*
+ * Bit i of poly_taps[k] is bit k of poly_pairs[i]. With the bits of a sample spread out the same way -- one word per
+ * bit position, one bit per polynomial -- a single pass of and/xor runs the LFSR for all 32 polynomials at once.
+ */
+#define LH2_LFSR_ORDER 17
+static uint32_t poly_taps[LH2_LFSR_ORDER];
+
 static void init_lookups() {
 	if (poly_pair_lookups[0] == 0) {
+		for (int k = 0; k < LH2_LFSR_ORDER; k++) {
+			poly_taps[k] = 0;
+			for (int i = 0; i < 32; i++)
+				poly_taps[k] |= ((poly_pairs[i] >> k) & 1u) << i;
+		}
+		// Every polynomial has order 17, which find_possible_polys relies on to run the LFSR backwards
+		assert(poly_taps[LH2_LFSR_ORDER - 1] == 0xFFFFFFFF);
+
 		for (int i = 0; i < 32; i++)
 			poly_pair_lookups[i] = lfsr_lookup_ctor(poly_pairs[i]);
 	}
@@ -84,24 +101,45 @@ static uint32_t find_possible_polys(uint32_t sample, uint32_t mask, uint32_t *ti
 		return rtn;
 	}
 
-	for (int i = 0; i < 32; i++) {
-		uint32_t state = (sample >> (15u - offset));
+	// Bit 0 is the newest bit; bits [known, known + 17) are all valid and seed every polynomial alike
+	int known = 15 - offset;
+	uint32_t bits[32];
+	for (int b = known; b < known + LH2_LFSR_ORDER; b++)
+		bits[b] = ((sample >> b) & 1u) ? 0xFFFFFFFF : 0;
+
+	// Each newer bit is the parity of the tapped bits before it...
+	for (int b = known - 1; b >= 0; b--) {
+		uint32_t v = 0;
+		for (int k = 0; k < LH2_LFSR_ORDER; k++)
+			v ^= bits[b + 1 + k] & poly_taps[k];
+		bits[b] = v;
+	}
+
+	// ...and since the oldest tap is always set, that relation also gives the older bits
+	for (int b = known + LH2_LFSR_ORDER; b < 32; b++) {
+		uint32_t v = bits[b - LH2_LFSR_ORDER];
+		for (int k = 0; k < LH2_LFSR_ORDER - 1; k++)
+			v ^= bits[b - LH2_LFSR_ORDER + 1 + k] & poly_taps[k];
+		bits[b] = v;
+	}
 
-		uint32_t start_state = lsfr_iterate_rev(state, poly_pairs[i], offset);
-		uint32_t final_state = lsfr_iterate(start_state, poly_pairs[i], 15);
+	uint32_t errors = 0;
+	for (int b = 0; b < 32; b++) {
+		if ((mask >> b) & 1u)
+			errors |= bits[b] ^ (((sample >> b) & 1u) ? 0xFFFFFFFF : 0);
+	}
+	rtn = ~errors;
 
-		uint32_t error_bits = (final_state ^ sample) & mask;
-		uint32_t error = popcnt(error_bits);
+	uint32_t state = (sample >> (15u - offset));
+	for (uint32_t possible = rtn; possible; possible &= possible - 1) {
+		int i = 31 - clz(possible & -possible);
 
-		if (error > 0) {
-			if (((i / 2) == 6) || ((i / 2) == 15))
-				fprintf(stderr, "Error for %d was %d %x %x %x\n", i, error, final_state & mask, sample & mask, mask);
-			rtn ^= (1 << i);
-		} else {
-			timings[i] = lfsr_lookup_query(poly_pair_lookups[i], state) - offset;
-			reconstructed_sample[i] = final_state;
-			fprintf(stderr, "Timing for %d was %u\n", i, timings[i]);
-		}
+		uint32_t final_state = 0;
+		for (int b = 0; b < 32; b++)
+			final_state |= ((bits[b] >> i) & 1u) << b;
+
+		timings[i] = lfsr_lookup_query(poly_pair_lookups[i], state) - offset;
+		reconstructed_sample[i] = final_state;
 	}
 
 	return rtn;
@@ -153,16 +191,18 @@ survive_channel survive_decipher_channel(const uint32_t *sample, const uint32_t
 
 			for (int o = -2; o <= 2; o++) {
 				int32_t o_diff = diff + o * 8;
+				// Round to the nearest bit in both directions; division truncates toward zero
+				int32_t o_bits = o_diff > 0 ? (o_diff + 4) / 8 : -((-o_diff + 4) / 8);
 				uint32_t predicted_sample =
-					o_diff > 0 ? lsfr_iterate(recon_samples[32 * gi + j], poly_pairs[j], (o_diff + 4) / 8)
-							   : lsfr_iterate_rev(recon_samples[32 * gi + j], poly_pairs[j], (-o_diff + 4) / 8);
+					o_bits > 0 ? lsfr_iterate(recon_samples[32 * gi + j], poly_pairs[j], o_bits)
+							   : lsfr_iterate_rev(recon_samples[32 * gi + j], poly_pairs[j], -o_bits);
 
 				uint32_t error_bits = (predicted_sample ^ sample[i]) & mask[i];
 				uint32_t error = popcnt(error_bits);
 
 				if (error <= 1) {
 					recon_samples[32 * i + j] = predicted_sample;
-					timings[32 * i + j] = timings[32 * gi + j] + (o_diff + 4) / 8;
+					timings[32 * i + j] = timings[32 * gi + j] + o_bits;
 
 					if (error == 0)
 						break;
@@ -0,0 +1,56 @@
+#include "ootx_fusion.h"
+#include <math.h>
+#include <string.h>
+
+void survive_ootx_fusion_init(survive_ootx_fusion *fusion, FLT period) {
+	memset(fusion, 0, sizeof(*fusion));
+	fusion->period = period;
+}
+
+size_t survive_ootx_fusion_vote(survive_ootx_fusion *fusion, FLT now, int bit, int8_t *bits) {
+	if (fusion->stats.votes == 0) {
+		fusion->slot0_time = now;
+	}
+
+	int64_t slot = (int64_t)floor((now - fusion->slot0_time) / fusion->period + .5);
+	fusion->slot0_time += (now - (fusion->slot0_time + slot * fusion->period)) * .05;
+	fusion->stats.votes++;
+
+	if (slot < fusion->next_slot) {
+		fusion->stats.late_votes++;
+		return 0;
+	}
+
+	if (slot >= fusion->next_slot + OOTX_FUSION_SLOTS) {
+		// Nobody saw the lighthouse for a while; a run of guesses that long would never decode anyway
+		memset(fusion->slots, 0, sizeof(fusion->slots));
+		fusion->next_slot = slot;
+	}
+
+	if (bit)
+		fusion->slots[slot % OOTX_FUSION_SLOTS].ones++;
+	else
+		fusion->slots[slot % OOTX_FUSION_SLOTS].zeros++;
+	if (slot > fusion->latest_slot)
+		fusion->latest_slot = slot;
+
+	size_t cnt = 0;
+	while (fusion->next_slot + OOTX_FUSION_DELAY <= fusion->latest_slot) {
+		int idx = fusion->next_slot % OOTX_FUSION_SLOTS;
+		uint8_t ones = fusion->slots[idx].ones, zeros = fusion->slots[idx].zeros;
+		fusion->slots[idx].ones = fusion->slots[idx].zeros = 0;
+		fusion->next_slot++;
+
+		if (ones + zeros > 1)
+			fusion->stats.shared_bits++;
+		if (ones && zeros)
+			fusion->stats.split_bits++;
+		if (ones + zeros == 0)
+			fusion->stats.unseen_bits++;
+		else if (ones == zeros)
+			fusion->stats.tied_bits++;
+
+		bits[cnt++] = ones > zeros ? 1 : (zeros > ones ? 0 : -1);
+	}
+	return cnt;
+}
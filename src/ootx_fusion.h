@@ -0,0 +1,39 @@
+#pragma once
+#include "survive.h"
+
+#define OOTX_FUSION_SLOTS 64
+// Rotations the votes for a rotation are collected for before it is decided
+#define OOTX_FUSION_DELAY 3
+
+/*
+ * Every device that sees a lighthouse receives the same OOTX bit on each sync, so rather than decode the stream of a
+ * single device, each device votes for the bit of the rotation it saw and the majority goes to the decoder. Device
+ * timecodes don't share a clock, so rotations are lined up by the run time the syncs arrive at; jitter only has to stay
+ * under half a rotation.
+ */
+typedef struct survive_ootx_fusion {
+	FLT period;
+	// Run time of rotation 0, tracked as votes come in so that clock drift doesn't accumulate
+	FLT slot0_time;
+	int64_t next_slot, latest_slot;
+	struct {
+		uint8_t ones, zeros;
+	} slots[OOTX_FUSION_SLOTS];
+
+	struct {
+		uint32_t votes, late_votes;
+		// Decided rotations with more than one vote, and those of them that had votes both ways
+		uint32_t shared_bits, split_bits;
+		// Decided rotations with as many votes for either bit, and those without any vote
+		uint32_t tied_bits, unseen_bits;
+	} stats;
+} survive_ootx_fusion;
+
+SURVIVE_EXPORT void survive_ootx_fusion_init(survive_ootx_fusion *fusion, FLT period);
+
+/*
+ * Adds a vote for `bit` in the rotation whose sync arrived at run time `now`. Writes the rotations this decides to
+ * `bits`, oldest first, and returns how many there are; at most OOTX_FUSION_SLOTS. A decided rotation is the majority
+ * bit, or -1 -- a guess bit for the decoder -- when it is tied or nobody saw it.
+ */
+SURVIVE_EXPORT size_t survive_ootx_fusion_vote(survive_ootx_fusion *fusion, FLT now, int bit, int8_t *bits);
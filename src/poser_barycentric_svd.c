@@ -9,8 +9,36 @@
 #include <survive.h>
 #include <survive_reproject.h>
 
+#include "os_generic.h"
+#include "survive_thread_pool.h"
+
 #pragma GCC diagnostic ignored "-Wpedantic"
 
+STATIC_CONFIG_ITEM(SVD_RANSAC_HYPOTHESES, "svd-ransac-hypotheses", 'i',
+				   "Minimal subsets tried to find outliers before solving. 0 solves with all measurements.", 0)
+STATIC_CONFIG_ITEM(SVD_RANSAC_THREADS, "svd-ransac-threads", 'i', "Worker threads evaluating RANSAC hypotheses", 2)
+STATIC_CONFIG_ITEM(SVD_RANSAC_TIME_BUDGET, "svd-ransac-time-budget", 'f',
+				   "Milliseconds spent on RANSAC hypotheses per solve", 2.)
+STATIC_CONFIG_ITEM(SVD_RANSAC_THRESHOLD, "svd-ransac-threshold", 'f',
+				   "Reprojection error in radians up to which a measurement agrees with a hypothesis", .005)
+
+// Measurements in a hypothesis; six sensors with both axes seen
+#define SVD_RANSAC_SAMPLE_SIZE 12
+
+// Hypotheses are split over the pool's threads and the calling thread; bc_svd_compute_pose writes into the solver,
+// so every lane gets its own.
+struct svd_ransac_lane {
+	bc_svd bc;
+	size_t *order;
+	size_t order_space;
+
+	uint32_t evaluated;
+	uint32_t best_inliers;
+	FLT best_error;
+	size_t best_hypothesis;
+	SurvivePose best_obj2lh;
+};
+
 typedef struct {
 	SurviveObject *so;
 	uint32_t required_meas;
@@ -19,6 +47,17 @@ typedef struct {
 	FLT max_error_cal;
 
 	bc_svd bc;
+
+	int ransac_hypotheses;
+	FLT ransac_time_budget;
+	FLT ransac_threshold;
+	struct survive_thread_pool *ransac_pool;
+	size_t ransac_lane_cnt;
+	struct svd_ransac_lane *ransac_lanes;
+
+	struct {
+		uint32_t runs, evaluated, rejected_meas, total_meas;
+	} ransac_stats;
 } PoserDataSVD;
 
 static void survive_fill_m(void *user, FLT *eq, int axis, FLT angle) {
@@ -66,6 +105,20 @@ static void survive_fill_m(void *user, FLT *eq, int axis, FLT angle) {
 }
 
 static void PoserDataSVD_destroy(PoserDataSVD *dd) {
+	SurviveContext *ctx = dd->so->ctx;
+	if (dd->ransac_stats.runs) {
+		SV_VERBOSE(10, "BaryCentricSVD RANSAC for %s: %u solves, %.1f hypotheses per solve, %u/%u measurements rejected",
+				   dd->so->codename, dd->ransac_stats.runs, dd->ransac_stats.evaluated / (FLT)dd->ransac_stats.runs,
+				   dd->ransac_stats.rejected_meas, dd->ransac_stats.total_meas);
+	}
+
+	survive_thread_pool_free(dd->ransac_pool);
+	for (size_t i = 0; i < dd->ransac_lane_cnt; i++) {
+		bc_svd_dtor(&dd->ransac_lanes[i].bc);
+		free(dd->ransac_lanes[i].order);
+	}
+	free(dd->ransac_lanes);
+
 	bc_svd_dtor(&dd->bc);
 	survive_detach_config(dd->so->ctx, "max-error", &dd->max_error_obj);
 	survive_detach_config(dd->so->ctx, "max-cal-error", &dd->max_error_cal);
@@ -82,9 +135,191 @@ static PoserDataSVD *PoserDataSVD_new(SurviveObject *so) {
 
 	bc_svd_bc_svd(&rtn->bc, so, survive_fill_m, (LinmathPoint3d *)so->sensor_locations, so->sensor_ct);
 
+	rtn->ransac_hypotheses = survive_configi(so->ctx, SVD_RANSAC_HYPOTHESES_TAG, SC_GET, 0);
+	if (rtn->ransac_hypotheses > 0) {
+		rtn->ransac_time_budget = survive_configf(so->ctx, SVD_RANSAC_TIME_BUDGET_TAG, SC_GET, 2.) / 1000.;
+		rtn->ransac_threshold = survive_configf(so->ctx, SVD_RANSAC_THRESHOLD_TAG, SC_GET, .005);
+
+		rtn->ransac_pool =
+			survive_thread_pool_create(survive_configi(so->ctx, SVD_RANSAC_THREADS_TAG, SC_GET, 2), "svd-ransac");
+		rtn->ransac_lane_cnt = survive_thread_pool_thread_cnt(rtn->ransac_pool) + 1;
+		rtn->ransac_lanes = SV_CALLOC(rtn->ransac_lane_cnt * sizeof(struct svd_ransac_lane));
+		for (size_t i = 0; i < rtn->ransac_lane_cnt; i++) {
+			bc_svd_bc_svd(&rtn->ransac_lanes[i].bc, so, survive_fill_m, (LinmathPoint3d *)so->sensor_locations,
+						  so->sensor_ct);
+		}
+	}
+
 	return rtn;
 }
 
+// Same conversion as solve_correspondence does for object poses
+static void obj2lh_from_camera(SurvivePose *obj2lh, const FLT R[3][3], const FLT t[3]) {
+	LinmathQuat tmp;
+	quatfrommatrix33(tmp, R[0]);
+
+	const LinmathQuat rt = {0, 0, 1, 0};
+	quatrotateabout(obj2lh->Rot, rt, tmp);
+	obj2lh->Pos[0] = -t[0];
+	obj2lh->Pos[1] = t[1];
+	obj2lh->Pos[2] = -t[2];
+}
+
+struct svd_ransac_job {
+	PoserDataSVD *dd;
+	const survive_reproject_model_t *model;
+	size_t sample_size;
+	double deadline;
+};
+
+/**
+ * Counts the measurements that are within the threshold of what obj2lh reprojects to; error is their mean
+ * reprojection error. The angles in the solver already had the lighthouse calibration taken out, so they are compared
+ * against the ideal model. Points behind the lighthouse -- mirrored solutions -- never agree.
+ */
+static uint32_t svd_ransac_score(const struct svd_ransac_job *job, const SurvivePose *obj2lh, bool *inliers,
+								 FLT *error) {
+	static const BaseStationCal ideal_cal[2] = {0};
+	const PoserDataSVD *dd = job->dd;
+	const bc_svd *bc = &dd->bc;
+
+	uint32_t cnt = 0;
+	FLT sum = 0;
+	for (size_t i = 0; i < bc->meas_cnt; i++) {
+		const bc_svd_meas_t *meas = &bc->meas[i];
+		LinmathPoint3d ptInLh;
+		ApplyPoseToPoint(ptInLh, obj2lh, &dd->so->sensor_locations[meas->obj_idx * 3]);
+
+		FLT err = ptInLh[2] < 0 ? fabs(job->model->reprojectAxisFn[meas->axis](ideal_cal, ptInLh) - meas->angle)
+								: INFINITY;
+		bool agrees = err < dd->ransac_threshold;
+		if (agrees) {
+			cnt++;
+			sum += err;
+		}
+		if (inliers)
+			inliers[i] = agrees;
+	}
+
+	*error = cnt ? sum / cnt : INFINITY;
+	return cnt;
+}
+
+static uint64_t svd_ransac_rand(uint64_t *state) {
+	*state = *state * 6364136223846793005ull + 1442695040888963407ull;
+	return *state >> 33;
+}
+
+static void svd_ransac_run_lane(void *user, size_t lane_idx) {
+	const struct svd_ransac_job *job = user;
+	PoserDataSVD *dd = job->dd;
+	struct svd_ransac_lane *lane = &dd->ransac_lanes[lane_idx];
+	size_t meas_cnt = dd->bc.meas_cnt;
+
+	lane->evaluated = lane->best_inliers = 0;
+	lane->best_error = INFINITY;
+
+	if (lane->order_space < meas_cnt) {
+		lane->order = SV_REALLOC(lane->order, meas_cnt * sizeof(size_t));
+		lane->order_space = meas_cnt;
+	}
+
+	for (size_t h = lane_idx; h < (size_t)dd->ransac_hypotheses; h += dd->ransac_lane_cnt) {
+		if (OGGetAbsoluteTime() > job->deadline)
+			break;
+		lane->evaluated++;
+
+		// Seeded by the hypothesis so that a given hypothesis always draws the same subset, whichever lane runs it
+		uint64_t rng = (h + 1) * 0x9E3779B97F4A7C15ull;
+		for (size_t i = 0; i < meas_cnt; i++)
+			lane->order[i] = i;
+
+		bc_svd_reset_correspondences(&lane->bc);
+		for (size_t i = 0; i < job->sample_size; i++) {
+			size_t j = i + svd_ransac_rand(&rng) % (meas_cnt - i);
+			size_t tmp = lane->order[i];
+			lane->order[i] = lane->order[j];
+			lane->order[j] = tmp;
+
+			const bc_svd_meas_t *meas = &dd->bc.meas[lane->order[i]];
+			bc_svd_add_single_correspondence(&lane->bc, meas->obj_idx, meas->axis, meas->angle);
+		}
+
+		FLT R[3][3], t[3];
+		if (bc_svd_compute_pose(&lane->bc, R, t) < 0 || magnitude3d(t) < 0.25 || magnitude3d(t) > 25)
+			continue;
+
+		SurvivePose obj2lh;
+		obj2lh_from_camera(&obj2lh, R, t);
+
+		FLT error;
+		uint32_t inliers = svd_ransac_score(job, &obj2lh, 0, &error);
+		if (inliers > lane->best_inliers || (inliers == lane->best_inliers && error < lane->best_error)) {
+			lane->best_inliers = inliers;
+			lane->best_error = error;
+			lane->best_hypothesis = h;
+			lane->best_obj2lh = obj2lh;
+		}
+	}
+}
+
+/**
+ * Robust seeding: reflections and crosstalk put measurements into the solver that no pose explains, and a solve over
+ * all of them is then either rejected or wrong enough that the general optimizer has to reset. Poses are fit to
+ * random minimal subsets within the time budget, and only the measurements that agree with the best of them -- most
+ * measurements within the threshold, then the lowest error -- are kept in dd->bc for the final solve.
+ */
+static void svd_ransac_select(PoserDataSVD *dd) {
+	SurviveContext *ctx = dd->so->ctx;
+	bc_svd *bc = &dd->bc;
+
+	size_t sample_size = dd->required_meas > SVD_RANSAC_SAMPLE_SIZE ? dd->required_meas : SVD_RANSAC_SAMPLE_SIZE;
+	if (dd->ransac_hypotheses <= 0 || bc->meas_cnt <= sample_size)
+		return;
+
+	struct svd_ransac_job job = {
+		.dd = dd,
+		.model = survive_reproject_model(ctx),
+		.sample_size = sample_size,
+		.deadline = OGGetAbsoluteTime() + dd->ransac_time_budget,
+	};
+	survive_thread_pool_run(dd->ransac_pool, dd->ransac_lane_cnt, svd_ransac_run_lane, &job);
+
+	const struct svd_ransac_lane *best = 0;
+	for (size_t i = 0; i < dd->ransac_lane_cnt; i++) {
+		const struct svd_ransac_lane *lane = &dd->ransac_lanes[i];
+		dd->ransac_stats.evaluated += lane->evaluated;
+		if (lane->best_inliers == 0)
+			continue;
+		if (best == 0 || lane->best_inliers > best->best_inliers ||
+			(lane->best_inliers == best->best_inliers &&
+			 (lane->best_error < best->best_error ||
+			  (lane->best_error == best->best_error && lane->best_hypothesis < best->best_hypothesis))))
+			best = lane;
+	}
+	dd->ransac_stats.runs++;
+	dd->ransac_stats.total_meas += bc->meas_cnt;
+
+	// Without a hypothesis that explains enough of the scene, solve with everything like before
+	if (best == 0 || best->best_inliers < dd->required_meas)
+		return;
+
+	bool *inliers = alloca(bc->meas_cnt * sizeof(bool));
+	FLT error;
+	svd_ransac_score(&job, &best->best_obj2lh, inliers, &error);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < bc->meas_cnt; i++) {
+		if (inliers[i])
+			bc->meas[kept++] = bc->meas[i];
+	}
+
+	SV_VERBOSE(200, "BaryCentricSVD RANSAC for %s kept %d/%d measurements (hypothesis %d, err %f)",
+			   dd->so->codename, (int)kept, (int)bc->meas_cnt, (int)best->best_hypothesis, error);
+	dd->ransac_stats.rejected_meas += bc->meas_cnt - kept;
+	bc->meas_cnt = kept;
+}
+
 static SurvivePose solve_correspondence(PoserDataSVD *dd, bool cameraToWorld) {
 	SurviveObject *so = dd->so;
 	SurvivePose rtn = {0};
@@ -95,6 +330,8 @@ static SurvivePose solve_correspondence(PoserDataSVD *dd, bool cameraToWorld) {
 		return rtn;
 	}
 
+	svd_ransac_select(dd);
+
 	FLT r[3][3];
 
 	FLT err = bc_svd_compute_pose(&dd->bc, r, rtn.Pos);
@@ -17,9 +17,11 @@
 #include "survive_async_optimizer.h"
 #include "survive_config.h"
 #include "survive_kalman_tracker.h"
+#include "survive_kalman_lighthouses.h"
 #include "survive_recording.h"
 #include "survive_reproject.h"
 #include "survive_reproject_gen2.h"
+#include "survive_thread_pool.h"
 
 #ifndef _WIN32
 //#define DEBUG_NAN
@@ -57,6 +59,16 @@ typedef struct MPFITStats {
 	uint32_t total_lh_cnt;
 	uint32_t dropped_meas_cnt;
 	uint32_t dropped_lh_cnt;
+
+	// Solves that ran under mpfit-latency-budget, and those of them that the budget stopped early. The latter aren't
+	// counted in status_cnts.
+	int budget_runs;
+	int budget_terminated;
+	FLT budget_solve_time, budget_max_solve_time;
+
+	// Solves that had more light measurements than mpfit-max-meas, and the measurements left out of them
+	int capped_runs;
+	uint32_t capped_meas_cnt;
 } MPFITStats;
 
 typedef struct MPFITGlobalData {
@@ -66,6 +78,15 @@ typedef struct MPFITGlobalData {
 
 static MPFITGlobalData g;
 
+// What the last global solve determined about each lighthouse. Incremental solves, which only see the newest scenes,
+// use it as a prior in place of the scenes that dropped out of the window.
+typedef struct MPFITGlobalPrior {
+	bool valid[NUM_GEN2_LIGHTHOUSES];
+	SurvivePose world2lh[NUM_GEN2_LIGHTHOUSES];
+	// 1-sigma of each camera parameter, in the parameterization the optimizer ran with
+	FLT sigma[NUM_GEN2_LIGHTHOUSES][7];
+} MPFITGlobalPrior;
+
 typedef struct MPFITData {
 	GeneralOptimizerData opt;
 
@@ -96,6 +117,29 @@ typedef struct MPFITData {
   bool globalDataAvailable;
   struct survive_async_optimizer *async_optimizer;
 
+  MPFITGlobalPrior global_prior;
+  FLT global_prior_scale;
+
+  int global_starts;
+  int global_threads;
+  FLT global_start_noise;
+  struct survive_thread_pool *global_pool;
+
+  // Seconds
+  FLT latency_budget;
+  FLT warm_start_scale;
+  struct {
+	  // Running averages the iteration limits are worked out from
+	  FLT fev_time, fev_per_iter;
+
+	  // Covariance of the last budgeted solve; the next one starts with it as prior
+	  bool prior_valid;
+	  FLT prior_time;
+	  FLT prior_cov[7 * 7];
+  } budget;
+
+  int max_meas;
+
   survive_optimizer_settings optimizer_settings;
 } MPFITData;
 
@@ -110,6 +154,28 @@ STRUCT_CONFIG_ITEM("mpfit-stationary-object-up-variance",
 				   t->stationary_obj_up_variance)
 STRUCT_CONFIG_ITEM("mpfit-lighthouse-up-variance",
 				   "How much to weight having the accel direction on lighthouses pointing up", 1., t->lh_up_variance)
+STRUCT_CONFIG_ITEM("mpfit-global-prior-scale",
+				   "Factor on the uncertainty of the previous global solve when it is used as prior for an incremental one",
+				   2., t->global_prior_scale)
+STRUCT_CONFIG_ITEM("mpfit-global-starts",
+				   "Number of differently seeded global solves to run; the one that ends with the least error is used", 1,
+				   t->global_starts)
+STRUCT_CONFIG_ITEM("mpfit-global-threads", "Worker threads for the starts of a global solve", 4, t->global_threads)
+STRUCT_CONFIG_ITEM("mpfit-global-start-noise",
+				   "Standard deviation in meters of the perturbation of global solve starts; rotations get a tenth of it "
+				   "in radians",
+				   .05, t->global_start_noise)
+STRUCT_CONFIG_ITEM("mpfit-latency-budget",
+				   "Seconds a tracking solve may take; iterations and function evaluations are limited to fit. 0 disables",
+				   0., t->latency_budget)
+STRUCT_CONFIG_ITEM("mpfit-warm-start-scale",
+				   "Factor on the uncertainty of the last budgeted solve when it is used as prior for the next one. 0 "
+				   "disables",
+				   3., t->warm_start_scale)
+STRUCT_CONFIG_ITEM("mpfit-max-meas",
+				   "Most light measurements a tracking solve uses; they are picked to be spread over the object and to "
+				   "have low noise. 0 uses all",
+				   0, t->max_meas)
 END_STRUCT_CONFIG_SECTION(MPFITData)
 
 static size_t remove_lh_from_meas(survive_optimizer *mpfitctx, int lh) {
@@ -129,6 +195,7 @@ struct async_optimizer_user {
 	PoserDataLight pdl;
 	bool canPossiblySolveLHS;
 	bool worldEstablished;
+	bool stopped_by_budget;
 	size_t meas_for_lhs_axis[NUM_GEN2_LIGHTHOUSES * 2];
 	struct variance_measure meas_variance[NUM_GEN2_LIGHTHOUSES * 2];
 
@@ -222,6 +289,102 @@ static size_t construct_input_from_scene(const MPFITData *d, survive_long_timeco
 	return rtn;
 }
 
+// Mean variance of the angle a sensor reported while the object was stationary; < 0 when it was never measured
+static FLT tracked_light_variance(const SurviveObject *so, int lh, int sensor, int axis) {
+	if (so->tracker == 0)
+		return -1;
+	const struct variance_tracker *v = &so->tracker->light_variance[lh][sensor][axis];
+	return v->counts ? v->variances[0] / (FLT)v->counts : -1;
+}
+
+/**
+ * Cuts the light measurements down to mpfit-max-meas so that solve time doesn't grow with the number of visible
+ * sensors. Lighthouse axes take turns picking, so none of them loses all its data; within an axis the sensor farthest
+ * from those already picked wins, discounted by how noisy the tracker has seen it be. Returns the new measurement
+ * count; meas_for_lhs_axis is updated to match.
+ */
+static size_t select_measurements(MPFITData *d, survive_optimizer *mpfitctx, size_t meas_size,
+								  size_t *meas_for_lhs_axis) {
+	SurviveObject *so = d->opt.so;
+	survive_optimizer_measurement *meas = mpfitctx->measurements;
+	size_t cap = linmath_max(d->max_meas, d->required_meas);
+
+	FLT *weight = alloca(sizeof(FLT) * meas_size);
+	FLT *min_dist = alloca(sizeof(FLT) * meas_size);
+	bool *picked = alloca(sizeof(bool) * meas_size);
+
+	FLT mean_var = 0;
+	size_t var_cnt = 0, kept = 0;
+	for (size_t i = 0; i < meas_size; i++) {
+		weight[i] = -1;
+		min_dist[i] = INFINITY;
+		picked[i] = meas[i].meas_type != survive_optimizer_measurement_type_light;
+		if (picked[i]) {
+			kept++;
+			continue;
+		}
+
+		weight[i] = tracked_light_variance(so, meas[i].light.lh, meas[i].light.sensor_idx, meas[i].light.axis);
+		if (weight[i] >= 0) {
+			mean_var += weight[i];
+			var_cnt++;
+		}
+	}
+	mean_var = var_cnt ? mean_var / var_cnt : 0;
+
+	// Sensors the tracker has no variance for count as average
+	for (size_t i = 0; i < meas_size; i++) {
+		FLT var = weight[i] >= 0 ? weight[i] : mean_var;
+		weight[i] = mean_var > 0 ? mean_var / (mean_var + var) : 1.;
+	}
+
+	memset(meas_for_lhs_axis, 0, sizeof(size_t) * NUM_GEN2_LIGHTHOUSES * 2);
+	bool progress = true;
+	while (kept < cap && progress) {
+		progress = false;
+		for (int bucket = 0; bucket < NUM_GEN2_LIGHTHOUSES * 2 && kept < cap; bucket++) {
+			int best = -1;
+			FLT best_score = -1;
+			for (size_t i = 0; i < meas_size; i++) {
+				if (picked[i] || meas[i].light.lh * 2 + meas[i].light.axis != bucket)
+					continue;
+
+				// Until the axis has a pick, every distance is infinite and only the noise decides
+				FLT score = isinf(min_dist[i]) ? weight[i] : weight[i] * min_dist[i];
+				if (score > best_score) {
+					best_score = score;
+					best = i;
+				}
+			}
+			if (best < 0)
+				continue;
+
+			picked[best] = true;
+			kept++;
+			progress = true;
+			meas_for_lhs_axis[bucket]++;
+
+			const FLT *best_location = &so->sensor_locations[3 * meas[best].light.sensor_idx];
+			for (size_t i = 0; i < meas_size; i++) {
+				if (picked[i] || meas[i].light.lh * 2 + meas[i].light.axis != bucket)
+					continue;
+				FLT dist = dist3d(&so->sensor_locations[3 * meas[i].light.sensor_idx], best_location);
+				min_dist[i] = linmath_min(min_dist[i], dist);
+			}
+		}
+	}
+
+	size_t rtn = 0;
+	for (size_t i = 0; i < meas_size; i++) {
+		if (picked[i])
+			meas[rtn++] = meas[i];
+	}
+
+	d->stats.capped_runs++;
+	d->stats.capped_meas_cnt += meas_size - rtn;
+	return rtn;
+}
+
 static bool invalid_starting_condition(MPFITData *d, size_t meas_size, const size_t *meas_for_lhs_axis) {
 	static int failure_count = 500;
 	struct SurviveObject *so = d->opt.so;
@@ -450,6 +613,11 @@ static int setup_optimizer(struct async_optimizer_user *user, survive_optimizer
 		return -2;
 	}
 
+	// Lighthouse solves need all the data they can get; only tracking solves are capped
+	if (!canPossiblySolveLHS && d->max_meas > 0 && meas_size > (size_t)d->max_meas && so->sensor_locations) {
+		meas_size = select_measurements(d, mpfitctx, meas_size, meas_for_lhs_axis);
+	}
+
 	mpfitctx->measurementsCnt = meas_size;
 
 	/*
@@ -628,7 +796,8 @@ static FLT handle_optimizer_results(survive_optimizer *mpfitctx, int res, const
 	d->stats.total_runs++;
 	d->stats.sum_errors += result->bestnorm;
 	d->stats.sum_origerrors += result->orignorm;
-	if (result->status > 0) {
+	// Stops because of mpfit-latency-budget are counted on their own
+	if (result->status > 0 && !user_data->stopped_by_budget) {
 		assert(result->status < 10);
 		d->stats.status_cnts[result->status - 1]++;
 	}
@@ -657,6 +826,103 @@ static void handle_results(MPFITData *d, PoserDataLight *lightData, FLT error, S
 
 typedef void (*handle_results_fn)(MPFITData *d, PoserDataLight *lightData, FLT error, SurvivePose *estimate);
 
+/**
+ * Warm start for budgeted solves: the seed pose gets a prior with the covariance the previous solve ended with, so a
+ * solve the budget cuts short still lands close to where the last one was confident the object is. The prior is only
+ * used while it is recent.
+ */
+static void add_warm_start_prior(MPFITData *d, survive_optimizer *mpfitctx) {
+	SurviveContext *ctx = d->opt.so->ctx;
+	if (!d->budget.prior_valid || d->warm_start_scale <= 0 || survive_run_time(ctx) - d->budget.prior_time > .1)
+		return;
+
+	// Object pose parameters come first
+	const SurvivePose *seed = survive_optimizer_get_pose(mpfitctx);
+	FLT expected[7], sigma[7];
+	CnMat P_q = cnMat(7, 7, d->budget.prior_cov);
+	int param_cnt = 7;
+	if (mpfitctx->settings->use_quat_model) {
+		memcpy(expected, seed->Pos, sizeof(expected));
+		for (int i = 0; i < 7; i++)
+			sigma[i] = sqrt(cnMatrixGet(&P_q, i, i));
+	} else {
+		CN_CREATE_STACK_MAT(P_aa, 6, 6);
+		survive_covariance_pose2poseAA(&P_aa, seed, &P_q);
+		copy3d(expected, seed->Pos);
+		quattoaxisanglemag(expected + 3, seed->Rot);
+		for (int i = 0; i < 6; i++)
+			sigma[i] = sqrt(cnMatrixGet(&P_aa, i, i));
+		param_cnt = 6;
+		CN_FREE_STACK_MAT(P_aa);
+	}
+
+	for (int i = 0; i < param_cnt; i++) {
+		if (mpfitctx->mp_parameters_info[i].fixed || !(sigma[i] > 0) || !isfinite(sigma[i]))
+			continue;
+
+		survive_optimizer_measurement *meas =
+			survive_optimizer_emplace_meas(mpfitctx, survive_optimizer_measurement_type_parameters_bias);
+		meas->variance = sigma[i] * d->warm_start_scale;
+		meas->parameter_bias.parameter_index = i;
+		meas->parameter_bias.expected_value = expected[i];
+	}
+}
+
+/**
+ * Limits the solve to the function evaluations that fit into the latency budget at the rate previous solves ran at;
+ * every iteration is allowed to finish. Until there is a rate to go by, the solve runs unlimited.
+ */
+static void setup_budget_config(MPFITData *d, survive_optimizer *mpfitctx, mp_config *cfg) {
+	*cfg = *survive_optimizer_default_config(d->opt.so->ctx);
+	mpfitctx->cfg = cfg;
+	if (d->budget.fev_time <= 0)
+		return;
+
+	FLT fev_per_iter = linmath_max(d->budget.fev_per_iter, 1);
+	int maxfev = d->latency_budget / d->budget.fev_time;
+	maxfev = linmath_max(maxfev, 2 * fev_per_iter + 1);
+	int maxiter = linmath_max(1, maxfev / fev_per_iter);
+
+	if (cfg->maxfev <= 0 || maxfev < cfg->maxfev)
+		cfg->maxfev = maxfev;
+	if (cfg->maxiter <= 0 || maxiter < cfg->maxiter)
+		cfg->maxiter = maxiter;
+}
+
+// Returns whether the budget stopped the solve
+static bool update_budget(MPFITData *d, int res, const mp_result *result, const mp_config *cfg, FLT solve_time,
+						  const CnMat *R) {
+	SurviveContext *ctx = d->opt.so->ctx;
+
+	if (result->nfev > 0) {
+		FLT fev_time = solve_time / result->nfev;
+		FLT fev_per_iter = result->niter > 0 ? result->nfev / (FLT)result->niter : result->nfev;
+		bool first = d->budget.fev_time <= 0;
+		d->budget.fev_time = first ? fev_time : .9 * d->budget.fev_time + .1 * fev_time;
+		d->budget.fev_per_iter = first ? fev_per_iter : .9 * d->budget.fev_per_iter + .1 * fev_per_iter;
+	}
+
+	d->stats.budget_runs++;
+	d->stats.budget_solve_time += solve_time;
+	if (solve_time > d->stats.budget_max_solve_time)
+		d->stats.budget_max_solve_time = solve_time;
+
+	bool stopped_early = result->status == MP_MAXITER && ((cfg->maxfev > 0 && result->nfev >= cfg->maxfev) ||
+														   (cfg->maxiter > 0 && result->niter >= cfg->maxiter));
+	if (stopped_early) {
+		d->stats.budget_terminated++;
+		SV_VERBOSE(105, "%s solve stopped by latency budget after %d iterations / %d fevals (%6.3fms)",
+				   survive_colorize_codename(d->opt.so), result->niter, result->nfev, solve_time * 1000.);
+	}
+
+	d->budget.prior_valid = res > 0 && R != 0 && cn_is_finite(R);
+	if (d->budget.prior_valid) {
+		memcpy(d->budget.prior_cov, R->data, sizeof(d->budget.prior_cov));
+		d->budget.prior_time = survive_run_time(ctx);
+	}
+	return stopped_early;
+}
+
 static FLT run_mpfit_find_3d_structure(MPFITData *d, PoserDataLight *pdl, SurviveSensorActivations *scene,
 									   SurvivePose *out, CnMat *R) {
 	SurviveObject *so = d->opt.so;
@@ -685,11 +951,25 @@ static FLT run_mpfit_find_3d_structure(MPFITData *d, PoserDataLight *pdl, Surviv
 
 	mp_result result = {0};
 
+	// Solves for lighthouses run with the precise config and aren't held to the budget
+	mp_config budget_cfg;
+	bool budgeted = d->latency_budget > 0 && mpfitctx.cfg == 0;
+	if (budgeted) {
+		add_warm_start_prior(d, &mpfitctx);
+		setup_budget_config(d, &mpfitctx, &budget_cfg);
+	}
+
 	int nfree = survive_optimizer_get_free_parameters_count(&mpfitctx);
 	survive_release_ctx_lock(ctx);
+	double solve_start = OGGetAbsoluteTime();
 	int res = survive_optimizer_run(&mpfitctx, &result, R);
+	FLT solve_time = OGGetAbsoluteTime() - solve_start;
 	survive_get_ctx_lock(ctx);
 
+	if (budgeted) {
+		user_data.stopped_by_budget = update_budget(d, res, &result, &budget_cfg, solve_time, R);
+	}
+
 	return handle_optimizer_results(&mpfitctx, res, &result, &user_data, out);
 }
 
@@ -719,6 +999,20 @@ static inline void print_stats(SurviveContext *ctx, MPFITStats *stats) {
 	for (int i = 0; i < sizeof(stats->status_cnts) / sizeof(int); i++) {
 		SV_INFO("\tStatus %10s %d", survive_optimizer_error(i + 1), stats->status_cnts[i]);
 	}
+
+	if (stats->budget_runs) {
+		SV_INFO("\tbudgeted runs     %d", stats->budget_runs);
+		SV_INFO("\tstopped by budget %7d / %8d (%4.2f%%)", stats->budget_terminated, stats->budget_runs,
+				100. * stats->budget_terminated / (FLT)stats->budget_runs);
+		SV_INFO("\tbudget solve time %6.3fms avg, %6.3fms max", 1000. * stats->budget_solve_time / stats->budget_runs,
+				1000. * stats->budget_max_solve_time);
+	}
+
+	if (stats->capped_runs) {
+		SV_INFO("\tcapped runs       %d", stats->capped_runs);
+		SV_INFO("\tmeas over cap     %7u (%6.2f per capped run)", stats->capped_meas_cnt,
+				stats->capped_meas_cnt / (FLT)stats->capped_runs);
+	}
 }
 
 bool find_initial_camera(PoserDataGlobalScenes *gss, int lh, SurvivePose *pose) {
@@ -770,6 +1064,199 @@ void global_lh_pose(SurviveObject *so, uint8_t lighthouse, SurvivePose *lighthou
 	SV_VERBOSE(10, "Initial LH pose (%d) " SurvivePose_format, lighthouse, SURVIVE_POSE_EXPAND(*lighthouse_pose));
 }
 
+static void add_global_prior(struct SurviveContext *ctx, MPFITData *d, survive_optimizer *mpfitctx) {
+	int cam_start = survive_optimizer_get_camera_index(mpfitctx);
+	for (int lh = 0; lh < mpfitctx->cameraLength; lh++) {
+		if (!d->global_prior.valid[lh])
+			continue;
+
+		FLT expected[7];
+		const SurvivePose *prior = &d->global_prior.world2lh[lh];
+		copy3d(expected, prior->Pos);
+		if (mpfitctx->settings->use_quat_model) {
+			quatcopy(expected + 3, prior->Rot);
+		} else {
+			quattoaxisanglemag(expected + 3, prior->Rot);
+			expected[6] = 0;
+		}
+
+		for (int j = 0; j < 7; j++) {
+			int idx = cam_start + lh * 7 + j;
+			if (mpfitctx->mp_parameters_info[idx].fixed || d->global_prior.sigma[lh][j] <= 0)
+				continue;
+
+			survive_optimizer_measurement *meas =
+				survive_optimizer_emplace_meas(mpfitctx, survive_optimizer_measurement_type_parameters_bias);
+			meas->variance = d->global_prior.sigma[lh][j] * d->global_prior_scale;
+			meas->parameter_bias.parameter_index = idx;
+			meas->parameter_bias.expected_value = expected[j];
+		}
+		SV_VERBOSE(100, "Prior for LH%d " SurvivePose_format, lh, SURVIVE_POSE_EXPAND(*prior));
+	}
+}
+
+static void update_global_prior(MPFITData *d, survive_optimizer *mpfitctx, const SurvivePose *lh2worlds,
+								const size_t *lh_meas, const FLT *xerror) {
+	int cam_start = survive_optimizer_get_camera_index(mpfitctx);
+	for (int lh = 0; lh < mpfitctx->cameraLength; lh++) {
+		if (quatiszero(lh2worlds[lh].Rot) || lh_meas[lh] == 0)
+			continue;
+
+		d->global_prior.valid[lh] = true;
+		d->global_prior.world2lh[lh] = InvertPoseRtn(&lh2worlds[lh]);
+		for (int j = 0; j < 7; j++)
+			d->global_prior.sigma[lh][j] = xerror[cam_start + lh * 7 + j];
+	}
+}
+
+struct global_start {
+	survive_optimizer opt;
+	survive_optimizer_settings settings;
+	mp_result result;
+	int res;
+};
+
+// Normal distributed numbers from a generator seeded by the start index, so a start is the same whichever thread
+// runs it and whatever else ran before
+static FLT start_normrand(uint64_t *state) {
+	FLT u[2];
+	for (int i = 0; i < 2; i++) {
+		*state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+		u[i] = ((*state >> 11) + .5) / (FLT)(1ULL << 53);
+	}
+	return sqrt(-2 * log(u[0])) * cos(2 * LINMATHPI * u[1]);
+}
+
+static void perturb_pose(SurvivePose *pose, uint64_t *rng, FLT noise) {
+	LinmathAxisAngle aa;
+	for (int j = 0; j < 3; j++) {
+		pose->Pos[j] += noise * start_normrand(rng);
+		aa[j] = noise * .1 * start_normrand(rng);
+	}
+
+	LinmathQuat q;
+	quatfromaxisanglemag(q, aa);
+	quatrotateabout(pose->Rot, q, pose->Rot);
+}
+
+/*
+ * Seeds start `idx`. Start 0 is the regular seed; start 1 takes the lighthouse poses the lighthouse kalman filters
+ * converged to, where they have one; every other start is the regular seed with noise on every free pose.
+ */
+static void seed_global_start(SurviveContext *ctx, MPFITData *d, survive_optimizer *opt, int idx) {
+	if (idx == 0)
+		return;
+
+	SurvivePose *cameras = survive_optimizer_get_camera(opt);
+	int cam_start = survive_optimizer_get_camera_index(opt);
+	if (idx == 1) {
+		bool seeded = false;
+		for (int lh = 0; lh < opt->cameraLength; lh++) {
+			SurviveKalmanLighthouse *tracker = ctx->bsd[lh].tracker;
+			if (opt->mp_parameters_info[cam_start + lh * 7].fixed || tracker == 0 || quatiszero(tracker->state.Rot))
+				continue;
+			cameras[lh] = InvertPoseRtn(&tracker->state);
+			seeded = true;
+		}
+		if (seeded)
+			return;
+	}
+
+	uint64_t rng = idx;
+	for (int lh = 0; lh < opt->cameraLength; lh++) {
+		if (!opt->mp_parameters_info[cam_start + lh * 7].fixed && !quatiszero(cameras[lh].Rot))
+			perturb_pose(&cameras[lh], &rng, d->global_start_noise);
+	}
+
+	SurvivePose *poses = survive_optimizer_get_pose(opt);
+	for (int i = 0; i < opt->poseLength; i++) {
+		if (!opt->mp_parameters_info[i * 7].fixed && !quatiszero(poses[i].Rot))
+			perturb_pose(&poses[i], &rng, d->global_start_noise);
+	}
+}
+
+static void run_global_start(void *user, size_t job) {
+	struct global_start *start = (struct global_start *)user + job;
+	start->res = survive_optimizer_run(&start->opt, &start->result, 0);
+}
+
+/*
+ * Runs d->global_starts copies of the set up problem from different seeds on the worker pool, and picks the successful
+ * one with the least error. Ties go to the lowest start index so the outcome doesn't depend on scheduling. The starts
+ * run without the per object lighthouse corrections and without recording; `opt` itself is then solved from the
+ * parameters of the pick with both, which leaves its parameters and result in `opt` and `result`. Called with the
+ * context lock held; it is released while solving.
+ */
+static int run_global_starts(SurviveContext *ctx, MPFITData *d, survive_optimizer *opt, mp_result *result) {
+	if (d->global_pool == 0) {
+		d->global_pool = survive_thread_pool_create(d->global_threads, "global solve");
+	}
+
+	int starts_cnt = d->global_starts;
+	size_t param_cnt = survive_optimizer_get_parameters_count(opt);
+	struct global_start *starts = SV_CALLOC_N(starts_cnt, sizeof(struct global_start));
+	for (int i = 0; i < starts_cnt; i++) {
+		survive_optimizer_clone(&starts[i].opt, opt);
+
+		// Per object lighthouse corrections and the recording are written by the optimizer; keep the starts from
+		// racing on them
+		starts[i].settings = *opt->settings;
+		starts[i].settings.lh_scale_correction = starts[i].settings.lh_offset_correction = 0;
+		starts[i].opt.settings = &starts[i].settings;
+		starts[i].opt.norecord = true;
+
+		starts[i].result.xerror = result->xerror ? SV_CALLOC_N(param_cnt, sizeof(FLT)) : 0;
+		seed_global_start(ctx, d, &starts[i].opt, i);
+	}
+
+	survive_release_ctx_lock(ctx);
+	survive_thread_pool_run(d->global_pool, starts_cnt, run_global_start, starts);
+
+	int best = 0;
+	for (int i = 0; i < starts_cnt; i++) {
+		SV_VERBOSE(10, "Global solve start %d: %f/%10.10f (%d, %s)", i, starts[i].result.orignorm,
+				   starts[i].result.bestnorm, starts[i].res, survive_optimizer_error(starts[i].res));
+
+		bool better = starts[i].res > 0 &&
+					  (starts[best].res <= 0 || starts[i].result.bestnorm < starts[best].result.bestnorm);
+		if (better)
+			best = i;
+	}
+	SV_VERBOSE(10, "Using global solve start %d of %d", best, starts_cnt);
+
+	// Starting from a converged solution this takes few iterations; the pick is used as is if it fails
+	int res = starts[best].res;
+	bool refined = false;
+	if (res > 0) {
+		memcpy(opt->parameters, starts[best].opt.parameters, param_cnt * sizeof(FLT));
+		int refined_res = survive_optimizer_run(opt, result, 0);
+		refined = refined_res > 0;
+		if (refined) {
+			res = refined_res;
+		} else {
+			SV_VERBOSE(10, "Refining global solve start %d failed (%d, %s)", best, refined_res,
+					   survive_optimizer_error(refined_res));
+		}
+	}
+	survive_get_ctx_lock(ctx);
+
+	if (!refined) {
+		FLT *xerror = result->xerror;
+		*result = starts[best].result;
+		result->xerror = xerror;
+		if (xerror)
+			memcpy(xerror, starts[best].result.xerror, param_cnt * sizeof(FLT));
+		memcpy(opt->parameters, starts[best].opt.parameters, param_cnt * sizeof(FLT));
+	}
+
+	for (int i = 0; i < starts_cnt; i++) {
+		free(starts[i].result.xerror);
+		survive_optimizer_free_clone(&starts[i].opt);
+	}
+	free(starts);
+	return res;
+}
+
 bool solve_global_scene(struct SurviveContext *ctx, MPFITData *d, PoserDataGlobalScenes *gss) {
 	if (gss->scenes_cnt == 0 || gss->scenes == 0)
 		return false;
@@ -913,22 +1400,38 @@ bool solve_global_scene(struct SurviveContext *ctx, MPFITData *d, PoserDataGloba
 		mpfitctx.mp_parameters_info[i].fixed = true;
 	}
 
+	size_t data_meas_cnt = mpfitctx.measurementsCnt;
+	if (gss->incremental) {
+		add_global_prior(ctx, d, &mpfitctx);
+	}
+
 	mp_result result = {0};
+	result.xerror = alloca(sizeof(FLT) * survive_optimizer_get_parameters_count(&mpfitctx));
 	mpfitctx.cfg = survive_optimizer_precise_config();
 
-	survive_release_ctx_lock(ctx);
-	int res = survive_optimizer_run(&mpfitctx, &result, 0);
-	survive_get_ctx_lock(ctx);
+	int res;
+	double solve_start = OGGetAbsoluteTime();
+	if (d->global_starts > 1) {
+		res = run_global_starts(ctx, d, &mpfitctx, &result);
+	} else {
+		survive_release_ctx_lock(ctx);
+		res = survive_optimizer_run(&mpfitctx, &result, 0);
+		survive_get_ctx_lock(ctx);
+	}
+	FLT solve_time = OGGetAbsoluteTime() - solve_start;
 	bool status_failure = res <= 0;
 	FLT sensor_covariance = d->sensor_variance * d->sensor_variance;
+
+	FLT rms_error = sqrt(result.bestnorm / (mpfitctx.measurementsCnt + 1e-10));
 	if (status_failure || result.bestnorm * sensor_covariance > 1e-2) {
-		SV_WARN("MPFIT status failure %f/%f (%d measurements, %d, %s)", result.orignorm, result.bestnorm,
-				(int)mpfitctx.measurementsCnt, res, survive_optimizer_error(res));
+		SV_WARN("MPFIT status failure %f/%f (%d measurements, %d, %s) in %7.3fms", result.orignorm, result.bestnorm,
+				(int)mpfitctx.measurementsCnt, res, survive_optimizer_error(res), solve_time * 1000.);
 
 		return false;
 	} else {
-		SV_INFO("MPFIT success %f/%10.10f (%d measurements, %d, %s)", result.orignorm, result.bestnorm,
-				(int)mpfitctx.measurementsCnt, res, survive_optimizer_error(res));
+		SV_INFO("MPFIT success %f/%10.10f (%d measurements, %d prior, %d, %s) in %7.3fms, rms %e", result.orignorm,
+				result.bestnorm, (int)data_meas_cnt, (int)(mpfitctx.measurementsCnt - data_meas_cnt), res,
+				survive_optimizer_error(res), solve_time * 1000., rms_error);
 
 		SurvivePose *opt_cameras = survive_optimizer_get_camera(&mpfitctx);
 		SurvivePose cameras[NUM_GEN2_LIGHTHOUSES] = {0};
@@ -967,6 +1470,8 @@ bool solve_global_scene(struct SurviveContext *ctx, MPFITData *d, PoserDataGloba
 			}
 		}
 
+		update_global_prior(d, &mpfitctx, cameras, lh_meas, result.xerror);
+
 		PoserData_lighthouse_poses_func(0, mpfitctx.sos[0], cameras, 0, ctx->activeLighthouses,
 										&survive_optimizer_get_pose(&mpfitctx)[bestObjForCal]);
 
@@ -1091,6 +1596,12 @@ int PoserMPFIT(SurviveObject *so, void **user, PoserData *pd) {
 		g.stats.meas_failures += d->stats.meas_failures;
 		g.stats.total_iterations += d->stats.total_iterations;
 		g.stats.sum_origerrors += d->stats.sum_origerrors;
+		g.stats.budget_runs += d->stats.budget_runs;
+		g.stats.budget_terminated += d->stats.budget_terminated;
+		g.stats.budget_solve_time += d->stats.budget_solve_time;
+		g.stats.budget_max_solve_time = linmath_max(g.stats.budget_max_solve_time, d->stats.budget_max_solve_time);
+		g.stats.capped_runs += d->stats.capped_runs;
+		g.stats.capped_meas_cnt += d->stats.capped_meas_cnt;
 		for (int i = 0; i < sizeof(d->stats.status_cnts) / sizeof(int); i++) {
 			g.stats.status_cnts[i] += d->stats.status_cnts[i];
 		}
@@ -1109,6 +1620,7 @@ int PoserMPFIT(SurviveObject *so, void **user, PoserData *pd) {
 		survive_detach_config(ctx, "sensor-variance-per-sec", &d->sensor_variance_per_second);
 		survive_detach_config(ctx, "sensor-variance", &d->sensor_variance);
 		survive_async_free(d->async_optimizer);
+		survive_thread_pool_free(d->global_pool);
 		*user = 0;
 		free(d);
 		return 0;
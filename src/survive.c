@@ -2,6 +2,10 @@
 // Copyright 2016 <>< C. N. Lohr, FULLY Under MIT/x11 License.
 // All MIT/x11 Licensed Code in this file may be relicensed freely under the GPL or LGPL licenses.
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "survive_internal.h"
 #include <assert.h>
 #include <ctype.h>
@@ -13,9 +17,11 @@
 #include "stdarg.h"
 
 #include "os_generic.h"
+#include "survive_atomic.h"
 #include "survive_config.h"
 #include "survive_default_devices.h"
 #include "survive_kalman_lighthouses.h"
+#include "survive_lighthouse_cache.h"
 #include "survive_recording.h"
 
 #include <stdarg.h>
@@ -24,6 +30,14 @@
 #include <windows.h>
 #endif
 
+#ifdef __linux__
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define SURVIVE_HAS_REACTOR
+#endif
+
 #ifdef __APPLE__
 #define z_const const
 #endif
@@ -41,7 +55,14 @@ STATIC_CONFIG_ITEM(LIGHTHOUSE_GEN, "lighthouse-gen", 'i',
 				   "Which lighthouse gen to use -- 1 for LH1, 2 for LH2, 0 (default) for auto-detect", 0)
 STATIC_CONFIG_ITEM(OUTPUT_CALLBACK_STATS, "output-callback-stats", 'f',
 				   "Print cb stats every given number of seconds. 0 disables this output.", 0.);
+STATIC_CONFIG_ITEM(TRACE_FILE, "trace-file", 's',
+				   "Record spans of the pipeline and write them to this file, in Chrome trace format, on close.", "")
+STATIC_CONFIG_ITEM(LATENCY_REPORT, "latency-report", 'b',
+				   "Log hook and sensor-to-pose latency percentiles when closing.", 0)
+STATIC_CONFIG_ITEM(STARTUP_REPORT, "startup-report", 'b', "Log when each startup phase was reached when closing.", 0)
 STATIC_CONFIG_ITEM(THREADED_POSERS, "threaded-posers", 'b', "Whether or not to run each poser in their own thread.", 0)
+STATIC_CONFIG_ITEM(POLL_IDLE_MS, "poll-idle-ms", 'i',
+				   "Longest time survive_poll blocks waiting for events when no driver needs periodic polling.", 1000)
 
 STATIC_CONFIG_ITEM(LH_0_DISABLE, "lighthouse-0-disable", 'b', "Disable lh at idx 0", 0)
 STATIC_CONFIG_ITEM(LH_1_DISABLE, "lighthouse-1-disable", 'b', "Disable lh at idx 1", 0)
@@ -89,6 +110,7 @@ static void set_stderr_color(FILE *f, int c) {
 
 static void survive_default_report_error_process(struct SurviveContext *ctx, SurviveError errorCode) {
 	ctx->currentError = errorCode;
+	survive_wake_poll(ctx);
 }
 
 int survive_default_printf_process(struct SurviveContext *ctx, const char *format, ...) {
@@ -222,6 +244,7 @@ SURVIVE_EXPORT int8_t survive_get_bsd_idx(SurviveContext *ctx, survive_channel c
 			ctx->bsd[channel].mode = channel;
 			ctx->activeLighthouses++;
 			SV_INFO("Adding lighthouse ch %d (cnt: %d)", channel, ctx->activeLighthouses);
+			survive_lighthouse_cache_apply(ctx, channel);
 		}
 		return channel;
 	}
@@ -238,34 +261,390 @@ SURVIVE_EXPORT int8_t survive_get_bsd_idx(SurviveContext *ctx, survive_channel c
 				ctx->activeLighthouses = i + 1;
 			}
 			SV_INFO("Adding lighthouse ch %d (idx: %d, cnt: %d)", channel, i, ctx->activeLighthouses);
-			return ctx->bsd_map[channel] = i;
+			ctx->bsd_map[channel] = i;
+			survive_lighthouse_cache_apply(ctx, i);
+			return i;
 		}
 	}
 
 	return -1;
 }
 
+// Wait and hold time on the context lock, accumulated per call site and per thread
+struct survive_lock_timing {
+	uint32_t cnt;
+	uint64_t wait_ns, max_wait_ns;
+	uint64_t hold_ns, max_hold_ns;
+};
+
+#define SURVIVE_LOCK_STATS_MAX_SITES 128
+#define SURVIVE_LOCK_STATS_MAX_THREADS 32
+
+struct survive_lock_site {
+	const char *file;
+	int line;
+	struct survive_lock_timing timing;
+};
+
+struct survive_lock_thread {
+	const void *key;
+	char name[32];
+	struct survive_lock_timing timing;
+};
+
+struct survive_lock_stats {
+	// Set with --output-callback-stats; nothing is recorded otherwise
+	bool enabled;
+	og_mutex_t lock;
+	struct survive_lock_site sites[SURVIVE_LOCK_STATS_MAX_SITES];
+	size_t sites_cnt;
+	struct survive_lock_thread threads[SURVIVE_LOCK_STATS_MAX_THREADS];
+	size_t threads_cnt;
+
+	// Only touched by whoever holds the context lock
+	const char *holder_file;
+	int holder_line;
+	struct survive_lock_site *holder_site;
+	uint64_t holder_wait_ns, holder_acquired_ns;
+};
+
 struct SurviveContext_private {
 	og_sema_t poll_sema;
+	struct survive_lock_stats lock_stats;
 	survive_run_time_fn runTimeFn;
 	void *runTimeFnUser;
 	double lastRunTime;
 
 	double callbackStatsTimeBetween;
 	double lastCallbackStats;
+
+	// Reactor survive_poll blocks on; epoll_fd is -1 where it isn't available and survive_poll just sleeps.
+	int epoll_fd, wake_fd;
+	int wake_pending;
+	int poll_idle_ms;
+
+	// Whether this context started the trace, and so writes it out on close
+	bool trace_owner;
+	og_mutex_t poll_fds_lock;
+	struct survive_poll_fd *poll_fds;
+	size_t poll_fds_cnt;
+};
+
+struct survive_poll_fd {
+	int fd;
+	survive_poll_fd_fn fn;
+	void *user;
 };
 
-void survive_get_ctx_lock(SurviveContext *ctx) {
+static void survive_reactor_init(struct SurviveContext_private *pctx) {
+	pctx->epoll_fd = pctx->wake_fd = -1;
+	pctx->poll_fds_lock = OGCreateMutex();
+#ifdef SURVIVE_HAS_REACTOR
+	pctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	pctx->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (pctx->epoll_fd < 0 || pctx->wake_fd < 0) {
+		if (pctx->epoll_fd >= 0)
+			close(pctx->epoll_fd);
+		if (pctx->wake_fd >= 0)
+			close(pctx->wake_fd);
+		pctx->epoll_fd = pctx->wake_fd = -1;
+		return;
+	}
+
+	struct epoll_event ev = {.events = EPOLLIN, .data = {.fd = pctx->wake_fd}};
+	epoll_ctl(pctx->epoll_fd, EPOLL_CTL_ADD, pctx->wake_fd, &ev);
+#endif
+}
+
+static void survive_reactor_free(struct SurviveContext_private *pctx) {
+#ifdef SURVIVE_HAS_REACTOR
+	if (pctx->epoll_fd >= 0) {
+		close(pctx->epoll_fd);
+		close(pctx->wake_fd);
+	}
+#endif
+	OGDeleteMutex(pctx->poll_fds_lock);
+	free(pctx->poll_fds);
+}
+
+int survive_add_poll_fd(SurviveContext *ctx, int fd, int events, survive_poll_fd_fn fn, void *user) {
+#ifdef SURVIVE_HAS_REACTOR
+	struct SurviveContext_private *pctx = ctx->private_members;
+	if (pctx->epoll_fd < 0)
+		return -1;
+
+	OGLockMutex(pctx->poll_fds_lock);
+	pctx->poll_fds = SV_REALLOC(pctx->poll_fds, sizeof(struct survive_poll_fd) * (pctx->poll_fds_cnt + 1));
+	pctx->poll_fds[pctx->poll_fds_cnt++] = (struct survive_poll_fd){.fd = fd, .fn = fn, .user = user};
+	OGUnlockMutex(pctx->poll_fds_lock);
+
+	// POLLIN / POLLOUT share their values with EPOLLIN / EPOLLOUT
+	struct epoll_event ev = {.events = (uint32_t)events, .data = {.fd = fd}};
+	if (epoll_ctl(pctx->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		int err = errno;
+		SV_WARN("Could not add fd %d to the poll reactor: %s", fd, strerror(err));
+		survive_remove_poll_fd(ctx, fd);
+		return -err;
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+void survive_remove_poll_fd(SurviveContext *ctx, int fd) {
+#ifdef SURVIVE_HAS_REACTOR
+	struct SurviveContext_private *pctx = ctx->private_members;
+	if (pctx->epoll_fd < 0)
+		return;
+
+	epoll_ctl(pctx->epoll_fd, EPOLL_CTL_DEL, fd, 0);
+
+	OGLockMutex(pctx->poll_fds_lock);
+	for (size_t i = 0; i < pctx->poll_fds_cnt; i++) {
+		if (pctx->poll_fds[i].fd == fd) {
+			pctx->poll_fds[i] = pctx->poll_fds[--pctx->poll_fds_cnt];
+			break;
+		}
+	}
+	OGUnlockMutex(pctx->poll_fds_lock);
+#endif
+}
+
+void survive_wake_poll(SurviveContext *ctx) {
+#ifdef SURVIVE_HAS_REACTOR
+	struct SurviveContext_private *pctx = ctx->private_members;
+	if (pctx == 0 || pctx->wake_fd < 0)
+		return;
+
+	// Only the first wake between two polls needs to hit the eventfd
+	if (__atomic_exchange_n(&pctx->wake_pending, 1, __ATOMIC_ACQ_REL) == 0) {
+		uint64_t one = 1;
+		if (write(pctx->wake_fd, &one, sizeof(one)) < 0)
+			__atomic_store_n(&pctx->wake_pending, 0, __ATOMIC_RELEASE);
+	}
+#endif
+}
+
+#define SURVIVE_REACTOR_MAX_EVENTS 16
+
+/**
+ * Blocks for up to timeout_ms, returning early when a registered fd is ready or survive_wake_poll is called. Ready fds
+ * are written to `ready`. Called without the context lock held.
+ */
+static size_t survive_reactor_wait(struct SurviveContext_private *pctx, int timeout_ms,
+								   int ready[SURVIVE_REACTOR_MAX_EVENTS]) {
+#ifdef SURVIVE_HAS_REACTOR
+	if (pctx->epoll_fd >= 0) {
+		struct epoll_event events[SURVIVE_REACTOR_MAX_EVENTS];
+		int cnt = epoll_wait(pctx->epoll_fd, events, SURVIVE_REACTOR_MAX_EVENTS, timeout_ms);
+
+		size_t ready_cnt = 0;
+		for (int i = 0; i < cnt; i++) {
+			if (events[i].data.fd == pctx->wake_fd) {
+				uint64_t v;
+				if (read(pctx->wake_fd, &v, sizeof(v)) >= 0 || errno == EAGAIN)
+					__atomic_store_n(&pctx->wake_pending, 0, __ATOMIC_RELEASE);
+			} else {
+				ready[ready_cnt++] = events[i].data.fd;
+			}
+		}
+		return ready_cnt;
+	}
+#endif
+	if (timeout_ms > 0)
+		OGUSleep(timeout_ms * 1000);
+	return 0;
+}
+
+/** Runs the callbacks for the ready fds; called with the context lock held. */
+static int survive_reactor_dispatch(SurviveContext *ctx, const int *ready, size_t ready_cnt) {
+	struct SurviveContext_private *pctx = ctx->private_members;
+	for (size_t i = 0; i < ready_cnt; i++) {
+		struct survive_poll_fd entry = {.fd = -1};
+
+		// The fd may have been removed since epoll_wait returned
+		OGLockMutex(pctx->poll_fds_lock);
+		for (size_t j = 0; j < pctx->poll_fds_cnt; j++) {
+			if (pctx->poll_fds[j].fd == ready[i])
+				entry = pctx->poll_fds[j];
+		}
+		OGUnlockMutex(pctx->poll_fds_lock);
+
+		if (entry.fd >= 0) {
+			int r = entry.fn(ctx, entry.user, entry.fd);
+			if (r) {
+				SV_WARN("Poll fd %d reported %d", entry.fd, r);
+				return r;
+			}
+		}
+	}
+	return 0;
+}
+
+// Its address identifies the thread
+static SURVIVE_THREAD_LOCAL char lock_thread_key;
+
+static void survive_lock_timing_add(struct survive_lock_timing *t, uint64_t wait_ns, uint64_t hold_ns) {
+	t->cnt++;
+	t->wait_ns += wait_ns;
+	t->hold_ns += hold_ns;
+	if (wait_ns > t->max_wait_ns)
+		t->max_wait_ns = wait_ns;
+	if (hold_ns > t->max_hold_ns)
+		t->max_hold_ns = hold_ns;
+}
+
+static struct survive_lock_site *survive_lock_site(struct survive_lock_stats *stats, const char *file, int line) {
+	for (size_t i = 0; i < stats->sites_cnt; i++) {
+		if (stats->sites[i].line == line && stats->sites[i].file == file)
+			return &stats->sites[i];
+	}
+	if (stats->sites_cnt >= SURVIVE_LOCK_STATS_MAX_SITES)
+		return 0;
+
+	struct survive_lock_site *site = &stats->sites[stats->sites_cnt++];
+	*site = (struct survive_lock_site){.file = file, .line = line};
+	return site;
+}
+
+// The slot of the calling thread in the stats it last released the lock of
+static SURVIVE_THREAD_LOCAL struct survive_lock_stats *lock_thread_stats;
+static SURVIVE_THREAD_LOCAL struct survive_lock_thread *lock_thread;
+
+static struct survive_lock_timing *survive_lock_thread_timing(struct survive_lock_stats *stats) {
+	// The stats of a closed context can be at the address of a new one, so the slot itself is checked too
+	if (lock_thread_stats == stats && lock_thread && lock_thread < stats->threads + stats->threads_cnt &&
+		lock_thread->key == &lock_thread_key)
+		return &lock_thread->timing;
+
+	lock_thread_stats = stats;
+	lock_thread = 0;
+	for (size_t i = 0; i < stats->threads_cnt && lock_thread == 0; i++) {
+		if (stats->threads[i].key == &lock_thread_key)
+			lock_thread = &stats->threads[i];
+	}
+	if (lock_thread == 0 && stats->threads_cnt < SURVIVE_LOCK_STATS_MAX_THREADS) {
+		lock_thread = &stats->threads[stats->threads_cnt];
+		lock_thread->key = &lock_thread_key;
+#ifdef __linux__
+		if (pthread_getname_np(pthread_self(), lock_thread->name, sizeof(lock_thread->name)) != 0)
+#endif
+			snprintf(lock_thread->name, sizeof(lock_thread->name), "thread %d", (int)stats->threads_cnt);
+		stats->threads_cnt++;
+	}
+	return lock_thread ? &lock_thread->timing : 0;
+}
+
+void(survive_get_ctx_lock)(SurviveContext *ctx) { survive_get_ctx_lock_at(ctx, "unknown", 0); }
+
+void survive_get_ctx_lock_at(SurviveContext *ctx, const char *file, int line) {
 	struct SurviveContext_private *pctx = ctx->private_members;
 	// SV_VERBOSE(100, "Trying to get lock on %lx", pthread_self());
+	uint64_t start_ns = survive_latency_now_ns();
 	OGLockSema(pctx->poll_sema);
+	uint64_t acquired_ns = survive_latency_now_ns();
+	survive_trace_span("ctx lock wait", start_ns, acquired_ns - start_ns);
+
+	struct survive_lock_stats *stats = &pctx->lock_stats;
+	if (!stats->enabled)
+		return;
+
+	OGLockMutex(stats->lock);
+	stats->holder_site = survive_lock_site(stats, file, line);
+	OGUnlockMutex(stats->lock);
+
+	stats->holder_file = file;
+	stats->holder_line = line;
+	stats->holder_wait_ns = acquired_ns - start_ns;
+	stats->holder_acquired_ns = acquired_ns;
 	// SV_VERBOSE(100, "Got lock on %lx", pthread_self());
 }
 void survive_release_ctx_lock(SurviveContext *ctx) {
 	struct SurviveContext_private *pctx = ctx->private_members;
+	struct survive_lock_stats *stats = &pctx->lock_stats;
+	if (!stats->enabled) {
+		OGUnlockSema(pctx->poll_sema);
+		return;
+	}
+
+	uint64_t hold_ns = survive_latency_now_ns() - stats->holder_acquired_ns;
+	struct survive_lock_site *site = stats->holder_site;
+	const char *file = stats->holder_file;
+	int line = stats->holder_line;
+	uint64_t wait_ns = stats->holder_wait_ns;
+
 	// SV_VERBOSE(100, "Releasing lock on %lx", pthread_self());
 	OGUnlockSema(pctx->poll_sema);
 	// SV_VERBOSE(100, "Signaled on %lx", pthread_self());
+
+	OGLockMutex(stats->lock);
+	// The stats may have been output and reset while the lock was held; then the slot belongs to someone else now
+	if (site && site->file == file && site->line == line)
+		survive_lock_timing_add(&site->timing, wait_ns, hold_ns);
+	struct survive_lock_timing *thread = survive_lock_thread_timing(stats);
+	if (thread)
+		survive_lock_timing_add(thread, wait_ns, hold_ns);
+	OGUnlockMutex(stats->lock);
+}
+
+static int survive_lock_site_cmp(const void *a, const void *b) {
+	uint64_t ha = ((const struct survive_lock_site *)a)->timing.hold_ns;
+	uint64_t hb = ((const struct survive_lock_site *)b)->timing.hold_ns;
+	return ha < hb ? 1 : (ha > hb ? -1 : 0);
+}
+
+static int survive_lock_thread_cmp(const void *a, const void *b) {
+	uint64_t ha = ((const struct survive_lock_thread *)a)->timing.hold_ns;
+	uint64_t hb = ((const struct survive_lock_thread *)b)->timing.hold_ns;
+	return ha < hb ? 1 : (ha > hb ? -1 : 0);
+}
+
+static void survive_output_lock_timing(SurviveContext *ctx, const char *name, const struct survive_lock_timing *t) {
+	SV_VERBOSE(10, "\t%-40s cnt: %7u wait avg: %.4fms max: %.4fms hold avg: %.4fms max: %.4fms total: %.4fms", name,
+			   t->cnt, t->wait_ns * 1e-6 / t->cnt, t->max_wait_ns * 1e-6, t->hold_ns * 1e-6 / t->cnt,
+			   t->max_hold_ns * 1e-6, t->hold_ns * 1e-6);
+}
+
+// Logs and resets the lock stats, sorted so the code that holds the lock the longest comes first
+static void survive_output_lock_stats(SurviveContext *ctx) {
+	struct SurviveContext_private *pctx = ctx->private_members;
+	struct survive_lock_stats *stats = &pctx->lock_stats;
+	if (!stats->enabled)
+		return;
+
+	struct survive_lock_site sites[SURVIVE_LOCK_STATS_MAX_SITES];
+	struct survive_lock_thread threads[SURVIVE_LOCK_STATS_MAX_THREADS];
+	OGLockMutex(stats->lock);
+	size_t sites_cnt = stats->sites_cnt, threads_cnt = stats->threads_cnt;
+	memcpy(sites, stats->sites, sites_cnt * sizeof(sites[0]));
+	memcpy(threads, stats->threads, threads_cnt * sizeof(threads[0]));
+	stats->sites_cnt = 0;
+	for (size_t i = 0; i < threads_cnt; i++)
+		memset(&stats->threads[i].timing, 0, sizeof(stats->threads[i].timing));
+	OGUnlockMutex(stats->lock);
+
+	qsort(sites, sites_cnt, sizeof(sites[0]), survive_lock_site_cmp);
+	qsort(threads, threads_cnt, sizeof(threads[0]), survive_lock_thread_cmp);
+
+	SV_VERBOSE(10, "Context lock by call site:");
+	for (size_t i = 0; i < sites_cnt; i++) {
+		const char *file = sites[i].file;
+		const char *base = file;
+		for (const char *c = file; *c; c++) {
+			if (*c == '/' || *c == '\\')
+				base = c + 1;
+		}
+		char name[64];
+		snprintf(name, sizeof(name), "%s:%d", base, sites[i].line);
+		survive_output_lock_timing(ctx, name, &sites[i].timing);
+	}
+
+	SV_VERBOSE(10, "Context lock by thread:");
+	for (size_t i = 0; i < threads_cnt; i++) {
+		if (threads[i].timing.cnt)
+			survive_output_lock_timing(ctx, threads[i].name, &threads[i].timing);
+	}
 }
 
 static inline bool find_correct_config_file(struct SurviveContext *ctx, const char **config_prefix_fields) {
@@ -315,6 +694,7 @@ static bool disable_colorization = false;
 SurviveContext *survive_init_internal(int argc, char *const *argv, void *userData, log_process_func log_func) {
 	int i;
 
+	double init_time = OGGetAbsoluteTime();
 	survive_init_plugins();
 
 	SurviveContext *ctx = SV_CALLOC(sizeof(SurviveContext));
@@ -322,8 +702,12 @@ SurviveContext *survive_init_internal(int argc, char *const *argv, void *userDat
 	ctx->poll_min_time_ms = 10;
 
 	struct SurviveContext_private *pctx = ctx->private_members = SV_CALLOC(sizeof(struct SurviveContext_private));
+	survive_startup_profile_init(ctx, init_time);
+	survive_startup_mark(ctx, survive_startup_phase_plugins_loaded);
 
 	pctx->poll_sema = OGCreateSema();
+	pctx->lock_stats.lock = OGCreateMutex();
+	survive_reactor_init(pctx);
 
 	for (int i = 0; i < NUM_GEN2_LIGHTHOUSES; i++) {
 		ctx->bsd[i].mode = -1;
@@ -443,6 +827,7 @@ SurviveContext *survive_init_internal(int argc, char *const *argv, void *userDat
 		SV_INFO("Initial config file is %s", init_config);
 	}
 	config_read(ctx, config_path);
+	survive_startup_mark(ctx, survive_startup_phase_config_read);
 	SV_VERBOSE(5, "libsurvive version %s (backend %s)", survive_build_tag(), cnMatrixBackend());
 	SV_VERBOSE(5, "Config file is %.512s", config_path);
 
@@ -465,6 +850,21 @@ SurviveContext *survive_init_internal(int argc, char *const *argv, void *userDat
 	ctx->activeLighthouses = 0;
 
 	pctx->callbackStatsTimeBetween = survive_configf(ctx, "output-callback-stats", SC_GET, 0.0);
+	pctx->lock_stats.enabled = pctx->callbackStatsTimeBetween != 0.;
+	// The histograms are only ever read by the callback stats and the latency report
+	ctx->latency_enabled =
+		pctx->callbackStatsTimeBetween != 0. || survive_configi(ctx, LATENCY_REPORT_TAG, SC_GET, 0);
+	pctx->poll_idle_ms = survive_configi(ctx, POLL_IDLE_MS_TAG, SC_GET, 1000);
+
+	const char *trace_file = survive_configs(ctx, TRACE_FILE_TAG, SC_GET, "");
+	if (trace_file && *trace_file) {
+		pctx->trace_owner = survive_trace_start(trace_file);
+		if (pctx->trace_owner) {
+			SV_INFO("Tracing to %s", trace_file);
+		} else {
+			SV_WARN("Could not start tracing to %s; a trace is already running", trace_file);
+		}
+	}
 
 	for (int i = 0; i < NUM_GEN2_LIGHTHOUSES; i++) {
 		if (config_read_lighthouse(ctx->lh_config, &(ctx->bsd[i]), i)) {
@@ -483,6 +883,13 @@ SurviveContext *survive_init_internal(int argc, char *const *argv, void *userDat
 		survive_kalman_lighthouse_init(ctx->bsd[i].tracker, ctx, i);
 	};
 
+	survive_lighthouse_cache_load(ctx);
+
+	// Listing drivers and config items needs every plugin, not just the ones this configuration would load
+	if (list_for_autocomplete || showhelp) {
+		survive_load_all_plugins();
+	}
+
 	if( list_for_autocomplete )
 	{
 		const char * lastparam = (autocomplete_match[2]==0)?autocomplete_match[1]:autocomplete_match[2];
@@ -547,22 +954,34 @@ survive_driver_fn GetDriverByConfig(SurviveContext *ctx, const char *name, const
 									const char *configdef) {
 	const char *Preferred = survive_configs(ctx, configname, SC_SETCONFIG, configdef);
 	const char *DriverName = 0;
-	const char *picked = 0;
+	const char *picked = 0, *pickedName = 0;
 	int i = 0;
 	survive_driver_fn func = 0;
 	int prefixLen = strlen(name);
 
 	SV_VERBOSE(1, "Available %ss:", name);
 	while ((DriverName = GetDriverNameMatching(name, i++))) {
-		survive_driver_fn p = GetDriver(DriverName);
-
 		bool match = strcmp(DriverName, Preferred) == 0 || strcmp(DriverName + prefixLen, Preferred) == 0;
 		SV_VERBOSE(1, "\t%c%s", match ? '*' : ' ', DriverName + prefixLen);
-		if (!func || match) {
-			func = p;
+		if (!picked || match) {
+			pickedName = DriverName;
 			picked = (DriverName + prefixLen);
 		}
 	}
+
+	// Only the picked one is fetched, so that only its plugin gets loaded. If that fails, the others are tried in
+	// order.
+	func = GetDriver(pickedName);
+	for (int j = 0; !func && (DriverName = GetDriverNameMatching(name, j)); j++) {
+		if (strcmp(DriverName, pickedName) == 0)
+			continue;
+
+		func = GetDriver(DriverName);
+		if (func) {
+			SV_WARN("Could not load %s '%s'; using '%s' instead", name, picked, DriverName + prefixLen);
+			picked = DriverName + prefixLen;
+		}
+	}
 	if (!func) {
 		SV_WARN("Error.  Cannot find any valid %s.", name);
 		return 0;
@@ -593,6 +1012,9 @@ static inline SurviveDeviceDriverReturn callDriver(SurviveContext *ctx, const ch
 int survive_startup(SurviveContext *ctx) {
 	ctx->state = SURVIVE_RUNNING;
 
+	// Calibration can save the config many times a second from the processing threads; write it from the background
+	config_writer_start(ctx);
+
 	survive_install_recording(ctx);
 
 	// initialize the button queue
@@ -726,6 +1148,7 @@ int survive_startup(SurviveContext *ctx) {
 		SV_ERROR(SURVIVE_ERROR_NO_TRACKABLE_OBJECTS, "No trackable objects provided and no drivers are registered.");
 	}
 
+	survive_startup_mark(ctx, survive_startup_phase_drivers_started);
 	return 0;
 }
 datalog_process_func survive_default_datalog_process = 0;
@@ -769,6 +1192,7 @@ int survive_add_object(SurviveContext *ctx, SurviveObject *obj) {
 	ctx->objs = SV_REALLOC(ctx->objs, sizeof(SurviveObject *) * (oldct + 1));
 	ctx->objs[oldct] = obj;
 	ctx->objs_ct = oldct + 1;
+	survive_startup_mark_object(obj, survive_startup_object_phase_added);
 
 	SURVIVE_INVOKE_HOOK_SO(new_object, obj);
 
@@ -845,13 +1269,24 @@ void survive_add_driver(SurviveContext *ctx, void *payload, DeviceDriverCb poll,
 	ctx->driver_ct = oldct + 1;
 }
 struct survive_threaded_driver {
+	SurviveContext *ctx;
 	void *driver_data;
-	DeviceDriverCb thread_fn, close_fn;
+	void *(*routine)(void *);
+	DeviceDriverCb close_fn;
 
 	bool keep_running;
 	og_thread_t thread;
 };
 
+static void *threaded_driver_thread(void *_driver) {
+	struct survive_threaded_driver *driver = _driver;
+	void *rtn = driver->routine(driver->driver_data);
+
+	// survive_poll might be blocked waiting for events; let it notice that this driver stopped
+	survive_wake_poll(driver->ctx);
+	return rtn;
+}
+
 static int threaded_driver_poll(struct SurviveContext *ctx, void *_driver) {
 	struct survive_threaded_driver *driver = _driver;
 	if (driver->keep_running == false)
@@ -874,11 +1309,13 @@ static int threaded_driver_close(struct SurviveContext *ctx, void *_driver) {
 bool *survive_add_threaded_driver(SurviveContext *ctx, void *_driver, const char *name, void *(routine)(void *),
 								  DeviceDriverCb close) {
 	struct survive_threaded_driver *driver = SV_CALLOC(sizeof(struct survive_threaded_driver));
+	driver->ctx = ctx;
 	driver->driver_data = _driver;
+	driver->routine = routine;
 	driver->close_fn = close;
 
 	driver->keep_running = true;
-	driver->thread = OGCreateThread(routine, name, _driver);
+	driver->thread = OGCreateThread(threaded_driver_thread, name, driver);
 
 	survive_add_driver(ctx, driver, threaded_driver_poll, threaded_driver_close);
 	return &driver->keep_running;
@@ -893,16 +1330,23 @@ int survive_haptic(SurviveObject *so, FLT freq, FLT amp, FLT duration) {
 }
 
 void survive_output_callback_stats(SurviveContext *ctx) {
+	SurviveLatencySummary latency;
 	SV_VERBOSE(10, "Callback statistics:");
 #define SURVIVE_HOOK_PROCESS_DEF(hook)                                                                                 \
-	SV_VERBOSE(10, "\t%-20s cnt: %7d avg time: %.7fms max time: %.7fms cnt over 1ms: %5d(%.7f%%)", #hook,               \
-			   ctx->hook##_call_cnt, 1000. * ctx->hook##_call_time / (1e-5 + ctx->hook##_call_cnt),                    \
+	survive_latency_hook(ctx, survive_hook_id_##hook, &latency);                                                       \
+	SV_VERBOSE(10,                                                                                                     \
+			   "\t%-20s cnt: %7d avg time: %.7fms max time: %.7fms cnt over 1ms: %5d(%.7f%%) p50/p99/p99.9 since "     \
+			   "start: %.4f/%.4f/%.4fms",                                                                              \
+			   #hook, ctx->hook##_call_cnt, 1000. * ctx->hook##_call_time / (1e-5 + ctx->hook##_call_cnt),             \
 			   ctx->hook##_max_call_time * 1000., ctx->hook##_call_over_cnt,                                           \
-			   ctx->hook##_call_over_cnt / (FLT)(ctx->hook##_call_cnt + .0001));                                       \
+			   ctx->hook##_call_over_cnt / (FLT)(ctx->hook##_call_cnt + .0001), latency.p50 * 1000.,                   \
+			   latency.p99 * 1000., latency.p999 * 1000.);                                                             \
 	ctx->hook##_call_cnt = 0;                                                                                          \
 	ctx->hook##_max_call_time = ctx->hook##_call_time = 0.;                                                            \
 	ctx->hook##_call_over_cnt = 0;
 #include "survive_hooks.h"
+
+	survive_output_lock_stats(ctx);
 }
 
 void survive_close(SurviveContext *ctx) {
@@ -911,6 +1355,12 @@ void survive_close(SurviveContext *ctx) {
 
 	ctx->state = SURVIVE_CLOSING;
 
+	// Drivers may destroy their objects when closed, so this goes before anything is torn down
+	if (survive_configi(ctx, LATENCY_REPORT_TAG, SC_GET, 0))
+		survive_latency_dump(ctx);
+	if (survive_configi(ctx, STARTUP_REPORT_TAG, SC_GET, 0))
+		survive_startup_dump(ctx);
+
 	// unlock/ post to button service semaphore so the thread can kill itself
 	OGUnlockSema(ctx->buttonQueue.buttonservicesem);
 	OGJoinThread(ctx->buttonservicethread);
@@ -945,6 +1395,7 @@ void survive_close(SurviveContext *ctx) {
 	ctx->PoserFn = 0;
 
 	config_save(ctx);
+	config_writer_stop(ctx);
 
 	while (ctx->objs_ct) {
 		size_t objs_ct = ctx->objs_ct;
@@ -959,6 +1410,10 @@ void survive_close(SurviveContext *ctx) {
 	}
 
 	survive_output_callback_stats(ctx);
+	survive_latency_free(ctx->latency);
+	ctx->latency = 0;
+	survive_startup_profile_free(ctx);
+	survive_lighthouse_cache_free(ctx);
 
 	survive_destroy_recording(ctx);
 		
@@ -975,7 +1430,11 @@ void survive_close(SurviveContext *ctx) {
 	}
 
 	struct SurviveContext_private *pctx = ctx->private_members;
+	if (pctx->trace_owner)
+		survive_trace_stop(ctx);
 	OGDeleteSema(pctx->poll_sema);
+	OGDeleteMutex(pctx->lock_stats.lock);
+	survive_reactor_free(pctx);
 	free(pctx);
 
 	free(ctx->objs);
@@ -1008,6 +1467,9 @@ int survive_poll(struct SurviveContext *ctx) {
 
 	int oldct = ctx->driver_ct;
 
+	// Threaded drivers and drivers without a poll function do their work elsewhere; if those are all there are,
+	// survive_poll can block until an event arrives instead of waking up every poll_min_time_ms.
+	bool needs_periodic_poll = false;
 	for (i = 0; i < oldct; i++) {
 		if (ctx->driverpolls[i]) {
 			r = ctx->driverpolls[i](ctx, ctx->drivers[i]);
@@ -1015,19 +1477,26 @@ int survive_poll(struct SurviveContext *ctx) {
 				SV_WARN("Driver reported %d", r);
 				return r;
 			}
+			needs_periodic_poll |= ctx->driverpolls[i] != threaded_driver_poll;
 		}
 	}
 
-	survive_release_ctx_lock(ctx);
-	if (ctx->poll_min_time_ms > 0) {
+	struct SurviveContext_private *pctx = ctx->private_members;
+
+	int timeout_ms = pctx->poll_idle_ms;
+	if (needs_periodic_poll || timeout_ms <= 0) {
 		uint64_t timeNow = OGGetAbsoluteTimeMS();
-		if ((timeStart + ctx->poll_min_time_ms) > timeNow) {
-			uint64_t sleepTime = (timeStart + ctx->poll_min_time_ms) - timeNow;
-			OGUSleep(sleepTime * 1000);
-		}
+		uint64_t deadline = timeStart + ctx->poll_min_time_ms;
+		timeout_ms = deadline > timeNow ? (int)(deadline - timeNow) : 0;
+	}
+	if (pctx->callbackStatsTimeBetween != 0. && timeout_ms > pctx->callbackStatsTimeBetween * 1000.) {
+		timeout_ms = (int)(pctx->callbackStatsTimeBetween * 1000.);
 	}
 
-	struct SurviveContext_private *pctx = ctx->private_members;
+	survive_release_ctx_lock(ctx);
+	int ready[SURVIVE_REACTOR_MAX_EVENTS];
+	size_t ready_cnt = survive_reactor_wait(pctx, timeout_ms, ready);
+
 	if (pctx->callbackStatsTimeBetween != 0.) {
 		FLT now = OGRelativeTime();
 		if (pctx->lastCallbackStats + pctx->callbackStatsTimeBetween < now) {
@@ -1037,7 +1506,7 @@ int survive_poll(struct SurviveContext *ctx) {
 	}
 	survive_get_ctx_lock(ctx);
 
-	return 0;
+	return survive_reactor_dispatch(ctx, ready, ready_cnt);
 }
 
 struct SurviveObject *survive_get_so_by_name(struct SurviveContext *ctx, const char *name) {
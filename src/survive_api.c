@@ -319,6 +319,7 @@ SURVIVE_EXPORT SurviveSimpleContext *survive_simple_init_with_logger(int argc, c
 
 int survive_simple_stop_thread(SurviveSimpleContext *actx) {
 	actx->running = false;
+	survive_wake_poll(actx->ctx);
 	intptr_t error = (intptr_t)OGJoinThread(actx->thread);
 	actx->thread = 0;
 	if (error != 0) {
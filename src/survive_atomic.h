@@ -0,0 +1,50 @@
+#ifndef SURVIVE_ATOMIC_H
+#define SURVIVE_ATOMIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The few atomic operations the instrumentation needs, for gcc/clang and MSVC. Counters are relaxed; pointers are
+ * published with acquire/release. SURVIVE_ATOMIC_FENCE is a full barrier, for the rare handshake that needs one.
+ */
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SURVIVE_THREAD_LOCAL __declspec(thread)
+#define SURVIVE_ATOMIC_ADD32(p, v) _InterlockedExchangeAdd((volatile long *)(p), (long)(v))
+#define SURVIVE_ATOMIC_ADD64(p, v) _InterlockedExchangeAdd64((volatile __int64 *)(p), (__int64)(v))
+#define SURVIVE_ATOMIC_LOAD32(p) (*(volatile uint32_t *)(p))
+#define SURVIVE_ATOMIC_LOAD64(p) (*(volatile uint64_t *)(p))
+#define SURVIVE_ATOMIC_STORE32(p, v) _InterlockedExchange((volatile long *)(p), (long)(v))
+#define SURVIVE_ATOMIC_LOAD_PTR(p) (*(void *volatile *)(p))
+#define SURVIVE_ATOMIC_FENCE() _mm_mfence()
+static inline bool survive_atomic_cas64(uint64_t *p, uint64_t *expected, uint64_t v) {
+	uint64_t prior = _InterlockedCompareExchange64((volatile __int64 *)p, v, *expected);
+	bool rtn = prior == *expected;
+	*expected = prior;
+	return rtn;
+}
+// Returns the value *p held; the swap happened iff that is `expected`
+static inline void *survive_atomic_cas_ptr(void **p, void *expected, void *v) {
+	return _InterlockedCompareExchangePointer(p, v, expected);
+}
+#else
+#define SURVIVE_THREAD_LOCAL __thread
+#define SURVIVE_ATOMIC_ADD32(p, v) __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+#define SURVIVE_ATOMIC_ADD64(p, v) __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+#define SURVIVE_ATOMIC_LOAD32(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#define SURVIVE_ATOMIC_LOAD64(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#define SURVIVE_ATOMIC_STORE32(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define SURVIVE_ATOMIC_LOAD_PTR(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define SURVIVE_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+static inline bool survive_atomic_cas64(uint64_t *p, uint64_t *expected, uint64_t v) {
+	return __atomic_compare_exchange_n(p, expected, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+static inline void *survive_atomic_cas_ptr(void **p, void *expected, void *v) {
+	__atomic_compare_exchange_n(p, &expected, v, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	return expected;
+}
+#endif
+
+#endif
@@ -672,6 +672,7 @@ void _json_write_float_array(FILE *f, const char *tag, FLT *v, uint8_t count) {
 
 void write_config_group(FILE *f, config_group *cg, char *tag) {
 	uint16_t i = 0;
+	config_group_lock(cg);
 
 	if (tag != NULL) {
 		fprintf(f, "\"%s\":{\n", tag);
@@ -696,11 +697,15 @@ void write_config_group(FILE *f, config_group *cg, char *tag) {
 	if (tag != NULL) {
 		fprintf(f, "}\n");
 	}
+
+	config_group_unlock(cg);
 }
 
 const char *survive_config_file_path(struct SurviveContext *ctx, char *path) {
-	const char *configpath = survive_config_file_name(ctx);
+	return survive_config_resolve_path(survive_config_file_name(ctx), path);
+}
 
+const char *survive_config_resolve_path(const char *configpath, char *path) {
 	if (isalpha(configpath[0])) {
 		size_t idx = 0;
 
@@ -745,18 +750,74 @@ const char *survive_config_file_path(struct SurviveContext *ctx, char *path) {
 
 // struct SurviveContext
 SurviveContext *survive_context;
-void config_save(SurviveContext *ctx) {
+
+STATIC_CONFIG_ITEM(CONFIG_SAVE_INTERVAL, "config-save-interval", 'f',
+				   "Minimum seconds between writes of the config file; saves in between are coalesced and written by a "
+				   "background thread. 0 writes synchronously on every save.",
+				   1.)
+
+// Files the writer thread keeps up to date; the config file and the lighthouse cache
+#define CONFIG_WRITER_MAX_FILES 4
+
+struct SurviveConfigWriter {
+	og_mutex_t lock;
+	og_cv_t save_requested;
+	og_thread_t thread;
+	bool running;
+
+	FLT interval;
+	double last_write;
+	struct {
+		config_write_fn write;
+		uint32_t requested, written;
+		uint32_t writes;
+	} files[CONFIG_WRITER_MAX_FILES];
+	int files_cnt;
+};
+
+static bool replace_file(const char *tmp_path, const char *path) {
+#ifdef _WIN32
+	return MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(tmp_path, path) == 0;
+#endif
+}
+
+FILE *config_replace_begin(const char *path, char *tmp_path) {
+	// Write to a temporary file and move it over the real one, so a crash mid-write never leaves a truncated one.
+	// Things like /dev/null are written to in place.
+	struct stat st;
+	bool in_place = stat(path, &st) == 0 && (st.st_mode & S_IFMT) != S_IFREG;
+	snprintf(tmp_path, FILENAME_MAX + 8, in_place ? "%s" : "%s.tmp", path);
+	return fopen(tmp_path, "w");
+}
+
+bool config_replace_end(FILE *f, const char *tmp_path, const char *path) {
+	bool ok = !ferror(f);
+	ok &= fclose(f) == 0;
+	if (strcmp(tmp_path, path) == 0)
+		return ok;
+
+	if (!ok || !replace_file(tmp_path, path)) {
+		remove(tmp_path);
+		return false;
+	}
+	return true;
+}
+
+void config_save_now(SurviveContext *ctx) {
 	char path[FILENAME_MAX] = "";
 	survive_config_file_path(ctx, path);
 
-	FILE *f = fopen(path, "w");
+	char tmp_path[FILENAME_MAX + 8] = "";
+	FILE *f = config_replace_begin(path, tmp_path);
 
 	if (f == 0) {
 		static bool warnedOnce = false;
 		if (!warnedOnce && strcmp(path, "/dev/null") != 0) {
 			SV_WARN("Could not open '%.512s' for writing; settings and calibration will not persist. This typically "
 					"happens if the path doesn't exist or root owns the file.",
-					path);
+					tmp_path);
 			warnedOnce = true;
 		}
 		return;
@@ -772,9 +833,124 @@ void config_save(SurviveContext *ctx) {
 		}
 	}
 
-	fclose(f);
+	if (!config_replace_end(f, tmp_path, path)) {
+		SV_WARN("Could not write config file '%.512s'; it was left unchanged", path);
+	}
+}
+
+static bool config_writer_pending(const struct SurviveConfigWriter *w) {
+	for (int i = 0; i < w->files_cnt; i++) {
+		if (w->files[i].requested != w->files[i].written)
+			return true;
+	}
+	return false;
+}
+
+static void *config_writer_thread(void *param) {
+	SurviveContext *ctx = param;
+	struct SurviveConfigWriter *w = ctx->config_writer;
+
+	OGLockMutex(w->lock);
+	while (w->running) {
+		if (!config_writer_pending(w)) {
+			OGWaitCond(w->save_requested, w->lock);
+			continue;
+		}
+
+		// Everything requested until the interval since the last write is over goes into the next write
+		double wait = w->last_write + w->interval - OGGetAbsoluteTime();
+		if (wait > 0) {
+			OGWaitCondTimeout(w->save_requested, w->lock, (int)(wait * 1000.) + 1);
+			continue;
+		}
+
+		for (int i = 0; i < w->files_cnt; i++) {
+			uint32_t requested = w->files[i].requested;
+			if (requested == w->files[i].written)
+				continue;
+
+			OGUnlockMutex(w->lock);
+			w->files[i].write(ctx);
+			OGLockMutex(w->lock);
+
+			w->files[i].written = requested;
+			w->files[i].writes++;
+		}
+		w->last_write = OGGetAbsoluteTime();
+	}
+	OGUnlockMutex(w->lock);
+	return 0;
+}
+
+void config_writer_start(SurviveContext *ctx) {
+	FLT interval = survive_configf(ctx, CONFIG_SAVE_INTERVAL_TAG, SC_GET, 1.);
+	if (ctx->config_writer || interval <= 0)
+		return;
+
+	struct SurviveConfigWriter *w = SV_CALLOC(sizeof(struct SurviveConfigWriter));
+	w->lock = OGCreateMutex();
+	w->save_requested = OGCreateConditionVariable();
+	w->running = true;
+	w->interval = interval;
+	ctx->config_writer = w;
+
+	w->thread = OGCreateThread(config_writer_thread, "config writer", ctx);
+}
+
+void config_writer_stop(SurviveContext *ctx) {
+	struct SurviveConfigWriter *w = ctx->config_writer;
+	if (w == 0)
+		return;
+
+	OGLockMutex(w->lock);
+	w->running = false;
+	OGSignalCond(w->save_requested);
+	OGUnlockMutex(w->lock);
+	OGJoinThread(w->thread);
+
+	ctx->config_writer = 0;
+	for (int i = 0; i < w->files_cnt; i++) {
+		if (w->files[i].requested != w->files[i].written) {
+			w->files[i].write(ctx);
+			w->files[i].writes++;
+		}
+		SV_VERBOSE(10, "Config writer %d wrote %u times for %u save requests", i, w->files[i].writes,
+				   w->files[i].requested);
+	}
+
+	OGDeleteConditionVariable(w->save_requested);
+	OGDeleteMutex(w->lock);
+	free(w);
+}
+
+void config_request_write(SurviveContext *ctx, config_write_fn write) {
+	struct SurviveConfigWriter *w = ctx->config_writer;
+	if (w == 0) {
+		write(ctx);
+		return;
+	}
+
+	OGLockMutex(w->lock);
+	int i = 0;
+	while (i < w->files_cnt && w->files[i].write != write)
+		i++;
+	if (i == CONFIG_WRITER_MAX_FILES) {
+		OGUnlockMutex(w->lock);
+		write(ctx);
+		return;
+	}
+	if (i == w->files_cnt) {
+		w->files[i].write = write;
+		w->files_cnt++;
+	}
+
+	w->files[i].requested++;
+	OGSignalCond(w->save_requested);
+	OGUnlockMutex(w->lock);
 }
 
+void config_save(SurviveContext *ctx) { config_request_write(ctx, config_save_now); }
+
 void print_json_value(char *tag, char **values, uint16_t count) {
 	uint16_t i = 0;
 	for (i = 0; i < count; ++i) {
@@ -785,15 +961,20 @@ void print_json_value(char *tag, char **values, uint16_t count) {
 config_group *cg_stack[10]; // handle 10 nested objects deep
 uint8_t cg_stack_head = 0;
 
+// Groups the file being read is loaded into
+static config_group *read_global_group;
+static config_group *read_lh_groups;
+static int read_lh_group_cnt;
+
 void handle_config_group(struct json_callbacks *cbs, struct json_stack_entry_s *obj) {
 	cg_stack_head++;
 	int lh_idx;
 
 	int lhMatch = sscanf(json_stack_tag(obj), "lighthouse%d", &lh_idx);
-	if (lhMatch == 1) {
-		cg_stack[cg_stack_head] = survive_context->lh_config + lh_idx;
+	if (lhMatch == 1 && lh_idx >= 0 && lh_idx < read_lh_group_cnt) {
+		cg_stack[cg_stack_head] = read_lh_groups + lh_idx;
 	} else {
-		cg_stack[cg_stack_head] = survive_context->global_config_values;
+		cg_stack[cg_stack_head] = read_global_group;
 	}
 }
 
@@ -891,16 +1072,15 @@ void handle_tag_value(struct json_callbacks *cbs, struct json_stack_entry_s *arr
 	//	else if (count>1) config_set_str
 }
 
-void config_read(SurviveContext *sctx, const char *init_path) {
+void config_read_groups(SurviveContext *sctx, const char *path, config_group *global, config_group *lh_groups,
+						int lh_group_cnt) {
 	survive_context = sctx;
 
-	char path[FILENAME_MAX] = "";
-	if (init_path) {
-		strncpy(path, init_path, FILENAME_MAX - 1);
-	} else {
-		survive_config_file_path(sctx, path);
-	}
-	cg_stack[0] = sctx->global_config_values;
+	read_global_group = global;
+	read_lh_groups = lh_groups;
+	read_lh_group_cnt = lh_group_cnt;
+
+	cg_stack[0] = global;
 	struct json_callbacks cbs = {.json_begin_object = handle_config_group,
 								 .json_end_object = pop_config_group,
 								 .json_tag_value = handle_tag_value,
@@ -909,6 +1089,16 @@ void config_read(SurviveContext *sctx, const char *init_path) {
 	json_load_file(&cbs, path);
 }
 
+void config_read(SurviveContext *sctx, const char *init_path) {
+	char path[FILENAME_MAX] = "";
+	if (init_path) {
+		strncpy(path, init_path, FILENAME_MAX - 1);
+	} else {
+		survive_config_file_path(sctx, path);
+	}
+	config_read_groups(sctx, path, sctx->global_config_values, sctx->lh_config, NUM_GEN2_LIGHTHOUSES);
+}
+
 static config_entry *sc_search(SurviveContext *ctx, const char *tag) {
 	if (ctx == 0) {
 		return 0;
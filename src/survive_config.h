@@ -60,7 +60,26 @@ void config_set_lighthouse(config_group* lh_config, BaseStationData* bsd, uint8_
 bool config_read_lighthouse(config_group *lh_config, BaseStationData *bsd, uint8_t idx);
 
 void config_read(SurviveContext* sctx, const char* path);
+// Reads a file in the config format; "lighthouseN" groups go to lh_groups[N], everything else into global
+void config_read_groups(SurviveContext *sctx, const char *path, config_group *global, config_group *lh_groups,
+						int lh_group_cnt);
+// Requests the config file to be written. Once config_writer_start ran this only wakes the writer thread, which
+// coalesces requests so the file is written at most once per "config-save-interval".
 void config_save(SurviveContext *ctx);
+// Writes the config file right away, replacing it atomically
+void config_save_now(SurviveContext *ctx);
+
+typedef void (*config_write_fn)(SurviveContext *ctx);
+// Like config_save, for any file `write` rewrites whole. Requests are coalesced per `write`.
+void config_request_write(SurviveContext *ctx, config_write_fn write);
+// Opens a temporary file next to `path` (tmp_path needs FILENAME_MAX + 8 chars); config_replace_end closes it and
+// moves it over `path`. Returns false, leaving `path` unchanged, if anything failed.
+FILE *config_replace_begin(const char *path, char *tmp_path);
+bool config_replace_end(FILE *f, const char *tmp_path, const char *path);
+void config_writer_start(SurviveContext *ctx);
+// Stops the writer thread, writing out any save it still had pending
+void config_writer_stop(SurviveContext *ctx);
+void write_config_group(FILE *f, config_group *cg, char *tag);
 
 FLT config_set_float(config_group *cg, const char *tag, FLT value);
 uint32_t config_set_uint32(config_group *cg, const char *tag, uint32_t value);
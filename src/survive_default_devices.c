@@ -688,5 +688,7 @@ void survive_destroy_device(SurviveObject *so) {
 	free(so->sensor_normals);
 	free(so->conf);
 	free(so->channel_map);
+	survive_latency_free(so->latency);
+	free(so->startup);
 	free(so);
 }
@@ -19,17 +19,32 @@ void RegisterDriver(const char *element, survive_driver_fn data) {
 
 void RegisterPoserDriver(const char *element, PoserCB poser) { RegisterDriver(element, (survive_driver_fn)poser); }
 
-survive_driver_fn GetDriver(const char *element) {
-	int i;
+static survive_driver_fn FindRegisteredDriver(const char *element) {
+	for (int i = 0; i < NrDrivers; i++) {
+		if (strcmp(element, DriverNames[i]) == 0)
+			return Drivers[i];
+	}
+	return 0;
+}
 
+survive_driver_fn GetDriver(const char *element) {
 	if (element == 0)
 		return 0;
 
-	for (i = 0; i < NrDrivers; i++) {
-		if (strcmp(element, DriverNames[i]) == 0)
-			return Drivers[i];
+	survive_driver_fn rtn = FindRegisteredDriver(element);
+	// Plugins listed in a manifest only register their drivers once loaded
+	if (rtn == 0 && survive_load_plugin_providing(element))
+		rtn = FindRegisteredDriver(element);
+	return rtn;
+}
+
+static bool IsManifestName(const char *element) {
+	const char *name;
+	for (int i = 0; (name = survive_plugin_provided_name(i)); i++) {
+		if (strcmp(element, name) == 0)
+			return true;
 	}
-	return 0;
+	return false;
 }
 
 survive_driver_fn GetDriverWithPrefix(const char *prefix, const char *name) {
@@ -44,23 +59,30 @@ survive_driver_fn GetDriverWithPrefix(const char *prefix, const char *name) {
 	}
 
 	while ((DriverName = GetDriverNameMatching(prefix, i++))) {
-		survive_driver_fn p = GetDriver(DriverName);
-
 		bool match = strcmp(DriverName, name) == 0 || (strcmp(DriverName + prefixLen, name) == 0);
 		if (match) {
-			return p;
+			return GetDriver(DriverName);
 		}
 	}
 
 	return 0;
 }
 
+// Names from the plugin manifest come first, loaded or not, so that loading a plugin while iterating doesn't reorder
+// what is left to iterate
 const char *GetDriverNameMatching(const char *prefix, int place) {
 	int i;
 	int prefixlen = (int)strlen(prefix);
+	const char *name;
+
+	for (i = 0; (name = survive_plugin_provided_name(i)); i++) {
+		if (strncmp(prefix, name, prefixlen) == 0)
+			if (0 == (place--))
+				return name;
+	}
 
 	for (i = 0; i < NrDrivers; i++) {
-		if (strncmp(prefix, DriverNames[i], prefixlen) == 0)
+		if (strncmp(prefix, DriverNames[i], prefixlen) == 0 && !IsManifestName(DriverNames[i]))
 			if (0 == (place--))
 				return DriverNames[i];
 	}
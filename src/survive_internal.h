@@ -15,6 +15,8 @@
 
 SURVIVE_EXPORT const char *survive_config_file_name(struct SurviveContext *ctx);
 SURVIVE_EXPORT const char *survive_config_file_path(struct SurviveContext *ctx, char *path);
+// Resolves a relative file name into the config directory, the same way the config file is
+SURVIVE_EXPORT const char *survive_config_resolve_path(const char *name, char *path);
 SURVIVE_EXPORT survive_driver_fn GetDriver(const char *name);
 SURVIVE_EXPORT const char * GetDriverNameMatching( const char * prefix, int place );
 SURVIVE_EXPORT survive_driver_fn GetDriverWithPrefix(const char *prefix, const char *name);
@@ -23,6 +25,16 @@ SURVIVE_EXPORT survive_driver_fn GetDriverByConfig(SurviveContext *ctx, const ch
 												   const char *configdef);
 
 void survive_load_plugins(const char *additional_plugin_dir);
+// Loads the plugin that the plugin manifest lists as registering `name`; false if there is none or it failed to load
+bool survive_load_plugin_providing(const char *name);
+// 1 if the plugin the plugin manifest lists as registering `name` is loaded, 0 if not; -1 if no manifest lists it
+SURVIVE_EXPORT int survive_plugin_loaded_for(const char *name);
+// Names the plugin manifest lists, whether or not their plugin is loaded yet; 0 past the end
+const char *survive_plugin_provided_name(int place);
+// Loads every plugin in the manifest, for when all drivers and config items have to be known
+void survive_load_all_plugins();
+// Logs which plugins were loaded and how long each took
+void survive_plugins_dump(SurviveContext *ctx);
 typedef double (*survive_run_time_fn)(const SurviveContext *ctx, void *user);
 SURVIVE_EXPORT void survive_install_run_time_fn(SurviveContext *ctx, survive_run_time_fn fn, void *user);
 
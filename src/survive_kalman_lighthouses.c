@@ -10,6 +10,9 @@ STRUCT_CONFIG_SECTION(SurviveKalmanLighthouse)
 STRUCT_CONFIG_ITEM("lh-light-variance", "", -1e-2, t->light_variance);
 STRUCT_CONFIG_ITEM("lh-light-stationary-time", "", .1, t->light_stationary_mintime);
 STRUCT_CONFIG_ITEM("lh-light-stationary-maxtime", "", 2, t->light_stationary_maxtime);
+STRUCT_CONFIG_ITEM("lh-light-batch-time",
+				   "Seconds of light, from all objects, stacked into one lighthouse update. 0 updates on every pulse.", 0,
+				   t->light_batch_time);
 END_STRUCT_CONFIG_SECTION(SurviveKalmanLighthouse)
 
 //#define TRACK_IN_WORLD2LH
@@ -45,11 +48,7 @@ void survive_kalman_lighthouse_report(SurviveKalmanLighthouse *tracker) {
 
 struct map_light_data_ctx {
 	SurviveKalmanLighthouse *tracker;
-	SurviveObject *so;
-
-	LightInfo savedLight[32];
-	uint32_t savedLight_idx;
-	SurvivePose objectPose;
+	const SurviveKalmanLighthouseObservation *obs;
 };
 
 static inline int get_axis(const struct PoserDataLight *pdl) {
@@ -69,9 +68,7 @@ static bool map_light_data(void *user, const struct CnMat *Z, const struct CnMat
 						   struct CnMat *H_k) {
 	struct map_light_data_ctx *cbctx = (struct map_light_data_ctx *)user;
 	const SurviveKalmanLighthouse *tracker = cbctx->tracker;
-
-	SurviveObject *so = cbctx->so;
-	struct SurviveContext *ctx = so->ctx;
+	struct SurviveContext *ctx = tracker->ctx;
 	const survive_reproject_model_t *mdl = survive_reproject_model(ctx);
 
 	if (H_k) {
@@ -88,15 +85,17 @@ static bool map_light_data(void *user, const struct CnMat *Z, const struct CnMat
 	const SurvivePose world2lh = InvertPoseRtn(&lh2world);
 	gen_invert_pose_jac_obj_p(inv_jacobian_row_ordered.data, &lh2world);
 #endif
+	// The lighthouse side of the projection is shared by every row; each row brings its own object and pose
 	CN_CREATE_STACK_MAT(jacobian, 1, 7);
 	for (int i = 0; i < Z->rows; i++) {
-		const LightInfo *info = &cbctx->savedLight[i];
+		SurviveObject *so = cbctx->obs[i].so;
+		const LightInfo *info = &cbctx->obs[i].light;
 		int axis = info->axis;
 
 		survive_reproject_full_xy_fn_t project_fn = mdl->reprojectAxisFullFn[axis];
 		survive_reproject_axis_jacob_lh_pose_fn_t project_jacob_fn = mdl->reprojectAxisJacobLhPoseFn[axis];
 
-		const SurvivePose obj2world = cbctx->objectPose;
+		const SurvivePose obj2world = cbctx->obs[i].obj2world;
 
 		const FLT *ptInObj = &so->sensor_locations[info->sensor_idx * 3];
 		FLT h_x = project_fn(&obj2world, ptInObj, &world2lh, &ctx->bsd[info->lh].fcal[axis]);
@@ -128,43 +127,104 @@ static bool map_light_data(void *user, const struct CnMat *Z, const struct CnMat
 void survive_kalman_lighthouse_integrate_light(SurviveKalmanLighthouse *tracker, SurviveObject *so,
 											   PoserDataLight *data) {
 	bool isSync = data->hdr.pt == POSERDATA_SYNC || data->hdr.pt == POSERDATA_SYNC_GEN2;
-	if (isSync || tracker == 0 || tracker->light_variance < 0 || !tracker->ctx->bsd[tracker->lh].PositionSet)
+	if (tracker == 0 || tracker->light_variance < 0)
+		return;
+
+	// Syncs keep coming while no object passes the checks below, so they make sure a batch doesn't sit around
+	if (isSync) {
+		survive_kalman_lighthouse_flush_expired(tracker);
 		return;
+	}
+
+	// Light batched against a lighthouse pose that has since been reset is no use anymore
+	if (!tracker->ctx->bsd[tracker->lh].PositionSet) {
+		tracker->batch.cnt = 0;
+		return;
+	}
 
 	FLT stationary_time = SurviveSensorActivations_stationary_time(&so->activations) / (FLT)so->timebase_hz;
 	SurviveContext *ctx = tracker->ctx;
-	FLT time = data->hdr.timecode / (FLT)so->timebase_hz;
 	if (stationary_time < tracker->light_stationary_mintime)
 		return;
 	if (stationary_time > tracker->light_stationary_maxtime && tracker->light_stationary_maxtime > 0)
 		return;
 
 	if (tracker->light_variance >= 0) {
-		CN_CREATE_STACK_MAT(Z, 1, 1);
-
-		cnMatrixSet(&Z, 0, 0, data->angle);
-		struct map_light_data_ctx cbctx = {
-			.tracker = tracker,
+		SurviveKalmanLighthouseObservation obs = {
 			.so = so,
-			.savedLight_idx = 1,
-			.savedLight = {
-				{.lh = data->lh, .axis = get_axis(data), .sensor_idx = data->sensor_id, .value = data->angle}}};
+			.light = {.lh = data->lh, .axis = get_axis(data), .sensor_idx = data->sensor_id, .value = data->angle}};
 
-		survive_kalman_tracker_predict(so->tracker, 0, &cbctx.objectPose);
-		if (quatiszero(cbctx.objectPose.Rot))
+		survive_kalman_tracker_predict(so->tracker, 0, &obs.obj2world);
+		if (quatiszero(obs.obj2world.Rot))
 			return;
 
 		FLT so_var[3];
 		cn_get_diag(&so->tracker->model.P, so_var, 3);
-		FLT v = tracker->light_variance + norm3d(so_var);
+		obs.variance = tracker->light_variance + norm3d(so_var);
+
+		// Object timecodes don't share a timebase, so the batch window and the filter time are kept in run time
+		FLT now = survive_run_time(ctx);
+		if (tracker->batch.cnt == 0)
+			tracker->batch.start_time = now;
+		tracker->batch.obs[tracker->batch.cnt++] = obs;
+		tracker->batch.last_time = now;
+
+		if (tracker->batch.cnt == SURVIVE_KALMAN_LIGHTHOUSE_BATCH_MAX ||
+			now - tracker->batch.start_time >= tracker->light_batch_time) {
+			survive_kalman_lighthouse_flush_light(tracker);
+		}
+	}
+}
+
+/**
+ * All batched light goes in as one measurement update with a row per observation; the lighthouse pose inversion and
+ * its jacobian are worked out once, and the covariance is only updated once for the whole batch instead of once per
+ * pulse per object.
+ */
+void survive_kalman_lighthouse_flush_light(SurviveKalmanLighthouse *tracker) {
+	if (tracker == 0 || tracker->batch.cnt == 0)
+		return;
+
+	size_t cnt = tracker->batch.cnt;
+	tracker->batch.cnt = 0;
+	if (!tracker->ctx->bsd[tracker->lh].PositionSet)
+		return;
 
-		FLT light_vars[32] = {0};
-		for (int i = 0; i < 32; i++)
-			light_vars[i] = v;
-		CnMat R = cnVec(Z.rows, light_vars);
+	CN_CREATE_STACK_MAT(Z, cnt, 1);
+	FLT light_vars[SURVIVE_KALMAN_LIGHTHOUSE_BATCH_MAX];
+	for (size_t i = 0; i < cnt; i++) {
+		cnMatrixSet(&Z, i, 0, tracker->batch.obs[i].light.value);
+		light_vars[i] = tracker->batch.obs[i].variance;
+	}
+	CnMat R = cnVec(cnt, light_vars);
+
+	struct map_light_data_ctx cbctx = {.tracker = tracker, .obs = tracker->batch.obs};
+
+	uint64_t trace_start = survive_trace_begin();
+	cnkalman_meas_model_predict_update(tracker->batch.last_time, &tracker->lightcap_model, &cbctx, &Z, &R);
+	survive_trace_end("kalman lighthouse update", trace_start);
+
+	tracker->stats.updates++;
+	tracker->stats.observations += cnt;
+	survive_kalman_lighthouse_report(tracker);
+	CN_FREE_STACK_MAT(Z);
+}
+
+void survive_kalman_lighthouse_flush_expired(SurviveKalmanLighthouse *tracker) {
+	if (tracker == 0 || tracker->batch.cnt == 0)
+		return;
+	if (survive_run_time(tracker->ctx) - tracker->batch.start_time >= tracker->light_batch_time)
+		survive_kalman_lighthouse_flush_light(tracker);
+}
 
-		cnkalman_meas_model_predict_update(time, &tracker->lightcap_model, &cbctx, &Z, &R);
-		survive_kalman_lighthouse_report(tracker);
+void survive_kalman_lighthouse_remove_object(SurviveKalmanLighthouse *tracker, const SurviveObject *so) {
+	if (tracker == 0)
+		return;
+	for (size_t i = 0; i < tracker->batch.cnt; i++) {
+		if (tracker->batch.obs[i].so == so) {
+			survive_kalman_lighthouse_flush_light(tracker);
+			return;
+		}
 	}
 }
 
@@ -272,6 +332,14 @@ SURVIVE_EXPORT void survive_kalman_lighthouse_integrate_observation(SurviveKalma
 	survive_kalman_lighthouse_report(tracker);
 }
 void survive_kalman_lighthouse_free(SurviveKalmanLighthouse *tracker) {
+	SurviveContext *ctx = tracker->ctx;
+	// Objects flush what they contributed when they are removed, so whatever is left only refers to live ones
+	survive_kalman_lighthouse_flush_light(tracker);
+	if (tracker->stats.updates) {
+		SV_VERBOSE(10, "LH%d light updates: %u, %.1f observations per update", tracker->lh, tracker->stats.updates,
+				   tracker->stats.observations / (FLT)tracker->stats.updates);
+	}
+
 	SurviveKalmanLighthouse_detach_config(tracker->ctx, tracker);
 	cnkalman_state_free(&tracker->model);
 	free(tracker);
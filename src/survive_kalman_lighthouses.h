@@ -2,6 +2,17 @@
 #include "survive_kalman_tracker.h"
 #include <cnkalman/kalman.h>
 
+// Most light observations stacked into one lighthouse update
+#define SURVIVE_KALMAN_LIGHTHOUSE_BATCH_MAX 64
+
+typedef struct SurviveKalmanLighthouseObservation {
+	SurviveObject *so;
+	// Where the object was predicted to be when the light came in
+	SurvivePose obj2world;
+	LightInfo light;
+	FLT variance;
+} SurviveKalmanLighthouseObservation;
+
 typedef struct SurviveKalmanLighthouse {
 	SurvivePose state;
 
@@ -17,11 +28,29 @@ typedef struct SurviveKalmanLighthouse {
 	FLT light_variance;
 	FLT light_stationary_mintime;
 	FLT light_stationary_maxtime;
+	FLT light_batch_time;
+
+	// Light from every object that sees this lighthouse, waiting to go into one update
+	struct {
+		SurviveKalmanLighthouseObservation obs[SURVIVE_KALMAN_LIGHTHOUSE_BATCH_MAX];
+		size_t cnt;
+		// In run time; object timecodes don't share a timebase
+		FLT start_time, last_time;
+	} batch;
 
+	struct {
+		uint32_t updates, observations;
+	} stats;
 } SurviveKalmanLighthouse;
 
 SURVIVE_EXPORT void survive_kalman_lighthouse_integrate_light(SurviveKalmanLighthouse *tracker, SurviveObject *so,
 															  PoserDataLight *data);
+// Runs the update for whatever light is batched up; integrate_light does this once the batch window passed
+SURVIVE_EXPORT void survive_kalman_lighthouse_flush_light(SurviveKalmanLighthouse *tracker);
+// Flushes the batch if it is older than the batch window, for callers that see time pass without new light
+SURVIVE_EXPORT void survive_kalman_lighthouse_flush_expired(SurviveKalmanLighthouse *tracker);
+// Flushes the batch if it holds light seen by `so`; called before the object goes away
+SURVIVE_EXPORT void survive_kalman_lighthouse_remove_object(SurviveKalmanLighthouse *tracker, const SurviveObject *so);
 SURVIVE_EXPORT void survive_kalman_lighthouse_init(SurviveKalmanLighthouse *tracker, SurviveContext *ctx, int lh);
 SURVIVE_EXPORT void survive_kalman_lighthouse_free(SurviveKalmanLighthouse *tracker);
 SURVIVE_EXPORT void survive_kalman_lighthouse_integrate_observation(SurviveKalmanLighthouse *tracker,
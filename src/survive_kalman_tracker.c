@@ -18,6 +18,7 @@
 #include "generated/survive_imu.generated.h"
 #include "generated/survive_reproject.aux.generated.h"
 #include "survive_kalman_lighthouses.h"
+#include "survive_lighthouse_cache.h"
 #include "survive_recording.h"
 
 #define SURVIVE_MODEL_MAX_STATE_CNT (sizeof(SurviveKalmanModel) / sizeof(FLT))
@@ -181,6 +182,11 @@ static void normalize_model(SurviveKalmanTracker *pTracker) {
 
 struct map_light_data_ctx {
 	SurviveKalmanTracker *tracker;
+
+	// Innovation of the first evaluation, i.e. before the update, per lighthouse
+	bool has_residuals;
+	FLT lh_sq_residual[NUM_GEN2_LIGHTHOUSES];
+	uint32_t lh_meas[NUM_GEN2_LIGHTHOUSES];
 };
 
 typedef void (*SurviveKalmanModel_LightMeas_jac_x0_with_hx)(CnMat* Hx, CnMat* hx, const FLT dt, const SurviveKalmanModel* _x0, const FLT* sensor_pt, const SurvivePose* lh_p, const BaseStationCal* bsc0);
@@ -251,6 +257,10 @@ CN_CREATE_STACK_VEC(h_x, 1);
 		}
 		if(y) {
 			Y[i] = cn_as_const_vector(Z)[i] - h_x.data[0];
+			if (!cbctx->has_residuals) {
+				cbctx->lh_sq_residual[info->lh] += Y[i] * Y[i];
+				cbctx->lh_meas[info->lh]++;
+			}
 			if(tracker->lightcap_max_error > 0) {
 				Y[i] = linmath_enforce_range(Y[i], -tracker->lightcap_max_error, tracker->lightcap_max_error);
 			}
@@ -260,6 +270,9 @@ CN_CREATE_STACK_VEC(h_x, 1);
         SV_DATA_LOG("Z_light[%d][%d][%d]", &info->value, 1, info->lh, info->axis, info->sensor_idx);
 	}
 
+	if (y)
+		cbctx->has_residuals = true;
+
 	if (H_k && !cn_is_finite(H_k))
 		return false;
 
@@ -325,7 +338,9 @@ void survive_kalman_tracker_integrate_saved_light(SurviveKalmanTracker *tracker,
         tracker->datalog_tag = "light_data";
 		if(time < tracker->model.t)
 			time = tracker->model.t;
+		uint64_t trace_start = survive_trace_begin();
         FLT rtn = cnkalman_meas_model_predict_update(time, &tracker->lightcap_model, &cbctx, &Z, &R);
+		survive_trace_end("kalman light update", trace_start);
 		tracker->datalog_tag = 0;
 		if (!ramp_in && tracker->lightcap_model.adaptive) {
 			tracker->light_var = light_var;
@@ -336,6 +351,13 @@ void survive_kalman_tracker_integrate_saved_light(SurviveKalmanTracker *tracker,
 		tracker->light_residuals_all *= .9;
 		tracker->light_residuals_all += .1 * rtn;
 
+		if (ctx->lh_cache) {
+			for (int lh = 0; lh < NUM_GEN2_LIGHTHOUSES; lh++) {
+				if (cbctx.lh_meas[lh])
+					survive_lighthouse_cache_check_residual(ctx, lh, sqrt(cbctx.lh_sq_residual[lh] / cbctx.lh_meas[lh]));
+			}
+		}
+
 		SV_DATA_LOG("res_error_light_", &rtn, 1);
 		SV_DATA_LOG("res_error_light_avg", &tracker->light_residuals_all, 1);
 		tracker->stats.lightcap_count++;
@@ -569,7 +591,9 @@ static FLT integrate_pose(SurviveKalmanTracker *tracker, FLT time, const Survive
 	}
 
 	tracker->datalog_tag = "pose_obs";
+	uint64_t trace_start = survive_trace_begin();
     rtn = cnkalman_meas_model_predict_update(time, &tracker->obs_model, tracker, &Z, Rp);
+	survive_trace_end("kalman pose update", trace_start);
 
 	tracker->datalog_tag = 0;
 	SurviveContext *ctx = tracker->so->ctx;
@@ -696,7 +720,9 @@ void survive_kalman_tracker_integrate_imu(SurviveKalmanTracker *tracker, PoserDa
 		tracker->datalog_tag = "imu_meas";
 
         CnMat R = cnMat(6, tracker->imu_model.adaptive ? 6 : 1, tracker->imu_model.adaptive ? tracker->IMU_R : rotation_variance);
+		uint64_t trace_start = survive_trace_begin();
         FLT err = cnkalman_meas_model_predict_update(time, &tracker->imu_model, &fn_ctx, &Z, &R);
+		survive_trace_end("kalman imu update", trace_start);
 		tracker->datalog_tag = 0;
 
         SV_DATA_LOG("res_err_imu", &err, 1);
@@ -1341,6 +1367,10 @@ void survive_kalman_tracker_stats(SurviveKalmanTracker *tracker) {
 void survive_kalman_tracker_free(SurviveKalmanTracker *tracker) {
 	SurviveContext *ctx = tracker->so->ctx;
 
+	// Lighthouse batches point at the object
+	for (int lh = 0; lh < NUM_GEN2_LIGHTHOUSES; lh++)
+		survive_kalman_lighthouse_remove_object(ctx->bsd[lh].tracker, tracker->so);
+
 	survive_kalman_tracker_stats(tracker);
 
 	cnkalman_state_free(&tracker->model);
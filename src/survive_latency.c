@@ -0,0 +1,255 @@
+#include "survive_latency.h"
+#include "survive.h"
+#include "survive_atomic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char *hook_names[] = {
+#define SURVIVE_HOOK_PROCESS_DEF(hook) #hook,
+#include "survive_hooks.h"
+};
+
+const char *survive_hook_name(enum survive_hook_id id) {
+	if (id < 0 || id >= survive_hook_id_count)
+		return "unknown";
+	return hook_names[id];
+}
+
+uint64_t survive_latency_now_ns() {
+#ifdef _WIN32
+	static LARGE_INTEGER freq = {0};
+	LARGE_INTEGER now;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static inline int highest_bit(uint64_t v) {
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(v);
+#elif defined(_MSC_VER) && defined(_WIN64)
+	unsigned long idx;
+	_BitScanReverse64(&idx, v);
+	return (int)idx;
+#else
+	int rtn = 0;
+	while (v >>= 1)
+		rtn++;
+	return rtn;
+#endif
+}
+
+/*
+ * Values below SURVIVE_LATENCY_SUB_BUCKETS get a bucket each. Above that, the bucket group is the position of the
+ * highest set bit and the sub bucket is the next SURVIVE_LATENCY_SUB_BUCKET_BITS bits.
+ */
+static inline size_t bucket_index(uint64_t ns) {
+	if (ns < SURVIVE_LATENCY_SUB_BUCKETS)
+		return (size_t)ns;
+
+	int e = highest_bit(ns);
+	if (e >= SURVIVE_LATENCY_MAX_EXPONENT)
+		return SURVIVE_LATENCY_BUCKET_CNT - 1;
+
+	int shift = e - SURVIVE_LATENCY_SUB_BUCKET_BITS;
+	size_t group = shift + 1;
+	size_t sub = (size_t)(ns >> shift) - SURVIVE_LATENCY_SUB_BUCKETS;
+	return group * SURVIVE_LATENCY_SUB_BUCKETS + sub;
+}
+
+static inline uint64_t bucket_upper_bound(size_t idx) {
+	size_t group = idx / SURVIVE_LATENCY_SUB_BUCKETS;
+	size_t sub = idx % SURVIVE_LATENCY_SUB_BUCKETS;
+	if (group == 0)
+		return sub;
+
+	int shift = (int)group - 1;
+	return (((uint64_t)(SURVIVE_LATENCY_SUB_BUCKETS + sub + 1)) << shift) - 1;
+}
+
+void survive_latency_histogram_add(survive_latency_histogram *h, uint64_t ns) {
+	SURVIVE_ATOMIC_ADD32(&h->counts[bucket_index(ns)], 1);
+	SURVIVE_ATOMIC_ADD64(&h->cnt, 1);
+	SURVIVE_ATOMIC_ADD64(&h->total_ns, ns);
+
+	uint64_t max_ns = SURVIVE_ATOMIC_LOAD64(&h->max_ns);
+	while (ns > max_ns && !survive_atomic_cas64(&h->max_ns, &max_ns, ns)) {
+	}
+}
+
+uint64_t survive_latency_histogram_percentile(const survive_latency_histogram *h, FLT quantile) {
+	uint64_t cnt = 0;
+	for (size_t i = 0; i < SURVIVE_LATENCY_BUCKET_CNT; i++)
+		cnt += SURVIVE_ATOMIC_LOAD32(&h->counts[i]);
+	if (cnt == 0)
+		return 0;
+
+	uint64_t rank = (uint64_t)(quantile * cnt + .5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > cnt)
+		rank = cnt;
+
+	uint64_t max_ns = SURVIVE_ATOMIC_LOAD64(&h->max_ns);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < SURVIVE_LATENCY_BUCKET_CNT; i++) {
+		seen += SURVIVE_ATOMIC_LOAD32(&h->counts[i]);
+		if (seen >= rank) {
+			uint64_t upper = bucket_upper_bound(i);
+			return upper < max_ns ? upper : max_ns;
+		}
+	}
+	return max_ns;
+}
+
+void survive_latency_histogram_summary(const survive_latency_histogram *h, SurviveLatencySummary *out) {
+	memset(out, 0, sizeof(*out));
+	if (h == 0)
+		return;
+
+	out->cnt = SURVIVE_ATOMIC_LOAD64(&h->cnt);
+	if (out->cnt == 0)
+		return;
+
+	out->mean = SURVIVE_ATOMIC_LOAD64(&h->total_ns) * 1e-9 / out->cnt;
+	out->p50 = survive_latency_histogram_percentile(h, .5) * 1e-9;
+	out->p90 = survive_latency_histogram_percentile(h, .9) * 1e-9;
+	out->p99 = survive_latency_histogram_percentile(h, .99) * 1e-9;
+	out->p999 = survive_latency_histogram_percentile(h, .999) * 1e-9;
+	out->max = SURVIVE_ATOMIC_LOAD64(&h->max_ns) * 1e-9;
+}
+
+void survive_latency_histogram_reset(survive_latency_histogram *h) {
+	if (h)
+		memset(h, 0, sizeof(*h));
+}
+
+// Allocates *slot on first use; when two threads race the loser frees its copy
+static void *lazy_alloc(void **slot, size_t size) {
+	void *rtn = SURVIVE_ATOMIC_LOAD_PTR(slot);
+	if (rtn)
+		return rtn;
+
+	void *n = SV_CALLOC(size);
+	void *prior = survive_atomic_cas_ptr(slot, 0, n);
+	if (prior) {
+		free(n);
+		return prior;
+	}
+	return n;
+}
+
+static inline survive_latency_histogram *stats_hook_histogram(struct SurviveLatencyStats **stats,
+															  enum survive_hook_id id) {
+	struct SurviveLatencyStats *s = lazy_alloc((void **)stats, sizeof(struct SurviveLatencyStats));
+	return lazy_alloc((void **)&s->hooks[id], sizeof(survive_latency_histogram));
+}
+
+void survive_latency_record_hook(SurviveContext *ctx, SurviveObject *so, enum survive_hook_id id, uint64_t ns) {
+	if (id < 0 || id >= survive_hook_id_count)
+		return;
+
+	if (ctx)
+		survive_latency_histogram_add(stats_hook_histogram(&ctx->latency, id), ns);
+	if (so)
+		survive_latency_histogram_add(stats_hook_histogram(&so->latency, id), ns);
+}
+
+void survive_latency_record_sensor_to_pose(SurviveObject *so, survive_long_timecode timecode) {
+	if (so->activations.runtime_offset == 0)
+		return;
+
+	uint64_t received_us = SurviveSensorActivations_runtime(&so->activations, timecode);
+	uint64_t now_us = OGGetAbsoluteTimeUS();
+	if (now_us < received_us)
+		return;
+
+	struct SurviveLatencyStats *s = lazy_alloc((void **)&so->latency, sizeof(struct SurviveLatencyStats));
+	survive_latency_histogram *h = lazy_alloc((void **)&s->sensor_to_pose, sizeof(survive_latency_histogram));
+	survive_latency_histogram_add(h, (now_us - received_us) * 1000);
+}
+
+static uint64_t summarize_hook(const struct SurviveLatencyStats *stats, enum survive_hook_id id,
+							   SurviveLatencySummary *out) {
+	const survive_latency_histogram *h = 0;
+	if (stats && id >= 0 && id < survive_hook_id_count)
+		h = stats->hooks[id];
+	survive_latency_histogram_summary(h, out);
+	return out->cnt;
+}
+
+uint64_t survive_latency_hook(const SurviveContext *ctx, enum survive_hook_id id, SurviveLatencySummary *out) {
+	return summarize_hook(ctx->latency, id, out);
+}
+
+uint64_t survive_latency_object_hook(const SurviveObject *so, enum survive_hook_id id, SurviveLatencySummary *out) {
+	return summarize_hook(so->latency, id, out);
+}
+
+uint64_t survive_latency_sensor_to_pose(const SurviveObject *so, SurviveLatencySummary *out) {
+	survive_latency_histogram_summary(so->latency ? so->latency->sensor_to_pose : 0, out);
+	return out->cnt;
+}
+
+static void dump_summary(SurviveContext *ctx, const char *prefix, const char *name, const SurviveLatencySummary *s) {
+	SV_INFO("\t%-8s %-20s cnt: %9" PRIu64 " mean: %9.3fus p50: %9.3fus p90: %9.3fus p99: %9.3fus p99.9: %9.3fus "
+			"max: %9.3fus",
+			prefix, name, s->cnt, s->mean * 1e6, s->p50 * 1e6, s->p90 * 1e6, s->p99 * 1e6, s->p999 * 1e6,
+			s->max * 1e6);
+}
+
+void survive_latency_dump(SurviveContext *ctx) {
+	SurviveLatencySummary s;
+
+	SV_INFO("Hook latency:");
+	for (int id = 0; id < survive_hook_id_count; id++) {
+		if (survive_latency_hook(ctx, id, &s))
+			dump_summary(ctx, "all", survive_hook_name(id), &s);
+	}
+
+	for (int i = 0; i < ctx->objs_ct; i++) {
+		SurviveObject *so = ctx->objs[i];
+		for (int id = 0; id < survive_hook_id_count; id++) {
+			if (survive_latency_object_hook(so, id, &s))
+				dump_summary(ctx, so->codename, survive_hook_name(id), &s);
+		}
+		if (survive_latency_sensor_to_pose(so, &s))
+			dump_summary(ctx, so->codename, "sensor-to-pose", &s);
+	}
+}
+
+static void reset_stats(struct SurviveLatencyStats *stats) {
+	if (stats == 0)
+		return;
+	for (int id = 0; id < survive_hook_id_count; id++)
+		survive_latency_histogram_reset(stats->hooks[id]);
+	survive_latency_histogram_reset(stats->sensor_to_pose);
+}
+
+void survive_latency_reset(SurviveContext *ctx) {
+	reset_stats(ctx->latency);
+	for (int i = 0; i < ctx->objs_ct; i++)
+		reset_stats(ctx->objs[i]->latency);
+}
+
+void survive_latency_free(struct SurviveLatencyStats *stats) {
+	if (stats == 0)
+		return;
+	for (int id = 0; id < survive_hook_id_count; id++)
+		free(stats->hooks[id]);
+	free(stats->sensor_to_pose);
+	free(stats);
+}
@@ -0,0 +1,247 @@
+#include "survive_lighthouse_cache.h"
+#include "survive_config.h"
+
+#include <string.h>
+#include <time.h>
+
+STATIC_CONFIG_ITEM(LIGHTHOUSE_CACHE, "lighthouse-cache", 's',
+				   "File base station calibration is cached in, keyed by base station id. Empty to disable.",
+				   "lighthouse_cache.json")
+STATIC_CONFIG_ITEM(LIGHTHOUSE_CACHE_CONFIRMATIONS, "lighthouse-cache-confirmations", 'i',
+				   "Light updates that have to agree with a cached lighthouse pose before it is confirmed", 100)
+STATIC_CONFIG_ITEM(LIGHTHOUSE_CACHE_MAX_RESIDUAL, "lighthouse-cache-max-residual", 'f',
+				   "RMS light residual, in radians, under which a light update agrees with a cached lighthouse pose", 5e-3)
+
+// config_read_lighthouse only reads indices below NUM_GEN2_LIGHTHOUSES
+#define SURVIVE_LIGHTHOUSE_CACHE_SIZE NUM_GEN2_LIGHTHOUSES
+
+struct SurviveLighthouseCache {
+	char path[FILENAME_MAX];
+	int confirmations_needed;
+	FLT max_residual;
+	config_group entries[SURVIVE_LIGHTHOUSE_CACHE_SIZE];
+
+	// Validation state of lighthouses that were filled in from the cache
+	struct {
+		bool ootx_pending, pose_pending;
+		uint32_t good_residuals, bad_residuals;
+		FLT applied_at;
+	} applied[NUM_GEN2_LIGHTHOUSES];
+};
+
+static bool read_entry(struct SurviveLighthouseCache *cache, int idx, BaseStationData *bsd) {
+	memset(bsd, 0, sizeof(*bsd));
+	return config_read_lighthouse(cache->entries, bsd, idx) && bsd->BaseStationID != 0 && bsd->OOTXSet;
+}
+
+void survive_lighthouse_cache_load(SurviveContext *ctx) {
+	const char *name = survive_configs(ctx, LIGHTHOUSE_CACHE_TAG, SC_GET, "");
+	if (name == 0 || name[0] == 0)
+		return;
+
+	// Replayed and simulated sessions shouldn't pick up -- or leave behind -- calibration of the real setup
+	const char *replay_fields[] = {"playback", "usbmon-playback", "simulator", 0};
+	if (!survive_config_is_set(ctx, LIGHTHOUSE_CACHE_TAG)) {
+		for (const char **field = replay_fields; *field; field++) {
+			if (survive_config_is_set(ctx, *field))
+				return;
+		}
+	}
+
+	struct SurviveLighthouseCache *cache = SV_CALLOC(sizeof(struct SurviveLighthouseCache));
+	survive_config_resolve_path(name, cache->path);
+	cache->confirmations_needed = survive_configi(ctx, LIGHTHOUSE_CACHE_CONFIRMATIONS_TAG, SC_GET, 100);
+	cache->max_residual = survive_configf(ctx, LIGHTHOUSE_CACHE_MAX_RESIDUAL_TAG, SC_GET, 5e-3);
+
+	config_group ignored;
+	init_config_group(&ignored, 1, ctx);
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++)
+		init_config_group(&cache->entries[i], 10, ctx);
+	config_read_groups(ctx, cache->path, &ignored, cache->entries, SURVIVE_LIGHTHOUSE_CACHE_SIZE);
+	destroy_config_group(&ignored);
+
+	int cnt = 0;
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++) {
+		BaseStationData bsd;
+		cnt += read_entry(cache, i, &bsd);
+	}
+	SV_VERBOSE(5, "Lighthouse cache is %.512s (%d base stations)", cache->path, cnt);
+
+	ctx->lh_cache = cache;
+}
+
+void survive_lighthouse_cache_free(SurviveContext *ctx) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	ctx->lh_cache = 0;
+	if (cache == 0)
+		return;
+
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++)
+		destroy_config_group(&cache->entries[i]);
+	free(cache);
+}
+
+static void save_now(SurviveContext *ctx) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	if (cache == 0)
+		return;
+
+	char tmp_path[FILENAME_MAX + 8] = "";
+	FILE *f = config_replace_begin(cache->path, tmp_path);
+	if (f == 0) {
+		static bool warnedOnce = false;
+		if (!warnedOnce) {
+			SV_WARN("Could not open '%.512s' for writing; base station calibration will not be cached", tmp_path);
+			warnedOnce = true;
+		}
+		return;
+	}
+
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++) {
+		if (config_read_uint32(&cache->entries[i], "id", 0) == 0)
+			continue;
+		char name[128] = {0};
+		snprintf(name, sizeof(name), "lighthouse%d", i);
+		write_config_group(f, &cache->entries[i], name);
+	}
+
+	if (!config_replace_end(f, tmp_path, cache->path)) {
+		SV_WARN("Could not write lighthouse cache '%.512s'; it was left unchanged", cache->path);
+	}
+}
+
+// Coalesced with, and written by the same thread as, the config file
+static void save(SurviveContext *ctx) { config_request_write(ctx, save_now); }
+
+bool survive_lighthouse_cache_apply(SurviveContext *ctx, int8_t bsd_idx) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	if (cache == 0 || survive_configi(ctx, "force-ootx", SC_GET, 0))
+		return false;
+
+	BaseStationData *b = &ctx->bsd[bsd_idx];
+
+	int best = -1;
+	uint32_t best_seen = 0;
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++) {
+		BaseStationData cached;
+		if (!read_entry(cache, i, &cached) || cached.mode != b->mode ||
+			config_read_uint32(&cache->entries[i], "lh_version", 0) != ctx->lh_version + 1)
+			continue;
+
+		bool inUse = false;
+		for (int j = 0; j < NUM_GEN2_LIGHTHOUSES && !inUse; j++)
+			inUse = j != bsd_idx && ctx->bsd[j].mode != 0xFF && ctx->bsd[j].BaseStationID == cached.BaseStationID;
+		if (inUse)
+			continue;
+
+		uint32_t last_seen = config_read_uint32(&cache->entries[i], "last_seen", 0);
+		if (best == -1 || last_seen > best_seen) {
+			best = i;
+			best_seen = last_seen;
+		}
+	}
+
+	if (best == -1)
+		return false;
+
+	BaseStationData cached;
+	read_entry(cache, best, &cached);
+
+	b->BaseStationID = cached.BaseStationID;
+	memcpy(b->fcal, cached.fcal, sizeof(b->fcal));
+	memcpy(b->accel, cached.accel, sizeof(b->accel));
+	b->sys_unlock_count = cached.sys_unlock_count;
+	b->OOTXSet = 1;
+
+	bool usePose = cached.PositionSet && !survive_configi(ctx, "force-calibrate", SC_GET, 0);
+	cache->applied[bsd_idx].ootx_pending = true;
+	cache->applied[bsd_idx].pose_pending = usePose;
+	cache->applied[bsd_idx].good_residuals = cache->applied[bsd_idx].bad_residuals = 0;
+	cache->applied[bsd_idx].applied_at = survive_run_time(ctx);
+
+	SV_INFO("Using cached calibration%s for LH%d (ch %d, id %08x)", usePose ? " and pose" : "", bsd_idx, b->mode,
+			(unsigned)b->BaseStationID);
+
+	if (usePose) {
+		SURVIVE_INVOKE_HOOK(lighthouse_pose, ctx, bsd_idx, &cached.Pose);
+	}
+	return true;
+}
+
+void survive_lighthouse_cache_update(SurviveContext *ctx, int8_t bsd_idx) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	BaseStationData *b = &ctx->bsd[bsd_idx];
+	if (cache == 0 || b->BaseStationID == 0 || !b->OOTXSet)
+		return;
+
+	int slot = -1;
+	uint32_t oldest_seen = 0;
+	for (int i = 0; i < SURVIVE_LIGHTHOUSE_CACHE_SIZE; i++) {
+		uint32_t id = config_read_uint32(&cache->entries[i], "id", 0);
+		if (id == b->BaseStationID) {
+			slot = i;
+			break;
+		}
+
+		// Empty entries first, then the one that wasn't seen the longest
+		uint32_t last_seen = id == 0 ? 0 : config_read_uint32(&cache->entries[i], "last_seen", 0);
+		if (slot == -1 || last_seen < oldest_seen) {
+			slot = i;
+			oldest_seen = last_seen;
+		}
+	}
+
+	config_set_lighthouse(cache->entries, b, slot);
+	config_set_uint32(&cache->entries[slot], "lh_version", ctx->lh_version + 1);
+	config_set_uint32(&cache->entries[slot], "last_seen", (uint32_t)time(0));
+	save(ctx);
+}
+
+void survive_lighthouse_cache_check_ootx(SurviveContext *ctx, int8_t bsd_idx, uint32_t id) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	if (cache == 0 || !cache->applied[bsd_idx].ootx_pending)
+		return;
+
+	cache->applied[bsd_idx].ootx_pending = false;
+	FLT elapsed = survive_run_time(ctx) - cache->applied[bsd_idx].applied_at;
+	if (ctx->bsd[bsd_idx].BaseStationID == id) {
+		SV_VERBOSE(10, "Cached calibration for LH%d (id %08x) confirmed by OOTX after %.2fs", bsd_idx, (unsigned)id,
+				   elapsed);
+	} else {
+		// The OOTX handler takes it from here; a new id resets the calibration and the pose
+		SV_WARN("Cached calibration for LH%d was for %08x, but OOTX says it is %08x; replacing it", bsd_idx,
+				(unsigned)ctx->bsd[bsd_idx].BaseStationID, (unsigned)id);
+		cache->applied[bsd_idx].pose_pending = false;
+	}
+}
+
+void survive_lighthouse_cache_check_residual(SurviveContext *ctx, int8_t bsd_idx, FLT residual) {
+	struct SurviveLighthouseCache *cache = ctx->lh_cache;
+	if (cache == 0 || !cache->applied[bsd_idx].pose_pending)
+		return;
+
+	if (!ctx->bsd[bsd_idx].PositionSet) {
+		// Reset by someone else already; whatever is solved next replaces the cached pose
+		cache->applied[bsd_idx].pose_pending = false;
+		return;
+	}
+
+	if (residual < cache->max_residual)
+		cache->applied[bsd_idx].good_residuals++;
+	else
+		cache->applied[bsd_idx].bad_residuals++;
+
+	uint32_t good = cache->applied[bsd_idx].good_residuals, bad = cache->applied[bsd_idx].bad_residuals;
+	FLT elapsed = survive_run_time(ctx) - cache->applied[bsd_idx].applied_at;
+	if (good >= cache->confirmations_needed && good > bad) {
+		cache->applied[bsd_idx].pose_pending = false;
+		SV_VERBOSE(10, "Cached pose for LH%d confirmed after %.2fs (%u/%u good updates)", bsd_idx, elapsed, good,
+				   good + bad);
+	} else if (bad >= cache->confirmations_needed && bad > good) {
+		cache->applied[bsd_idx].pose_pending = false;
+		SV_WARN("Cached pose for LH%d doesn't agree with tracking (%u/%u bad updates); solving for it again", bsd_idx,
+				bad, good + bad);
+		survive_reset_lighthouse_position(ctx, bsd_idx);
+		survive_lighthouse_cache_update(ctx, bsd_idx);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "survive.h"
+
+/**
+ * Calibration for every base station this machine has seen, keyed by BaseStationID and kept in its own file next to
+ * the config file ("lighthouse-cache"). Unlike the lighthouseN groups of the config file it doesn't depend on the
+ * order channels were discovered in, so it survives new config files, moved setups and swapped channels.
+ *
+ * When a new channel shows up, the most recently seen cached base station on that channel is trusted right away --
+ * OOTX, and the pose if one was cached -- so tracking doesn't wait for the OOTX frame and a lighthouse solve. The guess
+ * is then checked in the background:
+ *
+ * - the first OOTX packet decoded for the channel confirms the BaseStationID, or replaces the calibration when it's a
+ *   different base station;
+ * - light residuals of tracked objects confirm the pose, and a pose that keeps failing them is dropped so it gets
+ *   solved for again.
+ */
+
+struct SurviveLighthouseCache;
+
+void survive_lighthouse_cache_load(SurviveContext *ctx);
+void survive_lighthouse_cache_free(SurviveContext *ctx);
+
+// Fills in a newly discovered lighthouse from the cache; returns false if nothing matched its channel
+bool survive_lighthouse_cache_apply(SurviveContext *ctx, int8_t bsd_idx);
+// Stores the current calibration of the given lighthouse
+void survive_lighthouse_cache_update(SurviveContext *ctx, int8_t bsd_idx);
+
+// Called with the id of each decoded OOTX packet, before the lighthouse data is updated from it
+void survive_lighthouse_cache_check_ootx(SurviveContext *ctx, int8_t bsd_idx, uint32_t id);
+// Called after each light update of a tracked object with the RMS angle residual, in radians, of the light from the
+// given lighthouse before the update
+void survive_lighthouse_cache_check_residual(SurviveContext *ctx, int8_t bsd_idx, FLT residual);
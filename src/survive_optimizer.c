@@ -1028,6 +1028,9 @@ static mp_config *survive_optimizer_get_cfg(SurviveContext *ctx) {
 
 mp_config precise_cfg = {0};
 SURVIVE_EXPORT mp_config *survive_optimizer_precise_config() { return &precise_cfg; }
+SURVIVE_EXPORT mp_config *survive_optimizer_default_config(SurviveContext *ctx) {
+	return survive_optimizer_get_cfg(ctx);
+}
 
 #ifndef NDEBUG
 static inline bool sane_covariance(const CnMat *P) {
@@ -1089,6 +1092,7 @@ int get_meas_for_lhs_axis(survive_optimizer *optimizer, int obj, size_t* meas_fo
 
 int survive_optimizer_run(survive_optimizer *optimizer, struct mp_result_struct *result, struct CnMat *R) {
 	SurviveContext *ctx = optimizer->sos[0] ? optimizer->sos[0]->ctx : 0;
+	uint64_t trace_start = survive_trace_begin();
 
 	mp_config *cfg = optimizer->cfg;
 	if (cfg == 0)
@@ -1173,7 +1177,7 @@ int survive_optimizer_run(survive_optimizer *optimizer, struct mp_result_struct
 	optimizer->parameters = params;
 
 	FLT rchisqr = result->bestnorm / result->nfree;
-	if (optimizer->sos && optimizer->sos[0])
+	if (optimizer->sos && optimizer->sos[0] && !optimizer->norecord)
 		survive_recording_write_matrix(ctx->recptr, optimizer->sos[0], 10, "full_cov", &R_aa);
 	assert(sane_covariance(&R_aa));
 	int totalPoseCount = optimizer->poseLength + optimizer->cameraLength;
@@ -1258,7 +1262,7 @@ int survive_optimizer_run(survive_optimizer *optimizer, struct mp_result_struct
 					}
 				}
 			}
-			if(changed) {
+			if(changed && !optimizer->norecord) {
 				CnMat v = cnMat(2, SURVIVE_CORRECTION_PARAMS, (FLT *)so->lh_correction);
 				survive_recording_write_matrix(ctx->recptr, so, 5, "lhc", &v);
 			}
@@ -1271,6 +1275,7 @@ int survive_optimizer_run(survive_optimizer *optimizer, struct mp_result_struct
         }
     }
 
+	survive_trace_end("survive_optimizer_run", trace_start);
 	return rtn;
 }
 
@@ -1464,6 +1469,38 @@ SURVIVE_EXPORT size_t survive_optimizer_get_total_buffer_size(const survive_opti
 				 NUM_GEN2_LIGHTHOUSES; // measurements
 }
 
+void survive_optimizer_clone(survive_optimizer *dst, const survive_optimizer *src) {
+	size_t par_count = survive_optimizer_get_max_parameters_count(src);
+	size_t meas_count = survive_optimizer_get_max_measurements_count(src);
+
+	*dst = *src;
+	dst->parameters = SV_MALLOC(par_count * sizeof(FLT));
+	memcpy(dst->parameters, src->parameters, par_count * sizeof(FLT));
+	dst->mp_parameters_info = SV_MALLOC(par_count * sizeof(mp_par));
+	memcpy(dst->mp_parameters_info, src->mp_parameters_info, par_count * sizeof(mp_par));
+	dst->parameters_info = SV_MALLOC(par_count * sizeof(survive_optimizer_parameter));
+	memcpy(dst->parameters_info, src->parameters_info, par_count * sizeof(survive_optimizer_parameter));
+	dst->measurements = SV_MALLOC(meas_count * sizeof(survive_optimizer_measurement));
+	memcpy(dst->measurements, src->measurements, meas_count * sizeof(survive_optimizer_measurement));
+	dst->sos = SV_MALLOC(src->poseLength * sizeof(SurviveObject *));
+	memcpy(dst->sos, src->sos, src->poseLength * sizeof(SurviveObject *));
+
+	// Parameter blocks point into the parameter buffers
+	for (size_t i = 0; i < dst->parameterBlockCnt; i++) {
+		dst->parameters_info[i].p = dst->parameters + dst->parameters_info[i].p_idx;
+		dst->parameters_info[i].pi = dst->mp_parameters_info + dst->parameters_info[i].p_idx;
+	}
+}
+
+void survive_optimizer_free_clone(survive_optimizer *opt) {
+	free(opt->parameters);
+	free(opt->mp_parameters_info);
+	free(opt->parameters_info);
+	free(opt->measurements);
+	free(opt->sos);
+	memset(opt, 0, sizeof(*opt));
+}
+
 SURVIVE_EXPORT void survive_optimizer_setup_buffers(survive_optimizer *ctx, FLT *parameter_buffer,
 													survive_optimizer_parameter *parameter_info_buffer,
 													struct mp_par_struct *mp_parameter_info_buffer,
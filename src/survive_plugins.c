@@ -11,6 +11,8 @@
 #include <survive.h>
 
 #include "assert.h"
+#include "os_generic.h"
+#include "survive_internal.h"
 
 #ifdef _WIN32
 #include "survive_plugins.windows.h"
@@ -69,6 +71,239 @@ static bool list_find(list_t* plugin_list, const char* item) {
 	return false;
 }
 
+/**
+ * A plugin directory can carry a manifest, generated by the build, of the drivers and posers each plugin in it
+ * registers. Plugins from such a directory aren't loaded up front; GetDriver loads the one providing a name the first
+ * time that name is asked for, so a session only pays for the plugins its configuration uses. Setting
+ * SURVIVE_PLUGINS_EAGER loads everything up front regardless.
+ */
+#define PLUGIN_MANIFEST "plugins.manifest"
+
+typedef struct plugin_manifest_entry {
+	char *path;
+	list_t provides;
+	// Full paths of plugins that have to be loaded first
+	list_t requires;
+
+	bool loaded, failed;
+	double load_time;
+} plugin_manifest_entry;
+
+static struct {
+	plugin_manifest_entry *entries;
+	size_t cnt;
+	og_mutex_t lock;
+
+	// Plugins from directories without a manifest; survive_load_plugins loads all of them
+	size_t eager_cnt;
+	double eager_time;
+} manifest;
+
+static plugin_manifest_entry *manifest_entry(const char *path, bool create) {
+	for (size_t i = 0; i < manifest.cnt; i++) {
+		if (strcmp(manifest.entries[i].path, path) == 0)
+			return &manifest.entries[i];
+	}
+	if (!create)
+		return 0;
+
+	manifest.entries = SV_REALLOC(manifest.entries, sizeof(plugin_manifest_entry) * (manifest.cnt + 1));
+	plugin_manifest_entry *entry = &manifest.entries[manifest.cnt++];
+	*entry = (plugin_manifest_entry){0};
+	entry->path = SV_MALLOC(strlen(path) + 1);
+	strcpy(entry->path, path);
+	return entry;
+}
+
+static plugin_manifest_entry *manifest_provider(const char *name) {
+	for (size_t i = 0; i < manifest.cnt; i++) {
+		if (list_find(&manifest.entries[i].provides, name))
+			return &manifest.entries[i];
+	}
+	return 0;
+}
+
+static bool read_manifest(const char *plugindirname, bool verbose) {
+	char manifest_path[1024] = {0};
+	snprintf(manifest_path, sizeof(manifest_path), "%s/%s", plugindirname, PLUGIN_MANIFEST);
+	FILE *f = fopen(manifest_path, "r");
+	if (f == 0)
+		return false;
+
+	if (manifest.lock == 0)
+		manifest.lock = OGCreateMutex();
+
+	// Lines are '<plugin> provides <name>' or '<plugin> requires <plugin>'
+	char line[1024];
+	while (fgets(line, sizeof(line), f)) {
+		char file[256], verb[16], arg[256];
+		if (line[0] == '#' || sscanf(line, "%255s %15s %255s", file, verb, arg) != 3)
+			continue;
+
+		char full_path[1024] = {0};
+		snprintf(full_path, sizeof(full_path), "%s/%s", plugindirname, file);
+		plugin_manifest_entry *entry = manifest_entry(full_path, true);
+
+		if (strcmp(verb, "provides") == 0) {
+			// The same directory can be reached by more than one path; the first one found provides the name
+			if (manifest_provider(arg) == 0)
+				list_add(&entry->provides, arg);
+		} else if (strcmp(verb, "requires") == 0) {
+			snprintf(full_path, sizeof(full_path), "%s/%s", plugindirname, arg);
+			if (!list_find(&entry->requires, full_path))
+				list_add(&entry->requires, full_path);
+		}
+	}
+	fclose(f);
+
+	if (verbose)
+		printf("survive plugins: Read %s\n", manifest_path);
+	return true;
+}
+
+static bool load_manifest_entry(plugin_manifest_entry *entry, bool verbose) {
+	if (entry->loaded || entry->failed)
+		return entry->loaded;
+
+	// Set before the requirements are loaded so that a cycle of them ends
+	entry->loaded = true;
+	for (size_t i = 0; i < entry->requires.size; i++) {
+		plugin_manifest_entry *dep = manifest_entry(entry->requires.data[i], false);
+		if (dep)
+			load_manifest_entry(dep, verbose);
+	}
+
+	double start = OGGetAbsoluteTime();
+	void *handle = survive_load_plugin(entry->path);
+	entry->load_time = OGGetAbsoluteTime() - start;
+
+	if (handle == 0) {
+		fprintf(stderr, "Error loading %s: %s\n", entry->path, survive_load_plugin_error());
+		entry->loaded = false;
+		entry->failed = true;
+		return false;
+	}
+
+	if (verbose) {
+		printf("survive plugins: Loaded %s in %.3fms\n", entry->path, entry->load_time * 1000.);
+	}
+	return true;
+}
+
+bool survive_load_plugin_providing(const char *name) {
+	if (manifest.cnt == 0 || name == 0)
+		return false;
+
+	bool verbose = getenv("SURVIVE_PLUGIN_DEBUG") != 0;
+	bool rtn = false;
+	OGLockMutex(manifest.lock);
+	plugin_manifest_entry *entry = manifest_provider(name);
+	if (entry && !entry->loaded && !entry->failed) {
+		if (verbose)
+			printf("survive plugins: %s needed for %s\n", entry->path, name);
+		rtn = load_manifest_entry(entry, verbose);
+	}
+	OGUnlockMutex(manifest.lock);
+	return rtn;
+}
+
+int survive_plugin_loaded_for(const char *name) {
+	if (manifest.cnt == 0 || name == 0)
+		return -1;
+
+	OGLockMutex(manifest.lock);
+	plugin_manifest_entry *entry = manifest_provider(name);
+	int rtn = entry ? entry->loaded : -1;
+	OGUnlockMutex(manifest.lock);
+	return rtn;
+}
+
+const char *survive_plugin_provided_name(int place) {
+	for (size_t i = 0; i < manifest.cnt; i++) {
+		const list_t *provides = &manifest.entries[i].provides;
+		if ((size_t)place < provides->size)
+			return provides->data[place];
+		place -= (int)provides->size;
+	}
+	return 0;
+}
+
+void survive_load_all_plugins() {
+	if (manifest.cnt == 0)
+		return;
+
+	bool verbose = getenv("SURVIVE_PLUGIN_DEBUG") != 0;
+	OGLockMutex(manifest.lock);
+	for (size_t i = 0; i < manifest.cnt; i++)
+		load_manifest_entry(&manifest.entries[i], verbose);
+	OGUnlockMutex(manifest.lock);
+}
+
+void survive_plugins_dump(SurviveContext *ctx) {
+	if (manifest.eager_cnt) {
+		SV_INFO("Plugins loaded without a manifest: %u in %.3fms", (unsigned)manifest.eager_cnt,
+				manifest.eager_time * 1000.);
+	}
+	if (manifest.cnt == 0)
+		return;
+
+	size_t loaded = 0, listed = 0;
+	double load_time = 0;
+	SV_INFO("Plugins from manifest:");
+	for (size_t i = 0; i < manifest.cnt; i++) {
+		const plugin_manifest_entry *entry = &manifest.entries[i];
+		// Same plugin reached by another path
+		if (entry->provides.size == 0 && !entry->loaded)
+			continue;
+
+		listed++;
+		const char *name = entry->path + strlen(entry->path);
+		while (name > entry->path && name[-1] != '/' && name[-1] != '\\')
+			name--;
+
+		if (entry->loaded) {
+			SV_INFO("\t%-32s %9.3fms", name, entry->load_time * 1000.);
+			loaded++;
+			load_time += entry->load_time;
+		} else {
+			SV_INFO("\t%-32s %s", name, entry->failed ? "failed" : "not needed");
+		}
+	}
+	SV_INFO("\t%u of %u loaded in %.3fms", (unsigned)loaded, (unsigned)listed, load_time * 1000.);
+}
+
+// Loads every plugin in the list, clearing the ones that loaded; returns how many are left
+static size_t load_plugin_list(list_t *plugin_list, bool verbose) {
+	size_t left = plugin_list->size;
+	bool change = true;
+	while (change) {
+		change = false;
+		left = 0;
+		for (size_t i = 0; i < plugin_list->size; i++) {
+			char *plugin_path = plugin_list->data[i];
+			if (plugin_path) {
+				// Global is important to share symbols
+				void *handle = survive_load_plugin(plugin_path);
+				if (handle) {
+					if (verbose) {
+						printf("survive plugins: Loaded %s\n", plugin_path);
+					}
+					change = true;
+					manifest.eager_cnt++;
+					free(plugin_path);
+					plugin_list->data[i] = 0;
+				} else {
+					if (verbose) {
+						printf("Initial error for %s; will retry: %s\n", plugin_path, survive_load_plugin_error());
+					}
+					left++;
+				}
+			}
+		}
+	}
+	return left;
+}
+
 void survive_load_plugins(const char *plugin_dir) {
 	// The basic strategy here is to compile a list of all possible plugins, then try to load them. Some
 	// will fail if they have a dependency on other plugins which aren't loaded; and that is fine -- we
@@ -76,6 +311,7 @@ void survive_load_plugins(const char *plugin_dir) {
 	//
 	// If there are still unresolved symbols, errors are reported.
 	bool verbose = getenv("SURVIVE_PLUGIN_DEBUG") != 0;
+	bool eager = getenv("SURVIVE_PLUGINS_EAGER") != 0;
 	const char *check_from_files[] = {get_so_filename(), get_exe_filename(), getenv("SURVIVE_PLUGINS"), 0};
 	const char *plugin_dirs[] = {"plugins", "libsurvive/plugins", plugin_dir, 0};
 
@@ -98,6 +334,8 @@ void survive_load_plugins(const char *plugin_dir) {
 			if (verbose)
 				printf("survive plugins: Looking in %s\n", plugindirname);
 
+			bool has_manifest = !eager && read_manifest(plugindirname, verbose);
+
 			DIR *dir_handle = opendir(plugindirname);
 			if (dir_handle == 0)
 				continue;
@@ -108,6 +346,10 @@ void survive_load_plugins(const char *plugin_dir) {
 					char full_path[1024] = { 0 };
 					snprintf(full_path, 1024, "%s/%s", plugindirname, dir_entry->d_name);
 
+					// Plugins the manifest doesn't list, like ones built out of tree, are still loaded up front
+					if (has_manifest && manifest_entry(full_path, false))
+						continue;
+
 					if (!list_find(&plugin_list, full_path)) {
 						if (verbose) {
 							printf("survive plugins: Adding %s to plugin check list\n", full_path);
@@ -121,28 +363,15 @@ void survive_load_plugins(const char *plugin_dir) {
 		}
 	}
 
-	bool change = true;
-	while (change) {
-		change = false;
-		for (size_t i = 0; i < plugin_list.size; i++) {
-			char *plugin_path = plugin_list.data[i];
-			if (plugin_path) {
-				// Global is important to share symbols
-				void *handle = survive_load_plugin(plugin_path);
-				if (handle) {
-					if (verbose) {
-						printf("survive plugins: Loaded %s\n", plugin_path);
-					}
-					change = true;
-					free(plugin_path);
-					plugin_list.data[i] = 0;
-				} else {
-					if (verbose) {
-						printf("Initial error for %s; will retry: %s\n", plugin_path, survive_load_plugin_error());
-					}
-				}
-			}
-		}
+	double start = OGGetAbsoluteTime();
+	size_t failed = load_plugin_list(&plugin_list, verbose);
+
+	// Plugins outside of the manifest may need symbols from ones it lists
+	if (failed && manifest.cnt) {
+		if (verbose)
+			printf("survive plugins: %u plugins failed to load; loading everything in the manifest\n", (unsigned)failed);
+		survive_load_all_plugins();
+		load_plugin_list(&plugin_list, verbose);
 	}
 
 	for (size_t i = 0; i < plugin_list.size; i++) {
@@ -155,8 +384,14 @@ void survive_load_plugins(const char *plugin_dir) {
 		}
 	}
 
+	manifest.eager_time += OGGetAbsoluteTime() - start;
 	free(plugin_list.data);
 }
 #else
 void survive_load_plugins(const char *plugin_dir) {}
+bool survive_load_plugin_providing(const char *name) { return false; }
+int survive_plugin_loaded_for(const char *name) { return -1; }
+const char *survive_plugin_provided_name(int place) { return 0; }
+void survive_load_all_plugins() {}
+void survive_plugins_dump(SurviveContext *ctx) {}
 #endif
@@ -3,6 +3,7 @@
 
 #include "survive_config.h"
 #include "survive_default_devices.h"
+#include "survive_lighthouse_cache.h"
 #include "survive_recording.h"
 #include <assert.h>
 #include <survive.h>
@@ -36,6 +37,9 @@ void survive_default_imupose_process(SurviveObject *so, survive_long_timecode ti
 		assert(!isnan(((FLT *)imu2world)[i]));
 
 	SurviveContext *ctx = so->ctx;
+	if (ctx->latency_enabled)
+		survive_latency_record_sensor_to_pose(so, timecode);
+	survive_startup_observe_pose(so, &head2world);
 	SURVIVE_INVOKE_HOOK_SO(pose, so, timecode, &head2world);
 }
 void survive_default_pose_process(SurviveObject *so, survive_long_timecode timecode, const SurvivePose *pose) {
@@ -108,8 +112,10 @@ void survive_default_external_pose_process(SurviveContext *ctx, const char *name
 }
 
 void survive_default_ootx_received_process(struct SurviveContext *ctx, uint8_t bsd_idx) {
+	survive_startup_mark_lighthouse(ctx, bsd_idx, survive_startup_lighthouse_phase_ootx);
 	config_set_lighthouse(ctx->lh_config, &ctx->bsd[bsd_idx], bsd_idx);
 	config_save(ctx);
+	survive_lighthouse_cache_update(ctx, bsd_idx);
 }
 
 void survive_default_lighthouse_pose_process(SurviveContext *ctx, uint8_t lighthouse,
@@ -120,12 +126,14 @@ void survive_default_lighthouse_pose_process(SurviveContext *ctx, uint8_t lighth
 		for(int i = 0;i < 4;i++) assert(isfinite(lighthouse_pose->Rot[i]));
 		ctx->bsd[lighthouse].Pose = *lighthouse_pose;
 		ctx->bsd[lighthouse].PositionSet = 1;
+		survive_startup_mark_lighthouse(ctx, lighthouse, survive_startup_lighthouse_phase_pose);
 	} else {
 		ctx->bsd[lighthouse].PositionSet = 0;
 	}
 
 	config_set_lighthouse(ctx->lh_config, &ctx->bsd[lighthouse], lighthouse);
 	config_save(ctx);
+	survive_lighthouse_cache_update(ctx, lighthouse);
 
 	LinmathPoint3d up = {ctx->bsd[lighthouse].accel[0], ctx->bsd[lighthouse].accel[1], ctx->bsd[lighthouse].accel[2]};
 	normalize3d(up, up);
@@ -146,6 +154,7 @@ int survive_default_config_process(SurviveObject *so, char *ct0conf, int len) {
 	survive_recording_config_process(so, ct0conf, len);
 	so->conf = ct0conf;
 	so->conf_cnt = len;
+	survive_startup_mark_object(so, survive_startup_object_phase_config);
 
 	int rtn = survive_load_htc_config_format(so, ct0conf, len);
 	if (survive_configi(so->ctx, "serialize-device-config", SC_GET, 0) != 0) {
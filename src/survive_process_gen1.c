@@ -97,6 +97,7 @@ void survive_default_angle_process(SurviveObject *so, int sensor_id, int acode,
 
 	if (ctx->bsd[lh].disable)
 		return;
+	survive_startup_mark_object(so, survive_startup_object_phase_first_light);
 
 	PoserDataLightGen1 l = {
 		.common =
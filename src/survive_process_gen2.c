@@ -1,8 +1,10 @@
 #include "ootx_decoder.h"
+#include "ootx_fusion.h"
 #include "survive.h"
 #include "survive_config.h"
 #include "survive_internal.h"
 #include "survive_kalman_tracker.h"
+#include "survive_lighthouse_cache.h"
 #include "survive_recording.h"
 #include <assert.h>
 #include <math.h>
@@ -36,6 +38,7 @@ static void ootx_packet_clbk_d_gen2(ootx_decoder_context *ct, ootx_packet *packe
 
 	lighthouse_info_v15 v15;
 	init_lighthouse_info_v15(&v15, packet->data);
+	survive_lighthouse_cache_check_ootx(ctx, id, v15.id);
 
 	if (survive_configi(ctx, SERIALIZE_OOTX_TAG, SC_GET, 0) == 1) {
 		char filename[128];
@@ -91,6 +94,7 @@ static void ootx_packet_cblk_d_gen1(ootx_decoder_context *ct, ootx_packet *packe
 
 	lighthouse_info_v6 v6;
 	init_lighthouse_info_v6(&v6, packet->data);
+	survive_lighthouse_cache_check_ootx(ctx, id, v6.id);
 
 	BaseStationData *b = &ctx->bsd[id];
 	b->OOTXChecked = true;
@@ -125,6 +129,18 @@ static void ootx_packet_cblk_d_gen1(ootx_decoder_context *ct, ootx_packet *packe
 		SURVIVE_INVOKE_HOOK(ootx_received, ctx, id);
 	}
 }
+// See survive_ootx_fusion; without it, only the first device to attach feeds the decoder
+STATIC_CONFIG_ITEM(OOTX_FUSION, "ootx-fusion", 'b', "Decode OOTX from the bits of every device that sees a lighthouse",
+				   1)
+
+typedef struct survive_ootx_state {
+	// Must come first; ctx->bsd[].ootx_data points at it and is freed through it
+	ootx_decoder_context decoder;
+
+	bool fuse;
+	survive_ootx_fusion fusion;
+} survive_ootx_state;
+
 void survive_ootx_dump_decoder_context(struct SurviveContext *ctx, int bsd_idx) {
 	ootx_decoder_context *decoderContext = ctx->bsd[bsd_idx].ootx_data;
 	if (decoderContext == 0)
@@ -143,6 +159,15 @@ void survive_ootx_dump_decoder_context(struct SurviveContext *ctx, int bsd_idx)
 	FLT d = survive_run_time(ctx) - decoderContext->stats.started_s;
 	SV_VERBOSE(105, "\tTime:              %2.2f (%2.2fb/s, %2.2fb/s)", d, decoderContext->stats.bits_seen / d,
 			   decoderContext->stats.used_bytes * 8 / d);
+
+	survive_ootx_state *state = (survive_ootx_state *)decoderContext;
+	if (state->fuse) {
+		SV_VERBOSE(105, "\tFused votes:       %u (%u late)", state->fusion.stats.votes, state->fusion.stats.late_votes);
+		SV_VERBOSE(105, "\tShared bits:       %u (%u split)", state->fusion.stats.shared_bits,
+				   state->fusion.stats.split_bits);
+		SV_VERBOSE(105, "\tTied bits:         %u", state->fusion.stats.tied_bits);
+		SV_VERBOSE(105, "\tUnseen bits:       %u", state->fusion.stats.unseen_bits);
+	}
 }
 void survive_ootx_free_decoder_context(struct SurviveContext *ctx, int bsd_idx) {
 	ootx_decoder_context *decoderContext = ctx->bsd[bsd_idx].ootx_data;
@@ -154,19 +179,33 @@ void survive_ootx_free_decoder_context(struct SurviveContext *ctx, int bsd_idx)
 	ootx_free_decoder_context(decoderContext);
 	free(decoderContext);
 }
+
+static void ootx_pump(SurviveContext *ctx, int8_t bsd_idx, int8_t bit) {
+	ootx_pump_bit(ctx->bsd[bsd_idx].ootx_data, bit);
+
+	if (ctx->bsd[bsd_idx].OOTXChecked) {
+		ctx->bsd[bsd_idx].OOTXChecked = false;
+		survive_ootx_dump_decoder_context(ctx, bsd_idx);
+		// survive_ootx_free_decoder_context(ctx, bsd_idx);
+	}
+}
+
 void survive_ootx_behavior(SurviveObject *so, int8_t bsd_idx, int8_t lh_version, int ootx) {
 	struct SurviveContext *ctx = so->ctx;
 	if (ctx->bsd[bsd_idx].OOTXChecked == false) {
-		ootx_decoder_context *decoderContext = ctx->bsd[bsd_idx].ootx_data;
+		survive_ootx_state *state = (survive_ootx_state *)ctx->bsd[bsd_idx].ootx_data;
 
-		if (decoderContext == 0) {
+		if (state == 0) {
 			if (lh_version == 1) {
 				SV_INFO("OOTX not set for LH in channel %d; attaching ootx decoder using device %s",
 						ctx->bsd[bsd_idx].mode, so->codename);
 			} else {
 				SV_INFO("OOTX not set for LH %d; attaching ootx decoder using device %s", bsd_idx, so->codename);
 			}
-			decoderContext = ctx->bsd[bsd_idx].ootx_data = SV_CALLOC(sizeof(ootx_decoder_context));
+			state = SV_CALLOC(sizeof(survive_ootx_state));
+			ctx->bsd[bsd_idx].ootx_data = &state->decoder;
+
+			ootx_decoder_context *decoderContext = &state->decoder;
 			ootx_init_decoder_context(decoderContext, survive_run_time(ctx));
 			decoderContext->user1 = bsd_idx;
 			decoderContext->user = so;
@@ -174,15 +213,26 @@ void survive_ootx_behavior(SurviveObject *so, int8_t bsd_idx, int8_t lh_version,
 			decoderContext->ootx_packet_clbk = lh_version ? ootx_packet_clbk_d_gen2 : ootx_packet_cblk_d_gen1;
 			decoderContext->ootx_error_clbk = ootx_error_clbk_d;
 			decoderContext->ootx_bad_crc_clbk = ootx_bad_crc_clbk;
+
+			// Gen1 syncs from both lighthouses interleave without a fixed period to line them up by, so only gen2 is
+			// fused
+			uint8_t mode = ctx->bsd[bsd_idx].mode;
+			state->fuse = lh_version == 1 && mode < NUM_GEN2_LIGHTHOUSES &&
+						  survive_configi(ctx, OOTX_FUSION_TAG, SC_GET, 0);
+			if (state->fuse)
+				survive_ootx_fusion_init(&state->fusion, 1. / freq_per_channel[mode]);
 		}
-		if (decoderContext->user == so) {
-			ootx_pump_bit(decoderContext, ootx);
 
-			if (ctx->bsd[bsd_idx].OOTXChecked) {
-				ctx->bsd[bsd_idx].OOTXChecked = false;
-				survive_ootx_dump_decoder_context(ctx, bsd_idx);
-				// survive_ootx_free_decoder_context(ctx, bsd_idx);
+		if (state->fuse) {
+			// Skipped syncs are simply rotations without a vote
+			if (ootx >= 0) {
+				int8_t bits[OOTX_FUSION_SLOTS];
+				size_t cnt = survive_ootx_fusion_vote(&state->fusion, survive_run_time(ctx), ootx, bits);
+				for (size_t i = 0; i < cnt; i++)
+					ootx_pump(ctx, bsd_idx, bits[i]);
 			}
+		} else if (state->decoder.user == so) {
+			ootx_pump(ctx, bsd_idx, ootx);
 		}
 	}
 }
@@ -390,6 +440,7 @@ SURVIVE_EXPORT void survive_default_sweep_angle_process(SurviveObject *so, survi
 		SV_WARN("Invalid channel requested(%d) for %s", channel, so->codename)
 		return;
 	}
+	survive_startup_mark_object(so, survive_startup_object_phase_first_light);
 
 	PoserDataLightGen2 l = {
 		.common =
@@ -453,6 +504,7 @@ SURVIVE_EXPORT void survive_default_gen_detected_process(SurviveObject *so, int
 	}
 
 	ctx->lh_version = lh_version;
+	survive_startup_mark(ctx, survive_startup_phase_lh_version_detected);
 	survive_configi(ctx, "configed-lighthouse-gen", SC_OVERRIDE | SC_SETCONFIG, lh_version + 1);
 	config_save(ctx);
 }
@@ -0,0 +1,174 @@
+#include "survive_startup_profile.h"
+#include "survive.h"
+#include "survive_internal.h"
+
+#include <math.h>
+#include <os_generic.h>
+#include <string.h>
+
+static const char *phase_names[] = {"plugins loaded", "config read", "drivers started", "lh version detected"};
+static const char *object_phase_names[] = {"added", "config", "first light", "first pose", "stable pose"};
+static const char *lighthouse_phase_names[] = {"ootx", "pose"};
+
+const char *survive_startup_phase_name(enum survive_startup_phase phase) {
+	if (phase < 0 || phase >= survive_startup_phase_count)
+		return "unknown";
+	return phase_names[phase];
+}
+
+const char *survive_startup_object_phase_name(enum survive_startup_object_phase phase) {
+	if (phase < 0 || phase >= survive_startup_object_phase_count)
+		return "unknown";
+	return object_phase_names[phase];
+}
+
+const char *survive_startup_lighthouse_phase_name(enum survive_startup_lighthouse_phase phase) {
+	if (phase < 0 || phase >= survive_startup_lighthouse_phase_count)
+		return "unknown";
+	return lighthouse_phase_names[phase];
+}
+
+void survive_startup_profile_init(SurviveContext *ctx, double init_time) {
+	if (ctx->startup == 0)
+		ctx->startup = SV_CALLOC(sizeof(struct SurviveStartupProfile));
+	ctx->startup->init_time = init_time;
+}
+
+void survive_startup_profile_free(SurviveContext *ctx) {
+	free(ctx->startup);
+	ctx->startup = 0;
+}
+
+static SurviveStartupMark now_mark(SurviveContext *ctx) {
+	return (SurviveStartupMark){
+		.reached = true,
+		.wall_time = OGGetAbsoluteTime() - ctx->startup->init_time,
+		.run_time = survive_run_time(ctx),
+	};
+}
+
+void survive_startup_mark(SurviveContext *ctx, enum survive_startup_phase phase) {
+	if (ctx->startup == 0 || ctx->startup->marks[phase].reached)
+		return;
+
+	SurviveStartupMark *m = &ctx->startup->marks[phase];
+	*m = now_mark(ctx);
+	SV_VERBOSE(10, "Startup: %s at %.3fs", survive_startup_phase_name(phase), m->wall_time);
+}
+
+void survive_startup_mark_object(SurviveObject *so, enum survive_startup_object_phase phase) {
+	if (so->startup && so->startup->marks[phase].reached)
+		return;
+
+	SurviveContext *ctx = so->ctx;
+	if (ctx->startup == 0)
+		return;
+
+	if (so->startup == 0)
+		so->startup = SV_CALLOC(sizeof(struct SurviveStartupObject));
+
+	SurviveStartupMark *m = &so->startup->marks[phase];
+	*m = now_mark(ctx);
+	SV_VERBOSE(10, "Startup: %s %s at %.3fs (run time %.3fs)", survive_colorize_codename(so),
+			   survive_startup_object_phase_name(phase), m->wall_time, m->run_time);
+}
+
+void survive_startup_mark_lighthouse(SurviveContext *ctx, int lh, enum survive_startup_lighthouse_phase phase) {
+	if (ctx->startup == 0 || lh < 0 || lh >= NUM_GEN2_LIGHTHOUSES || ctx->startup->lighthouses[lh][phase].reached)
+		return;
+
+	SurviveStartupMark *m = &ctx->startup->lighthouses[lh][phase];
+	*m = now_mark(ctx);
+	SV_VERBOSE(10, "Startup: LH%d %s at %.3fs (run time %.3fs)", lh, survive_startup_lighthouse_phase_name(phase),
+			   m->wall_time, m->run_time);
+}
+
+static FLT rotation_between(const LinmathQuat a, const LinmathQuat b) {
+	FLT dot = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+	return 2 * acos(dot > 1 ? 1 : dot);
+}
+
+void survive_startup_observe_pose(SurviveObject *so, const SurvivePose *pose) {
+	struct SurviveStartupObject *s = so->startup;
+	if (s && s->marks[survive_startup_object_phase_stable_pose].reached)
+		return;
+
+	survive_startup_mark_object(so, survive_startup_object_phase_first_pose);
+	s = so->startup;
+	if (s == 0)
+		return;
+
+	SurviveStartupMark now = now_mark(so->ctx);
+	bool moved = !s->stable_since.reached || dist3d(s->stable_pose.Pos, pose->Pos) > SURVIVE_STARTUP_STABLE_DISTANCE ||
+				 rotation_between(s->stable_pose.Rot, pose->Rot) > SURVIVE_STARTUP_STABLE_ANGLE;
+	if (moved) {
+		s->stable_pose = *pose;
+		s->stable_since = now;
+	} else if (now.run_time - s->stable_since.run_time >= SURVIVE_STARTUP_STABLE_TIME) {
+		SurviveContext *ctx = so->ctx;
+		s->marks[survive_startup_object_phase_stable_pose] = s->stable_since;
+		SV_VERBOSE(10, "Startup: %s %s at %.3fs (run time %.3fs)", survive_colorize_codename(so),
+				   survive_startup_object_phase_name(survive_startup_object_phase_stable_pose),
+				   s->stable_since.wall_time, s->stable_since.run_time);
+	}
+}
+
+const SurviveStartupMark *survive_startup_get(const SurviveContext *ctx, enum survive_startup_phase phase) {
+	if (ctx->startup == 0 || phase < 0 || phase >= survive_startup_phase_count || !ctx->startup->marks[phase].reached)
+		return 0;
+	return &ctx->startup->marks[phase];
+}
+
+const SurviveStartupMark *survive_startup_get_object(const SurviveObject *so,
+													 enum survive_startup_object_phase phase) {
+	if (so->startup == 0 || phase < 0 || phase >= survive_startup_object_phase_count ||
+		!so->startup->marks[phase].reached)
+		return 0;
+	return &so->startup->marks[phase];
+}
+
+const SurviveStartupMark *survive_startup_get_lighthouse(const SurviveContext *ctx, int lh,
+														 enum survive_startup_lighthouse_phase phase) {
+	if (ctx->startup == 0 || lh < 0 || lh >= NUM_GEN2_LIGHTHOUSES || phase < 0 ||
+		phase >= survive_startup_lighthouse_phase_count || !ctx->startup->lighthouses[lh][phase].reached)
+		return 0;
+	return &ctx->startup->lighthouses[lh][phase];
+}
+
+void survive_startup_dump(SurviveContext *ctx) {
+	if (ctx->startup == 0)
+		return;
+
+	SV_INFO("Startup phases (wall time / run time since init):");
+	for (int phase = 0; phase < survive_startup_phase_count; phase++) {
+		const SurviveStartupMark *m = survive_startup_get(ctx, phase);
+		if (m) {
+			SV_INFO("\t%-8s %-20s %9.3fs", "all", survive_startup_phase_name(phase), m->wall_time);
+		}
+	}
+
+	for (int i = 0; i < ctx->objs_ct; i++) {
+		SurviveObject *so = ctx->objs[i];
+		for (int phase = 0; phase < survive_startup_object_phase_count; phase++) {
+			const SurviveStartupMark *m = survive_startup_get_object(so, phase);
+			if (m) {
+				SV_INFO("\t%-8s %-20s %9.3fs %9.3fs", so->codename, survive_startup_object_phase_name(phase),
+						m->wall_time, m->run_time);
+			}
+		}
+	}
+
+	for (int lh = 0; lh < ctx->activeLighthouses; lh++) {
+		for (int phase = 0; phase < survive_startup_lighthouse_phase_count; phase++) {
+			const SurviveStartupMark *m = survive_startup_get_lighthouse(ctx, lh, phase);
+			if (m) {
+				char name[16];
+				snprintf(name, sizeof(name), "LH%d", lh);
+				SV_INFO("\t%-8s %-20s %9.3fs %9.3fs", name, survive_startup_lighthouse_phase_name(phase),
+						m->wall_time, m->run_time);
+			}
+		}
+	}
+
+	survive_plugins_dump(ctx);
+}
@@ -0,0 +1,119 @@
+#include "survive_thread_pool.h"
+#include "survive.h"
+
+#include <os_generic.h>
+
+struct survive_thread_pool {
+	og_mutex_t run_lock;
+
+	og_mutex_t lock;
+	og_cv_t work_available;
+	og_cv_t work_done;
+	bool quit;
+
+	int thread_cnt;
+	og_thread_t *threads;
+
+	// Batch in progress; jobs is 0 when there is none
+	survive_thread_pool_fn fn;
+	void *user;
+	size_t jobs, next_job, done_jobs;
+};
+
+// Runs the next job of the current batch, if there is one left. Called and returns with the lock held.
+static bool run_next_job(struct survive_thread_pool *pool) {
+	if (pool->next_job >= pool->jobs)
+		return false;
+
+	size_t job = pool->next_job++;
+	survive_thread_pool_fn fn = pool->fn;
+	void *user = pool->user;
+
+	OGUnlockMutex(pool->lock);
+	fn(user, job);
+	OGLockMutex(pool->lock);
+
+	if (++pool->done_jobs == pool->jobs)
+		OGBroadcastCond(pool->work_done);
+	return true;
+}
+
+static void *worker_thread(void *param) {
+	struct survive_thread_pool *pool = param;
+
+	OGLockMutex(pool->lock);
+	while (!pool->quit) {
+		if (!run_next_job(pool))
+			OGWaitCond(pool->work_available, pool->lock);
+	}
+	OGUnlockMutex(pool->lock);
+	return 0;
+}
+
+struct survive_thread_pool *survive_thread_pool_create(int threads, const char *name) {
+	struct survive_thread_pool *pool = SV_CALLOC(sizeof(struct survive_thread_pool));
+	pool->run_lock = OGCreateMutex();
+	pool->lock = OGCreateMutex();
+	pool->work_available = OGCreateConditionVariable();
+	pool->work_done = OGCreateConditionVariable();
+
+	pool->thread_cnt = threads > 0 ? threads : 0;
+	pool->threads = SV_CALLOC_N(pool->thread_cnt + 1, sizeof(og_thread_t));
+	for (int i = 0; i < pool->thread_cnt; i++) {
+		pool->threads[i] = OGCreateThread(worker_thread, name, pool);
+	}
+	return pool;
+}
+
+void survive_thread_pool_free(struct survive_thread_pool *pool) {
+	if (pool == 0)
+		return;
+
+	OGLockMutex(pool->lock);
+	pool->quit = true;
+	OGBroadcastCond(pool->work_available);
+	OGUnlockMutex(pool->lock);
+
+	for (int i = 0; i < pool->thread_cnt; i++) {
+		OGJoinThread(pool->threads[i]);
+	}
+
+	OGDeleteConditionVariable(pool->work_available);
+	OGDeleteConditionVariable(pool->work_done);
+	OGDeleteMutex(pool->lock);
+	OGDeleteMutex(pool->run_lock);
+	free(pool->threads);
+	free(pool);
+}
+
+int survive_thread_pool_thread_cnt(const struct survive_thread_pool *pool) { return pool ? pool->thread_cnt : 0; }
+
+void survive_thread_pool_run(struct survive_thread_pool *pool, size_t jobs, survive_thread_pool_fn fn, void *user) {
+	if (pool == 0 || pool->thread_cnt == 0 || jobs <= 1) {
+		for (size_t i = 0; i < jobs; i++)
+			fn(user, i);
+		return;
+	}
+
+	OGLockMutex(pool->run_lock);
+	OGLockMutex(pool->lock);
+
+	pool->fn = fn;
+	pool->user = user;
+	pool->next_job = pool->done_jobs = 0;
+	pool->jobs = jobs;
+	OGBroadcastCond(pool->work_available);
+
+	while (run_next_job(pool)) {
+	}
+	while (pool->done_jobs < pool->jobs) {
+		OGWaitCond(pool->work_done, pool->lock);
+	}
+
+	pool->jobs = 0;
+	pool->fn = 0;
+	pool->user = 0;
+
+	OGUnlockMutex(pool->lock);
+	OGUnlockMutex(pool->run_lock);
+}
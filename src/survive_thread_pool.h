@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <survive_types.h>
+
+/**
+ * A fixed set of worker threads that runs batches of independent jobs. survive_thread_pool_run hands out the jobs of
+ * one batch to the workers and the calling thread, and returns once all of them finished; so the jobs can use
+ * anything the caller has on its stack.
+ *
+ * A pool runs one batch at a time; concurrent callers are serialized.
+ */
+
+typedef void (*survive_thread_pool_fn)(void *user, size_t job);
+
+struct survive_thread_pool;
+
+// With 0 threads every batch runs on the calling thread
+SURVIVE_EXPORT struct survive_thread_pool *survive_thread_pool_create(int threads, const char *name);
+SURVIVE_EXPORT void survive_thread_pool_free(struct survive_thread_pool *pool);
+
+SURVIVE_EXPORT int survive_thread_pool_thread_cnt(const struct survive_thread_pool *pool);
+SURVIVE_EXPORT void survive_thread_pool_run(struct survive_thread_pool *pool, size_t jobs, survive_thread_pool_fn fn,
+											 void *user);
@@ -0,0 +1,218 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "survive_trace.h"
+#include "os_generic.h"
+#include "survive.h"
+#include "survive_atomic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#define TRACE_CHUNK_EVENTS 16384
+
+typedef struct trace_event {
+	const char *name;
+	uint64_t start_ns;
+	uint64_t duration_ns;
+} trace_event;
+
+typedef struct trace_chunk {
+	struct trace_chunk *next;
+	size_t cnt;
+	trace_event events[TRACE_CHUNK_EVENTS];
+} trace_chunk;
+
+// Only ever written by the thread it belongs to; read once the trace stopped and no thread is recording anymore
+typedef struct trace_thread {
+	struct trace_thread *next;
+	int tid;
+	char name[32];
+	trace_chunk *head, *tail;
+	size_t event_cnt, dropped;
+} trace_thread;
+
+static struct {
+	uint32_t enabled;
+	// Threads inside survive_trace_span; survive_trace_stop waits for this to drop to 0 before touching the buffers
+	uint32_t writers;
+	// Bumped on every start, so that threads notice their buffer is from a previous trace
+	uint32_t generation;
+	uint32_t next_tid;
+	uint64_t start_ns;
+	char *filename;
+	trace_thread *threads;
+} tracer;
+
+static SURVIVE_THREAD_LOCAL trace_thread *current_thread;
+static SURVIVE_THREAD_LOCAL uint32_t current_generation;
+
+static trace_thread *trace_get_thread() {
+	uint32_t generation = SURVIVE_ATOMIC_LOAD32(&tracer.generation);
+	if (current_thread && current_generation == generation)
+		return current_thread;
+
+	trace_thread *t = SV_CALLOC(sizeof(trace_thread));
+	t->tid = (int)SURVIVE_ATOMIC_ADD32(&tracer.next_tid, 1) + 1;
+#ifdef __linux__
+	if (pthread_getname_np(pthread_self(), t->name, sizeof(t->name)) != 0)
+#endif
+		snprintf(t->name, sizeof(t->name), "thread %d", t->tid);
+
+	void *head = SURVIVE_ATOMIC_LOAD_PTR((void **)&tracer.threads);
+	for (;;) {
+		t->next = head;
+		void *prior = survive_atomic_cas_ptr((void **)&tracer.threads, head, t);
+		if (prior == head)
+			break;
+		head = prior;
+	}
+
+	current_thread = t;
+	current_generation = generation;
+	return t;
+}
+
+bool survive_trace_enabled() { return SURVIVE_ATOMIC_LOAD32(&tracer.enabled) != 0; }
+
+uint64_t survive_trace_begin() { return survive_trace_enabled() ? survive_latency_now_ns() : 0; }
+
+void survive_trace_end(const char *name, uint64_t start_ns) {
+	if (start_ns == 0)
+		return;
+	survive_trace_span(name, start_ns, survive_latency_now_ns() - start_ns);
+}
+
+static void trace_record(const char *name, uint64_t start_ns, uint64_t duration_ns) {
+	trace_thread *t = trace_get_thread();
+	if (t->event_cnt >= SURVIVE_TRACE_MAX_EVENTS_PER_THREAD) {
+		t->dropped++;
+		return;
+	}
+
+	if (t->tail == 0 || t->tail->cnt == TRACE_CHUNK_EVENTS) {
+		trace_chunk *chunk = SV_MALLOC(sizeof(trace_chunk));
+		chunk->next = 0;
+		chunk->cnt = 0;
+		if (t->tail)
+			t->tail->next = chunk;
+		else
+			t->head = chunk;
+		t->tail = chunk;
+	}
+
+	trace_event *ev = &t->tail->events[t->tail->cnt++];
+	ev->name = name;
+	ev->start_ns = start_ns;
+	ev->duration_ns = duration_ns;
+	t->event_cnt++;
+}
+
+void survive_trace_span(const char *name, uint64_t start_ns, uint64_t duration_ns) {
+	if (!survive_trace_enabled())
+		return;
+
+	// Either survive_trace_stop sees this thread as a writer and waits for it, or this thread sees the trace stopped
+	SURVIVE_ATOMIC_ADD32(&tracer.writers, 1);
+	SURVIVE_ATOMIC_FENCE();
+	if (survive_trace_enabled())
+		trace_record(name, start_ns, duration_ns);
+	SURVIVE_ATOMIC_FENCE();
+	SURVIVE_ATOMIC_ADD32(&tracer.writers, -1);
+}
+
+bool survive_trace_start(const char *filename) {
+	if (survive_trace_enabled() || filename == 0 || *filename == 0)
+		return false;
+
+	free(tracer.filename);
+	tracer.filename = strdup(filename);
+	tracer.start_ns = survive_latency_now_ns();
+	SURVIVE_ATOMIC_ADD32(&tracer.generation, 1);
+	SURVIVE_ATOMIC_STORE32(&tracer.enabled, 1);
+	return true;
+}
+
+static void write_json_string(FILE *f, const char *s) {
+	fputc('"', f);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			fputc('\\', f);
+		if ((unsigned char)*s >= 0x20)
+			fputc(*s, f);
+	}
+	fputc('"', f);
+}
+
+void survive_trace_stop(SurviveContext *ctx) {
+	if (!survive_trace_enabled())
+		return;
+	SURVIVE_ATOMIC_STORE32(&tracer.enabled, 0);
+	SURVIVE_ATOMIC_FENCE();
+	while (SURVIVE_ATOMIC_LOAD32(&tracer.writers))
+		OGUSleep(100);
+	SURVIVE_ATOMIC_FENCE();
+
+	trace_thread *threads = SURVIVE_ATOMIC_LOAD_PTR((void **)&tracer.threads);
+	for (;;) {
+		void *prior = survive_atomic_cas_ptr((void **)&tracer.threads, threads, 0);
+		if (prior == threads)
+			break;
+		threads = prior;
+	}
+
+	FILE *f = fopen(tracer.filename, "w");
+	if (f == 0) {
+		SV_WARN("Could not open trace file '%s'", tracer.filename);
+	} else {
+		// Chrome trace format; 'X' events are complete spans, times are in microseconds
+		fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"libsurvive\"}}");
+		for (trace_thread *t = threads; t; t = t->next) {
+			fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", t->tid);
+			write_json_string(f, t->name);
+			fprintf(f, "}}");
+		}
+		for (trace_thread *t = threads; t; t = t->next) {
+			for (trace_chunk *c = t->head; c; c = c->next) {
+				for (size_t i = 0; i < c->cnt; i++) {
+					const trace_event *ev = &c->events[i];
+					fprintf(f, ",\n{\"name\":");
+					write_json_string(f, ev->name);
+					fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", t->tid,
+							((int64_t)(ev->start_ns - tracer.start_ns)) / 1000., ev->duration_ns / 1000.);
+				}
+			}
+		}
+		fprintf(f, "\n]}\n");
+		fclose(f);
+	}
+
+	size_t event_cnt = 0, dropped = 0, thread_cnt = 0;
+	while (threads) {
+		trace_thread *next = threads->next;
+		event_cnt += threads->event_cnt;
+		dropped += threads->dropped;
+		thread_cnt++;
+		while (threads->head) {
+			trace_chunk *chunk = threads->head->next;
+			free(threads->head);
+			threads->head = chunk;
+		}
+		free(threads);
+		threads = next;
+	}
+
+	SV_INFO("Wrote %zu spans from %zu threads to %s", event_cnt, thread_cnt, tracer.filename);
+	if (dropped)
+		SV_WARN("%zu spans were dropped; more than %d on a thread", dropped, SURVIVE_TRACE_MAX_EVENTS_PER_THREAD);
+
+	free(tracer.filename);
+	tracer.filename = 0;
+}
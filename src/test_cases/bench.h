@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../survive_str.h"
+#include "math.h"
+#include "os_generic.h"
+#include "survive.h"
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+/**
+ * Shared pieces of the bench-* executables. Each benchmark appends its results to a JSON object; bench_main.c runs
+ * all benchmarks linked into the executable and writes one JSON document, so that results can be compared between
+ * releases by a script.
+ */
+
+typedef int (*BenchCase)(cstring *json, int argc, char **argv);
+
+#define BENCH(suite, bench_name)                                                                                       \
+	int Bench##suite##bench_name(cstring *json, int argc, char **argv);                                              \
+	REGISTER_LINKTIME(Bench##suite##bench_name)                                                                        \
+	int Bench##suite##bench_name(cstring *json, int argc, char **argv)
+
+// Minimum time each timed loop runs for; set with -t
+extern double survive_bench_seconds;
+
+// Benchmarks add to this so the compiler can't drop the work being timed
+extern volatile FLT survive_bench_sink;
+
+static inline double survive_bench_now() {
+#ifdef _WIN32
+	return OGGetAbsoluteTime();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct survive_bench_samples {
+	double *v;
+	size_t cnt, size;
+} survive_bench_samples;
+
+void survive_bench_samples_add(survive_bench_samples *s, double v);
+void survive_bench_samples_free(survive_bench_samples *s);
+
+void survive_bench_json_begin(cstring *json, const char *name);
+void survive_bench_json_end(cstring *json);
+void survive_bench_json_number(cstring *json, const char *name, double v);
+void survive_bench_json_string(cstring *json, const char *name, const char *v);
+
+// {"count", "seconds", "per_second", "ns_each"} for `count` operations that took `seconds` in total
+void survive_bench_json_rate(cstring *json, const char *name, size_t count, double seconds);
+
+// {"count", "mean_us", "min_us", "p50_us", "p90_us", "p99_us", "max_us"} of the samples; the rest are only written
+// when there is at least one sample. Sorts the samples.
+void survive_bench_json_latency(cstring *json, const char *name, survive_bench_samples *s);
+
+// Records `seconds` of a simulated session with two gen2 lighthouses to `fn`, using `config_file` as the config file
+int survive_bench_record_simulation(const char *fn, const char *config_file, int seconds);
+
+typedef int (*survive_bench_file_fn)(cstring *json, const char *fn);
+
+/**
+ * Runs `bench_file` on every recording in the benchmark arguments, inside a "files" object. Without any, a 20s
+ * simulated session is recorded to `default_recording` first, with a fresh `config_file`, and used instead.
+ */
+int survive_bench_recordings(cstring *json, int argc, char **argv, const char *default_recording,
+							 const char *config_file, survive_bench_file_fn bench_file);
@@ -0,0 +1,86 @@
+#include "../barycentric_svd/barycentric_svd.h"
+#include "bench.h"
+#include "survive_reproject.h"
+#include <stdlib.h>
+
+/**
+ * Solves per second of the barycentric SVD seed solver: with every sensor of a tracker-sized object visible, and with
+ * the 12 measurement subsets the RANSAC seeding in poser_barycentric_svd fits. One solver is reused for every solve,
+ * the way PoserDataSVD does.
+ */
+
+#define BENCH_SENSORS 32
+
+static LinmathPoint3d sensors[BENCH_SENSORS];
+static SurviveAngleReading angles[BENCH_SENSORS];
+static SurvivePose bench_obj2lh = {.Pos = {.25, -.33, -2.}, .Rot = {1, .1, .2, .3}};
+
+static void fill_m(void *user, FLT *eq, int axis, FLT angle) {
+	FLT sv = sin(angle), cv = cos(angle);
+	eq[0] = axis == 0 ? cv : 0;
+	eq[1] = axis == 1 ? cv : 0;
+	eq[2] = -sv;
+}
+
+// Sensors spread over a 10cm sphere, so no subset of them is planar; fixed seed so runs compare
+static void setup_sensors() {
+	srand(42);
+	quatnormalize(bench_obj2lh.Rot, bench_obj2lh.Rot);
+	BaseStationCal ideal_cal[2] = {0};
+	for (int i = 0; i < BENCH_SENSORS; i++) {
+		for (int j = 0; j < 3; j++)
+			sensors[i][j] = 2. * rand() / RAND_MAX - 1.;
+		normalize3d(sensors[i], sensors[i]);
+		scale3d(sensors[i], sensors[i], .1);
+
+		LinmathPoint3d ptInLh;
+		ApplyPoseToPoint(ptInLh, &bench_obj2lh, sensors[i]);
+		survive_reproject_xy(ideal_cal, ptInLh, angles[i]);
+	}
+}
+
+static void bench_solve(cstring *json, const char *name, bc_svd *bc, size_t sensor_cnt) {
+	survive_bench_json_begin(json, name);
+
+	size_t cnt = 0, failed = 0;
+	FLT err_sum = 0;
+	double start = survive_bench_now(), elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int k = 0; k < 64; k++) {
+			bc_svd_reset_correspondences(bc);
+			for (size_t i = 0; i < sensor_cnt; i++) {
+				size_t idx = (i + cnt) % BENCH_SENSORS;
+				bc_svd_add_correspondence(bc, idx, angles[idx][0], angles[idx][1]);
+			}
+
+			FLT R[3][3], t[3];
+			FLT err = bc_svd_compute_pose(bc, R, t);
+			if (err < 0) {
+				failed++;
+			} else {
+				err_sum += err;
+				survive_bench_sink += t[0];
+			}
+			cnt++;
+		}
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "solve", cnt, elapsed);
+	survive_bench_json_number(json, "failed", failed);
+	survive_bench_json_number(json, "mean_error", cnt > failed ? err_sum / (cnt - failed) : NAN);
+
+	survive_bench_json_end(json);
+}
+
+BENCH(BarycentricSVD, Solve) {
+	setup_sensors();
+
+	bc_svd bc;
+	bc_svd_bc_svd(&bc, 0, fill_m, sensors, BENCH_SENSORS);
+
+	bench_solve(json, "all_sensors", &bc, BENCH_SENSORS);
+	bench_solve(json, "ransac_subset", &bc, 6);
+
+	bc_svd_dtor(&bc);
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include "../lfsr_lh2.h"
+#include "bench.h"
+#include <stdlib.h>
+
+/**
+ * Times the gen2 channel search: building the per-polynomial position lookups, and deciphering sets of four samples
+ * the way driver_vive does for raw LH2 light data.
+ */
+
+#define BENCH_SETS 1024
+
+extern lfsr_poly_t poly_pairs[32];
+
+typedef struct sample_set {
+	uint32_t samples[4], masks[4], times[4];
+} sample_set;
+
+static sample_set sets[BENCH_SETS];
+
+static void setup_sets() {
+	srand(42);
+	for (int i = 0; i < BENCH_SETS; i++) {
+		uint32_t n = 100 + rand() % 100000;
+		for (int k = 0; k < 4; k++) {
+			uint32_t nk = n + k * 41;
+			sets[i].samples[k] = lsfr_iterate(1, poly_pairs[i % 32], nk);
+			sets[i].times[k] = 8 * nk;
+			// Holes only in the newest bits, so each sample can be solved on its own
+			sets[i].masks[k] = ~(1u << (rand() % 14));
+		}
+	}
+}
+
+// One polynomial checked against one sample, the way the search did it before it was bit-sliced
+static uint32_t scalar_poly_check(uint32_t sample, uint32_t mask, lfsr_poly_t poly) {
+	uint32_t state = sample >> 15;
+	uint32_t final_state = lsfr_iterate(lsfr_iterate_rev(state, poly, 0), poly, 15);
+	return popcnt((final_state ^ sample) & mask);
+}
+
+BENCH(LFSR, Channel) {
+	setup_sets();
+
+	double start = survive_bench_now();
+	struct lfsr_lookup_t *lookups[32];
+	for (int i = 0; i < 32; i++)
+		lookups[i] = lfsr_lookup_ctor(poly_pairs[i]);
+	survive_bench_json_number(json, "lookup_ctor_all_ms", (survive_bench_now() - start) * 1000.);
+
+	size_t cnt = 0;
+	start = survive_bench_now();
+	double elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_SETS; i++) {
+			uint32_t output[4];
+			for (int k = 0; k < 4; k++)
+				output[k] = lfsr_lookup_query(lookups[i % 32], sets[i].samples[k] >> 15);
+			survive_bench_sink += output[0];
+		}
+		cnt += BENCH_SETS * 4;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "lookup_query", cnt, elapsed);
+
+	for (int i = 0; i < 32; i++)
+		lfsr_lookup_free(lookups[i]);
+
+	size_t solved = 0;
+	cnt = 0;
+	start = survive_bench_now();
+	elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_SETS; i++) {
+			uint32_t output[4];
+			survive_channel channel =
+				survive_decipher_channel(sets[i].samples, sets[i].masks, sets[i].times, output, 4);
+			solved += channel == i % 32;
+		}
+		cnt += BENCH_SETS;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "decipher_channel", cnt, elapsed);
+	survive_bench_json_number(json, "decipher_solved_ratio", solved / (double)cnt);
+
+	cnt = 0;
+	start = survive_bench_now();
+	elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_SETS; i++) {
+			for (int p = 0; p < 32; p++)
+				survive_bench_sink += scalar_poly_check(sets[i].samples[0], sets[i].masks[0], poly_pairs[p]);
+		}
+		cnt += BENCH_SETS;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "scalar_32_poly_check", cnt, elapsed);
+	return 0;
+}
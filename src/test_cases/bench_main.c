@@ -0,0 +1,214 @@
+#include "../survive_internal.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+double survive_bench_seconds = 1.;
+volatile FLT survive_bench_sink;
+
+void survive_bench_samples_add(survive_bench_samples *s, double v) {
+	if (s->cnt == s->size) {
+		s->size = s->size ? s->size * 2 : 1024;
+		s->v = SV_REALLOC(s->v, s->size * sizeof(double));
+	}
+	s->v[s->cnt++] = v;
+}
+
+void survive_bench_samples_free(survive_bench_samples *s) {
+	free(s->v);
+	*s = (survive_bench_samples){0};
+}
+
+static void json_key(cstring *json, const char *name) {
+	char last = json->length ? json->d[json->length - 1] : '{';
+	if (last != '{')
+		str_append(json, ", ");
+	if (name)
+		str_append_printf(json, "\"%s\": ", name);
+}
+
+void survive_bench_json_begin(cstring *json, const char *name) {
+	json_key(json, name);
+	str_append(json, "{");
+}
+
+void survive_bench_json_end(cstring *json) { str_append(json, "}"); }
+
+void survive_bench_json_number(cstring *json, const char *name, double v) {
+	json_key(json, name);
+	// JSON has no representation for these
+	if (isnan(v) || isinf(v)) {
+		str_append(json, "null");
+	} else {
+		str_append_printf(json, "%.9g", v);
+	}
+}
+
+void survive_bench_json_string(cstring *json, const char *name, const char *v) {
+	json_key(json, name);
+	str_append(json, "\"");
+	for (const char *c = v; c && *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			str_append_printf(json, "\\%c", *c);
+		} else if ((unsigned char)*c < 0x20) {
+			str_append_printf(json, "\\u%04x", *c);
+		} else {
+			str_append_n(json, c, 1);
+		}
+	}
+	str_append(json, "\"");
+}
+
+void survive_bench_json_rate(cstring *json, const char *name, size_t count, double seconds) {
+	survive_bench_json_begin(json, name);
+	survive_bench_json_number(json, "count", (double)count);
+	survive_bench_json_number(json, "seconds", seconds);
+	survive_bench_json_number(json, "per_second", seconds > 0 ? count / seconds : 0);
+	survive_bench_json_number(json, "ns_each", count > 0 ? seconds / count * 1e9 : 0);
+	survive_bench_json_end(json);
+}
+
+static int compare_double(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static double percentile(const survive_bench_samples *s, double p) {
+	size_t idx = (size_t)(p * (s->cnt - 1) + .5);
+	return s->v[idx];
+}
+
+void survive_bench_json_latency(cstring *json, const char *name, survive_bench_samples *s) {
+	survive_bench_json_begin(json, name);
+	survive_bench_json_number(json, "count", (double)s->cnt);
+	if (s->cnt > 0) {
+		qsort(s->v, s->cnt, sizeof(double), compare_double);
+
+		double sum = 0;
+		for (size_t i = 0; i < s->cnt; i++)
+			sum += s->v[i];
+
+		survive_bench_json_number(json, "mean_us", sum / s->cnt * 1e6);
+		survive_bench_json_number(json, "min_us", s->v[0] * 1e6);
+		survive_bench_json_number(json, "p50_us", percentile(s, .5) * 1e6);
+		survive_bench_json_number(json, "p90_us", percentile(s, .9) * 1e6);
+		survive_bench_json_number(json, "p99_us", percentile(s, .99) * 1e6);
+		survive_bench_json_number(json, "max_us", s->v[s->cnt - 1] * 1e6);
+	}
+	survive_bench_json_end(json);
+}
+
+int survive_bench_record_simulation(const char *fn, const char *config_file, int seconds) {
+	char seconds_str[16];
+	snprintf(seconds_str, sizeof(seconds_str), "%d", seconds);
+	char *args[] = {"bench",		 "--simulator",	  "--simulator-lh-gen", "2",		 "--simulator-time",
+					seconds_str,	 "--time-factor", "0",					"--record", (char *)fn,
+					"--configfile", (char *)config_file};
+
+	SurviveContext *ctx = survive_init(SURVIVE_ARRAY_SIZE(args), args);
+	if (ctx == 0)
+		return -1;
+
+	int rtn = survive_startup(ctx);
+	while (rtn == 0 && survive_poll(ctx) == 0) {
+	}
+	survive_close(ctx);
+	return rtn;
+}
+
+int survive_bench_recordings(cstring *json, int argc, char **argv, const char *default_recording,
+							 const char *config_file, survive_bench_file_fn bench_file) {
+	int rtn = 0;
+	int file_cnt = 0;
+	survive_bench_json_begin(json, "files");
+	for (int i = 0; i < argc; i++) {
+		if (argv[i][0] == '-')
+			continue;
+		rtn |= bench_file(json, argv[i]);
+		file_cnt++;
+	}
+
+	if (file_cnt == 0) {
+		remove(config_file);
+		rtn = survive_bench_record_simulation(default_recording, config_file, 20);
+		if (rtn == 0)
+			rtn = bench_file(json, default_recording);
+	}
+	survive_bench_json_end(json);
+	return rtn;
+}
+
+static void usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-o output.json] [-t seconds] [filter] [-- benchmark arguments]\n", name);
+}
+
+int main(int argc, char **argv) {
+	const char *output = 0;
+	const char *filter = "";
+	int bench_argc = 0;
+	char **bench_argv = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--") == 0) {
+			bench_argc = argc - i - 1;
+			bench_argv = argv + i + 1;
+			break;
+		} else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			survive_bench_seconds = atof(argv[++i]);
+		} else if (argv[i][0] == '-') {
+			usage(argv[0]);
+			return -1;
+		} else {
+			filter = argv[i];
+		}
+	}
+
+	cstring json = {0};
+	str_append(&json, "{");
+	survive_bench_json_string(&json, "build", survive_build_tag());
+	survive_bench_json_number(&json, "flt_size", sizeof(FLT));
+	survive_bench_json_begin(&json, "benchmarks");
+
+	bool failed = false;
+	int i = 0;
+	const char *DriverName = 0;
+	while ((DriverName = GetDriverNameMatching("Bench", i++))) {
+		if (strstr(DriverName, filter) == NULL) {
+			continue;
+		}
+		BenchCase bench = (BenchCase)GetDriver(DriverName);
+		DriverName += 5; // Drop the 'Bench' prefix
+
+		fprintf(stderr, "Running benchmark %s...\n", DriverName);
+		survive_bench_json_begin(&json, DriverName);
+		double start = survive_bench_now();
+		int r = bench(&json, bench_argc, bench_argv);
+		survive_bench_json_number(&json, "status", r);
+		survive_bench_json_number(&json, "wall_seconds", survive_bench_now() - start);
+		survive_bench_json_end(&json);
+
+		if (r != 0) {
+			fprintf(stderr, "Benchmark %s reports status %d\n", DriverName, r);
+		}
+		failed |= r != 0;
+	}
+
+	survive_bench_json_end(&json);
+	str_append(&json, "}\n");
+
+	FILE *f = output ? fopen(output, "w") : stdout;
+	if (f == 0) {
+		fprintf(stderr, "Could not open %s\n", output);
+		str_free(&json);
+		return -1;
+	}
+	fputs(json.d, f);
+	if (output)
+		fclose(f);
+
+	str_free(&json);
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,164 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Accuracy against time of capping the light measurements of MPFIT tracking solves (mpfit-max-meas). Every recording is
+ * replayed with all measurements, and then once per cap; the Kalman filter is off so every reported pose is a solve.
+ * Poses of capped runs are compared to the uncapped pose the same object reported at the same timecode. Recordings are
+ * taken from the benchmark arguments; without any, a simulated session is recorded first.
+ */
+
+#define DEFAULT_RECORDING "bench-mpfit-cap.rec.gz"
+#define CONFIG_FILE "bench-mpfit-cap-config.json"
+#define MAX_OBJECTS 16
+
+static const int caps[] = {64, 32, 16, 12};
+
+typedef struct bench_pose {
+	survive_long_timecode timecode;
+	SurvivePose pose;
+} bench_pose;
+
+typedef struct bench_object_poses {
+	char codename[16];
+	bench_pose *poses;
+	size_t cnt, size;
+} bench_object_poses;
+
+static bench_object_poses reference[MAX_OBJECTS];
+static bool recording_reference;
+
+static struct {
+	size_t poses, matched;
+	FLT pos_err_sum, pos_err_max;
+	FLT rot_err_sum, rot_err_max;
+} compare;
+
+static bench_object_poses *object_poses(const char *codename) {
+	for (int i = 0; i < MAX_OBJECTS; i++) {
+		if (reference[i].codename[0] == 0 && recording_reference)
+			strncpy(reference[i].codename, codename, sizeof(reference[i].codename) - 1);
+		if (strcmp(reference[i].codename, codename) == 0)
+			return &reference[i];
+	}
+	return 0;
+}
+
+static const SurvivePose *find_reference(const bench_object_poses *p, survive_long_timecode timecode) {
+	size_t lo = 0, hi = p->cnt;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (p->poses[mid].timecode < timecode)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < p->cnt && p->poses[lo].timecode == timecode ? &p->poses[lo].pose : 0;
+}
+
+static void record_pose(SurviveObject *so, survive_long_timecode timecode, const SurvivePose *pose) {
+	bench_object_poses *p = object_poses(so->codename);
+	if (p == 0)
+		return;
+
+	if (recording_reference) {
+		// Solves finish in timecode order; the occasional repeat keeps the first pose
+		if (p->cnt && p->poses[p->cnt - 1].timecode >= timecode)
+			return;
+		if (p->cnt == p->size) {
+			p->size = p->size ? 2 * p->size : 1024;
+			p->poses = realloc(p->poses, sizeof(bench_pose) * p->size);
+		}
+		p->poses[p->cnt++] = (bench_pose){.timecode = timecode, .pose = *pose};
+		return;
+	}
+
+	compare.poses++;
+	const SurvivePose *ref = find_reference(p, timecode);
+	if (ref == 0)
+		return;
+
+	FLT pos_err = dist3d(ref->Pos, pose->Pos);
+	FLT dot = fabs(ref->Rot[0] * pose->Rot[0] + ref->Rot[1] * pose->Rot[1] + ref->Rot[2] * pose->Rot[2] +
+				   ref->Rot[3] * pose->Rot[3]);
+	FLT rot_err = 2 * acos(dot > 1 ? 1 : dot);
+
+	compare.matched++;
+	compare.pos_err_sum += pos_err;
+	compare.rot_err_sum += rot_err;
+	compare.pos_err_max = linmath_max(compare.pos_err_max, pos_err);
+	compare.rot_err_max = linmath_max(compare.rot_err_max, rot_err);
+}
+
+static int replay(cstring *json, const char *fn, int cap) {
+	char cap_str[16], name[32];
+	snprintf(cap_str, sizeof(cap_str), "%d", cap);
+	snprintf(name, sizeof(name), cap ? "cap_%d" : "all", cap);
+
+	char *args[] = {"bench-mpfit-cap", "--playback",	   (char *)fn,		 "--playback-factor", "0",
+					"--poser",		   "MPFIT",			   "--use-kalman",	 "0",				  "--mpfit-max-meas",
+					cap_str,		   "--configfile",	   CONFIG_FILE};
+
+	// Every run starts from the same, empty, calibration
+	remove(CONFIG_FILE);
+	SurviveContext *ctx = survive_init(SURVIVE_ARRAY_SIZE(args), args);
+	if (ctx == 0)
+		return -1;
+
+	memset(&compare, 0, sizeof(compare));
+	recording_reference = cap == 0;
+	survive_install_imupose_fn(ctx, record_pose);
+
+	double start = survive_bench_now();
+	int rtn = survive_startup(ctx);
+	while (rtn == 0 && survive_poll(ctx) == 0) {
+	}
+	double elapsed = survive_bench_now() - start;
+	survive_close(ctx);
+
+	size_t poses = compare.poses;
+	if (recording_reference) {
+		for (int i = 0; i < MAX_OBJECTS; i++)
+			poses += reference[i].cnt;
+	}
+
+	survive_bench_json_begin(json, name);
+	survive_bench_json_number(json, "replay_seconds", elapsed);
+	survive_bench_json_rate(json, "poses", poses, elapsed);
+	if (!recording_reference) {
+		survive_bench_json_number(json, "matched_poses", compare.matched);
+		survive_bench_json_number(json, "mean_position_error_mm",
+								  compare.matched ? 1000. * compare.pos_err_sum / compare.matched : NAN);
+		survive_bench_json_number(json, "max_position_error_mm", 1000. * compare.pos_err_max);
+		survive_bench_json_number(json, "mean_rotation_error_deg",
+								  compare.matched ? compare.rot_err_sum / compare.matched / LINMATHPI * 180. : NAN);
+		survive_bench_json_number(json, "max_rotation_error_deg", compare.rot_err_max / LINMATHPI * 180.);
+	}
+	survive_bench_json_end(json);
+	return rtn;
+}
+
+static int bench_file(cstring *json, const char *fn) {
+	for (int i = 0; i < MAX_OBJECTS; i++) {
+		free(reference[i].poses);
+		reference[i] = (bench_object_poses){0};
+	}
+
+	survive_bench_json_begin(json, fn);
+	int rtn = replay(json, fn, 0);
+	for (size_t i = 0; i < SURVIVE_ARRAY_SIZE(caps) && rtn == 0; i++)
+		rtn |= replay(json, fn, caps[i]);
+	survive_bench_json_end(json);
+	return rtn;
+}
+
+BENCH(MPFIT, MeasurementCap) {
+	int rtn = survive_bench_recordings(json, argc, argv, DEFAULT_RECORDING, CONFIG_FILE, bench_file);
+
+	for (int i = 0; i < MAX_OBJECTS; i++)
+		free(reference[i].poses);
+	remove(CONFIG_FILE);
+	return rtn;
+}
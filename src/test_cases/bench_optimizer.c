@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "survive_optimizer.h"
+#include "survive_reproject.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SENSORS 20
+
+static survive_optimizer_settings settings = {
+	.optimize_scale_threshold = -1,
+};
+
+static FLT sensors[BENCH_SENSORS * 3];
+
+// A wand-sized object seen by a single lighthouse; the same shape of problem PoserMPFIT solves on every sync
+static void setup_sensors() {
+	srand(42);
+	for (int i = 0; i < BENCH_SENSORS; i++) {
+		FLT azi = 2. * LINMATHPI * rand() / RAND_MAX;
+		FLT pol = LINMATHPI * rand() / RAND_MAX;
+		sensors[i * 3 + 0] = .05 * cos(azi) * sin(pol);
+		sensors[i * 3 + 1] = .05 * sin(azi) * sin(pol);
+		sensors[i * 3 + 2] = .05 * cos(pol);
+	}
+}
+
+static double solve(const SurvivePose *gt, const SurvivePose *seed, mp_result *result) {
+	survive_optimizer mpfitctx = {
+		.settings = &settings,
+		.reprojectModel = &survive_reproject_gen1_model,
+		.poseLength = 1,
+		.cameraLength = 1,
+		.objectUpVectorVariance = -1,
+		.disableVelocity = true,
+		.cfg = survive_optimizer_precise_config(),
+		.ptsLength = BENCH_SENSORS * 2,
+	};
+	SURVIVE_OPTIMIZER_SETUP_STACK_BUFFERS(mpfitctx);
+
+	SurvivePose lh_pose = {.Pos = {0, 0, -5}, .Rot = {1}};
+	SurvivePose ilh = InvertPoseRtn(&lh_pose);
+	BaseStationCal bcal[2] = {0};
+
+	survive_optimizer_setup_pose(&mpfitctx, seed, false, 1);
+	survive_optimizer_setup_camera(&mpfitctx, 0, &ilh, true, 1);
+	survive_optimizer_parameter *pt_params =
+		survive_optimizer_emplace_params(&mpfitctx, survive_optimizer_parameter_obj_points, BENCH_SENSORS);
+	memcpy(pt_params->p, sensors, sizeof(sensors));
+	survive_optimizer_parameter *bsd_params =
+		survive_optimizer_emplace_params(&mpfitctx, survive_optimizer_parameter_camera_parameters, 1);
+	memset(bsd_params->p, 0, bsd_params->size * sizeof(FLT));
+
+	for (int axis = 0; axis < 2; axis++) {
+		for (int j = 0; j < BENCH_SENSORS; j++) {
+			survive_optimizer_measurement *meas =
+				survive_optimizer_emplace_meas(&mpfitctx, survive_optimizer_measurement_type_light);
+			meas->variance = 1e-4;
+			meas->light.sensor_idx = j;
+			meas->light.axis = axis;
+
+			FLT out[2];
+			survive_reproject_full(bcal, &lh_pose, gt, &sensors[j * 3], out);
+			meas->light.value = out[axis];
+		}
+	}
+
+	double start = survive_bench_now();
+	survive_optimizer_run(&mpfitctx, result, 0);
+	return survive_bench_now() - start;
+}
+
+BENCH(Optimizer, SinglePose) {
+	setup_sensors();
+	srand(1);
+
+	survive_bench_samples latency = {0};
+	size_t converged = 0;
+	double total = 0;
+	while (total < survive_bench_seconds) {
+		SurvivePose gt = {.Pos = {.2 * rand() / RAND_MAX, .2 * rand() / RAND_MAX, .2 * rand() / RAND_MAX}};
+		for (int i = 0; i < 4; i++)
+			gt.Rot[i] = 2. * rand() / RAND_MAX - 1;
+		quatnormalize(gt.Rot, gt.Rot);
+
+		// Start from a perturbed pose, as the poser does from the last known one
+		SurvivePose seed = gt;
+		for (int i = 0; i < 3; i++)
+			seed.Pos[i] += .02 * rand() / RAND_MAX - .01;
+		for (int i = 0; i < 4; i++)
+			seed.Rot[i] += .02 * rand() / RAND_MAX - .01;
+		quatnormalize(seed.Rot, seed.Rot);
+
+		mp_result result = {0};
+		double t = solve(&gt, &seed, &result);
+		survive_bench_samples_add(&latency, t);
+		total += t;
+		converged += result.bestnorm < 1e-3;
+	}
+
+	survive_bench_json_latency(json, "survive_optimizer_run", &latency);
+	survive_bench_json_number(json, "converged_ratio", latency.cnt ? converged / (double)latency.cnt : 0);
+	survive_bench_samples_free(&latency);
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include "../survive_kalman_tracker.h"
+#include "bench.h"
+#include <poser.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Runs the simulator as fast as it can go (see --time-factor 0) with the MPFIT poser, and times the stages of the
+ * light and IMU pipeline through wrapped hooks. Extra arguments after '--' are passed on to libsurvive, so for
+ * instance '-- --simulator-objects 4' measures a busier scene.
+ */
+
+#define CAPTURE_SIZE (1 << 15)
+
+typedef union {
+	PoserData hdr;
+	PoserDataIMU imu;
+	PoserDataLightGen2 light;
+} captured_poser_data;
+
+typedef struct bench_pipeline {
+	sweep_angle_process_func sweep_angle_fn;
+	imu_process_func imu_fn;
+	PoserCB poser_fn;
+
+	size_t sweep_angle_cnt, imu_cnt;
+	double sweep_angle_time, imu_time;
+
+	survive_bench_samples poser_latency[POSERDATA_GLOBAL_SCENES + 1];
+
+	// Most recent tracker input of the first object; replayed into its tracker once the simulation is done
+	captured_poser_data *captured;
+	size_t captured_cnt;
+} bench_pipeline;
+
+static void bench_sweep_angle(SurviveObject *so, survive_channel channel, int sensor_id, survive_timecode timecode,
+							  int8_t plane, FLT angle) {
+	bench_pipeline *bench = so->ctx->user_ptr;
+	double start = survive_bench_now();
+	bench->sweep_angle_fn(so, channel, sensor_id, timecode, plane, angle);
+	bench->sweep_angle_time += survive_bench_now() - start;
+	bench->sweep_angle_cnt++;
+}
+
+static void bench_imu(SurviveObject *so, int mask, const FLT *accelgyro, survive_timecode timecode, int id) {
+	bench_pipeline *bench = so->ctx->user_ptr;
+	double start = survive_bench_now();
+	bench->imu_fn(so, mask, accelgyro, timecode, id);
+	bench->imu_time += survive_bench_now() - start;
+	bench->imu_cnt++;
+}
+
+static int bench_poser(SurviveObject *so, void **user, PoserData *pd) {
+	bench_pipeline *bench = so->ctx->user_ptr;
+	double start = survive_bench_now();
+	int rtn = bench->poser_fn(so, user, pd);
+	double t = survive_bench_now() - start;
+
+	if (pd->pt <= POSERDATA_GLOBAL_SCENES)
+		survive_bench_samples_add(&bench->poser_latency[pd->pt], t);
+
+	bool is_tracker_input = pd->pt == POSERDATA_IMU || pd->pt == POSERDATA_LIGHT_GEN2 || pd->pt == POSERDATA_SYNC_GEN2;
+	if (so == so->ctx->objs[0] && is_tracker_input) {
+		captured_poser_data *c = &bench->captured[bench->captured_cnt++ % CAPTURE_SIZE];
+		memcpy(c, pd, pd->pt == POSERDATA_IMU ? sizeof(PoserDataIMU) : sizeof(PoserDataLightGen2));
+	}
+	return rtn;
+}
+
+/*
+ * The tracker only does its full update once it is tracking, so its cost is measured on the live tracker after the
+ * run. The captured data is shifted forward in time so that it arrives in order; the pose jumps back at the seam, which
+ * doesn't change how much work an update is.
+ */
+static void bench_kalman_replay(cstring *json, bench_pipeline *bench, SurviveObject *so) {
+	survive_bench_samples imu = {0}, light = {0};
+
+	size_t cnt = bench->captured_cnt < CAPTURE_SIZE ? bench->captured_cnt : CAPTURE_SIZE;
+	size_t first = bench->captured_cnt - cnt;
+	if (cnt == 0 || so->tracker == 0)
+		return;
+
+	survive_long_timecode start_time = bench->captured[first % CAPTURE_SIZE].hdr.timecode;
+	survive_long_timecode end_time = bench->captured[(bench->captured_cnt - 1) % CAPTURE_SIZE].hdr.timecode;
+	survive_long_timecode shift = end_time - start_time + so->timebase_hz / 1000;
+
+	for (size_t i = first; i < bench->captured_cnt; i++) {
+		captured_poser_data c = bench->captured[i % CAPTURE_SIZE];
+		c.hdr.timecode += shift;
+
+		double start = survive_bench_now();
+		if (c.hdr.pt == POSERDATA_IMU) {
+			survive_kalman_tracker_integrate_imu(so->tracker, &c.imu);
+			survive_bench_samples_add(&imu, survive_bench_now() - start);
+		} else {
+			survive_kalman_tracker_integrate_light(so->tracker, &c.light.common);
+			survive_bench_samples_add(&light, survive_bench_now() - start);
+		}
+	}
+
+	survive_bench_json_latency(json, "kalman_integrate_imu", &imu);
+	survive_bench_json_latency(json, "kalman_integrate_light", &light);
+	survive_bench_samples_free(&imu);
+	survive_bench_samples_free(&light);
+}
+
+BENCH(Pipeline, Simulated) {
+	char *args[64] = {"bench-pipeline",
+					  "--simulator",
+					  "--simulator-lh-gen",
+					  "2",
+					  "--simulator-show-gt",
+					  "0",
+					  "--simulator-time",
+					  "20",
+					  "--time-factor",
+					  "0",
+					  "--poser",
+					  "MPFIT",
+					  "--no-threaded-posers",
+					  "--configfile",
+					  "bench-pipeline-config.json"};
+	int args_cnt = 15;
+	for (int i = 0; i < argc && args_cnt < SURVIVE_ARRAY_SIZE(args); i++)
+		args[args_cnt++] = argv[i];
+
+	bench_pipeline bench = {.captured = SV_CALLOC(CAPTURE_SIZE * sizeof(captured_poser_data))};
+
+	SurviveContext *ctx = survive_init(args_cnt, args);
+	if (ctx == 0) {
+		free(bench.captured);
+		return -1;
+	}
+	ctx->user_ptr = &bench;
+
+	bench.sweep_angle_fn = survive_install_sweep_angle_fn(ctx, bench_sweep_angle);
+	bench.imu_fn = survive_install_imu_fn(ctx, bench_imu);
+
+	int rtn = survive_startup(ctx);
+	if (rtn == 0) {
+		bench.poser_fn = ctx->PoserFn;
+		ctx->PoserFn = bench_poser;
+
+		double start = survive_bench_now();
+		while (survive_poll(ctx) == 0) {
+		}
+		double elapsed = survive_bench_now() - start;
+
+		survive_bench_json_number(json, "simulated_seconds", survive_run_time(ctx));
+		survive_bench_json_number(json, "speedup", survive_run_time(ctx) / elapsed);
+		survive_bench_json_rate(json, "sweep_angle_process", bench.sweep_angle_cnt, bench.sweep_angle_time);
+		survive_bench_json_rate(json, "imu_process", bench.imu_cnt, bench.imu_time);
+		survive_bench_json_number(json, "sweep_angle_events_per_wall_second", bench.sweep_angle_cnt / elapsed);
+
+		// For MPFIT the sync latency is that of survive_optimizer_run; light and IMU data is only accumulated
+		survive_bench_json_latency(json, "mpfit_sync", &bench.poser_latency[POSERDATA_SYNC_GEN2]);
+		survive_bench_json_latency(json, "mpfit_light", &bench.poser_latency[POSERDATA_LIGHT_GEN2]);
+		survive_bench_json_latency(json, "mpfit_imu", &bench.poser_latency[POSERDATA_IMU]);
+
+		if (ctx->objs_ct > 0)
+			bench_kalman_replay(json, &bench, ctx->objs[0]);
+
+		ctx->PoserFn = bench.poser_fn;
+	}
+
+	survive_close(ctx);
+
+	for (int i = 0; i <= POSERDATA_GLOBAL_SCENES; i++)
+		survive_bench_samples_free(&bench.poser_latency[i]);
+	free(bench.captured);
+	return rtn;
+}
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * Measures how fast recordings are read back. Every data hook is replaced by a counter so that the time is spent
+ * reading and parsing the file rather than in tracking. Recordings are taken from the benchmark arguments; without any,
+ * a simulated session is recorded first.
+ */
+
+#define DEFAULT_RECORDING "bench-playback.rec.gz"
+#define CONFIG_FILE "bench-playback-config.json"
+
+static size_t event_cnt;
+
+static void count_light(SurviveObject *so, int sensor_id, int acode, int timeinsweep, survive_timecode timecode,
+						survive_timecode length, uint32_t lighthouse) {
+	event_cnt++;
+}
+static void count_angle(SurviveObject *so, int sensor_id, int acode, survive_timecode timecode, FLT length, FLT angle,
+						uint32_t lh) {
+	event_cnt++;
+}
+static void count_sync(SurviveObject *so, survive_channel channel, survive_timecode timeofsync, bool ootx, bool gen) {
+	event_cnt++;
+}
+static void count_sweep(SurviveObject *so, survive_channel channel, int sensor_id, survive_timecode timecode,
+						bool flag) {
+	event_cnt++;
+}
+static void count_sweep_angle(SurviveObject *so, survive_channel channel, int sensor_id, survive_timecode timecode,
+							  int8_t plane, FLT angle) {
+	event_cnt++;
+}
+static void count_imu(SurviveObject *so, int mask, const FLT *accelgyro, survive_timecode timecode, int id) {
+	event_cnt++;
+}
+
+static int bench_file(cstring *json, const char *fn) {
+	char *args[] = {"bench-playback", "--playback", (char *)fn, "--playback-factor", "0", "--configfile", CONFIG_FILE};
+
+	SurviveContext *ctx = survive_init(SURVIVE_ARRAY_SIZE(args), args);
+	if (ctx == 0)
+		return -1;
+
+	event_cnt = 0;
+	survive_install_light_fn(ctx, count_light);
+	survive_install_angle_fn(ctx, count_angle);
+	survive_install_sync_fn(ctx, count_sync);
+	survive_install_sweep_fn(ctx, count_sweep);
+	survive_install_sweep_angle_fn(ctx, count_sweep_angle);
+	survive_install_imu_fn(ctx, count_imu);
+
+	double start = survive_bench_now();
+	int rtn = survive_startup(ctx);
+	while (rtn == 0 && survive_poll(ctx) == 0) {
+	}
+	double elapsed = survive_bench_now() - start;
+	survive_close(ctx);
+
+	struct stat st = {0};
+	stat(fn, &st);
+
+	survive_bench_json_begin(json, fn);
+	survive_bench_json_number(json, "file_bytes", (double)st.st_size);
+	survive_bench_json_number(json, "file_mb_per_second", st.st_size / elapsed / 1e6);
+	survive_bench_json_rate(json, "events", event_cnt, elapsed);
+	survive_bench_json_end(json);
+	return rtn;
+}
+
+BENCH(Playback, Parse) {
+	return survive_bench_recordings(json, argc, argv, DEFAULT_RECORDING, CONFIG_FILE, bench_file);
+}
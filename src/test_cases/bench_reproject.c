@@ -0,0 +1,83 @@
+#include "bench.h"
+#include "survive_reproject.h"
+#include <stdlib.h>
+#include <survive_reproject_gen2.h>
+
+#define BENCH_POINTS 1024
+
+static const BaseStationCal bench_cal[2] = {
+	{0.0228424072265625, -0.00945281982421875, 0.0023136138916015625, 1.810546875, 0.0206146240234375, 0, 0},
+	{0.0290985107421875, -0.00785064697265625, 0.0020542144775390625, -1.1767578125, -0.01227569580078125, 0, 0}};
+
+static LinmathPoint3d points[BENCH_POINTS];
+
+// Points in front of a lighthouse at the usual tracking distances; fixed seed so runs compare
+static void setup_points() {
+	srand(42);
+	for (int i = 0; i < BENCH_POINTS; i++) {
+		points[i][0] = 2. * rand() / RAND_MAX - 1.;
+		points[i][1] = 2. * rand() / RAND_MAX - 1.;
+		points[i][2] = -1. - 3. * rand() / RAND_MAX;
+	}
+}
+
+static void bench_model(cstring *json, const char *name, const survive_reproject_model_t *model) {
+	setup_points();
+
+	SurvivePose world2lh = {.Pos = {.1, .2, -.3}, .Rot = {1}};
+	SurvivePose obj2world = {.Pos = {0, 0, -2}, .Rot = {0, 1, 0, 0}};
+
+	survive_bench_json_begin(json, name);
+
+	size_t cnt = 0;
+	double start = survive_bench_now(), elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_POINTS; i++) {
+			SurviveAngleReading ang;
+			model->reprojectXY(bench_cal, points[i], ang);
+			survive_bench_sink += ang[0] + ang[1];
+		}
+		cnt += BENCH_POINTS;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "xy", cnt, elapsed);
+
+	cnt = 0;
+	start = survive_bench_now();
+	elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_POINTS; i++) {
+			FLT v = model->reprojectAxisFullFn[i & 1](&obj2world, points[i], &world2lh, bench_cal);
+			survive_bench_sink += v;
+		}
+		cnt += BENCH_POINTS;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "full_axis", cnt, elapsed);
+
+	cnt = 0;
+	start = survive_bench_now();
+	elapsed = 0;
+	while (elapsed < survive_bench_seconds) {
+		for (int i = 0; i < BENCH_POINTS; i++) {
+			FLT jac[7 * 2];
+			model->reprojectFullJacObjPose(jac, &obj2world, points[i], &world2lh, bench_cal);
+			survive_bench_sink += jac[0] + jac[13];
+		}
+		cnt += BENCH_POINTS;
+		elapsed = survive_bench_now() - start;
+	}
+	survive_bench_json_rate(json, "full_jac_obj_pose", cnt, elapsed);
+
+	survive_bench_json_end(json);
+}
+
+BENCH(Reproject, Gen1) {
+	bench_model(json, "gen1", &survive_reproject_gen1_model);
+	return 0;
+}
+
+BENCH(Reproject, Gen2) {
+	bench_model(json, "gen2", &survive_reproject_gen2_model);
+	return 0;
+}
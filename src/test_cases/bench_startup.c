@@ -0,0 +1,100 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Time to first pose, and to a stable pose, when replaying a recording. Every recording is replayed three times: cold,
+ * with an empty config file and lighthouse cache; cached, with an empty config file but the lighthouse cache the cold
+ * run filled in; and warm, with the config file the cold run left behind -- so the differences show what the
+ * lighthouse cache and persisted calibration save. Replays leave the lighthouse cache alone unless it's given
+ * explicitly, so it is. Object and lighthouse phases are reported in recording time, which is what a live session
+ * would have waited for; context phases in wall time. Recordings are taken from the benchmark arguments; without any,
+ * a simulated session is recorded first.
+ */
+
+#define DEFAULT_RECORDING "bench-startup.rec.gz"
+#define CONFIG_FILE "bench-startup-config.json"
+#define LIGHTHOUSE_CACHE_FILE "bench-startup-lighthouse-cache.json"
+
+static double mark_time(const SurviveStartupMark *m, bool run_time) {
+	if (m == 0)
+		return NAN;
+	return run_time ? m->run_time : m->wall_time;
+}
+
+static void write_profile(cstring *json, SurviveContext *ctx) {
+	for (int phase = 0; phase < survive_startup_phase_count; phase++)
+		survive_bench_json_number(json, survive_startup_phase_name(phase),
+								  mark_time(survive_startup_get(ctx, phase), false));
+
+	survive_bench_json_begin(json, "objects");
+	for (int i = 0; i < ctx->objs_ct; i++) {
+		SurviveObject *so = ctx->objs[i];
+		survive_bench_json_begin(json, so->codename);
+		for (int phase = 0; phase < survive_startup_object_phase_count; phase++)
+			survive_bench_json_number(json, survive_startup_object_phase_name(phase),
+									  mark_time(survive_startup_get_object(so, phase), true));
+		survive_bench_json_number(json, "first pose wall time",
+								  mark_time(survive_startup_get_object(so, survive_startup_object_phase_first_pose), false));
+		survive_bench_json_end(json);
+	}
+	survive_bench_json_end(json);
+
+	survive_bench_json_begin(json, "lighthouses");
+	for (int lh = 0; lh < ctx->activeLighthouses; lh++) {
+		char name[16];
+		snprintf(name, sizeof(name), "LH%d", lh);
+		survive_bench_json_begin(json, name);
+		for (int phase = 0; phase < survive_startup_lighthouse_phase_count; phase++)
+			survive_bench_json_number(json, survive_startup_lighthouse_phase_name(phase),
+									  mark_time(survive_startup_get_lighthouse(ctx, lh, phase), true));
+		survive_bench_json_end(json);
+	}
+	survive_bench_json_end(json);
+}
+
+static int bench_file(cstring *json, const char *fn, const char *name) {
+	char *args[] = {"bench-startup", "--playback",			(char *)fn,			  "--playback-factor",
+					"0",			 "--configfile",		CONFIG_FILE,		  "--lighthouse-cache",
+					LIGHTHOUSE_CACHE_FILE};
+
+	SurviveContext *ctx = survive_init(SURVIVE_ARRAY_SIZE(args), args);
+	if (ctx == 0)
+		return -1;
+
+	int rtn = survive_startup(ctx);
+	while (rtn == 0 && survive_poll(ctx) == 0) {
+	}
+
+	survive_bench_json_begin(json, name);
+	write_profile(json, ctx);
+	survive_bench_json_end(json);
+
+	survive_close(ctx);
+	return rtn;
+}
+
+static int bench_cold_and_warm(cstring *json, const char *fn) {
+	survive_bench_json_begin(json, fn);
+	remove(CONFIG_FILE);
+	remove(LIGHTHOUSE_CACHE_FILE);
+	int rtn = bench_file(json, fn, "cold");
+
+	// The warm run gets the config file the cold one wrote, so it's set aside while the cached run goes
+	rename(CONFIG_FILE, CONFIG_FILE ".warm");
+	rtn |= bench_file(json, fn, "cached");
+	remove(CONFIG_FILE);
+	rename(CONFIG_FILE ".warm", CONFIG_FILE);
+
+	rtn |= bench_file(json, fn, "warm");
+	survive_bench_json_end(json);
+	return rtn;
+}
+
+BENCH(Startup, TimeToPose) {
+	int rtn = survive_bench_recordings(json, argc, argv, DEFAULT_RECORDING, CONFIG_FILE, bench_cold_and_warm);
+	remove(CONFIG_FILE);
+	remove(LIGHTHOUSE_CACHE_FILE);
+	return rtn;
+}
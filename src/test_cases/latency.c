@@ -0,0 +1,35 @@
+#include "survive_latency.h"
+#include "test_case.h"
+
+TEST(Latency, Percentiles) {
+	survive_latency_histogram h = {0};
+
+	// 1us..1ms, uniformly; bucket bounds are within 1/16th of the value
+	for (uint64_t i = 1; i <= 1000; i++)
+		survive_latency_histogram_add(&h, i * 1000);
+
+	ASSERT_EQ(h.cnt, 1000);
+	ASSERT_EQ(h.max_ns, 1000000);
+
+	uint64_t p50 = survive_latency_histogram_percentile(&h, .5);
+	ASSERT_GE(p50, 500000);
+	ASSERT_LE(p50, 500000 + 500000 / 16);
+
+	uint64_t p99 = survive_latency_histogram_percentile(&h, .99);
+	ASSERT_GE(p99, 990000);
+	ASSERT_LE(p99, 1000000);
+
+	ASSERT_EQ(survive_latency_histogram_percentile(&h, 1.), 1000000);
+
+	// Small values are exact; huge ones end in the last bucket
+	survive_latency_histogram_reset(&h);
+	survive_latency_histogram_add(&h, 3);
+	ASSERT_EQ(survive_latency_histogram_percentile(&h, .5), 3);
+	survive_latency_histogram_add(&h, 1ull << 40);
+	ASSERT_EQ(h.counts[SURVIVE_LATENCY_BUCKET_CNT - 1], 1);
+
+	SurviveLatencySummary s;
+	survive_latency_histogram_summary(&h, &s);
+	ASSERT_EQ(s.cnt, 2);
+	return 0;
+}
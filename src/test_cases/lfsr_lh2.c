@@ -0,0 +1,47 @@
+#include "../lfsr_lh2.h"
+#include "test_case.h"
+
+extern lfsr_poly_t poly_pairs[32];
+
+// Four sweeps of a lighthouse on channel `poly` whose bits start `n` bits into its sequence
+static int check_channel(int poly, uint32_t n, uint32_t hole_cnt) {
+	uint32_t samples[4], masks[4], times[4], output[4] = {0};
+	uint32_t expected[4];
+	for (int k = 0; k < 4; k++) {
+		uint32_t nk = n + k * 41 + (uint32_t)(rand() % 50);
+		samples[k] = lsfr_iterate(1, poly_pairs[poly], nk);
+		times[k] = 8 * nk;
+		// The position of the oldest of the 32 bits
+		expected[k] = nk - 15;
+
+		masks[k] = 0xFFFFFFFF;
+		for (uint32_t h = 0; h < hole_cnt; h++)
+			masks[k] &= ~(1u << (rand() % 32));
+		// Whatever isn't seen may as well be wrong
+		samples[k] ^= ~masks[k] & (uint32_t)rand();
+	}
+
+	survive_channel channel = survive_decipher_channel(samples, masks, times, output, 4);
+	if (channel == 255)
+		return 0; // Too many holes to tell the channels apart; not an error
+	ASSERT_EQ(channel, poly);
+	for (int k = 0; k < 4; k++)
+		ASSERT_EQ(output[k], expected[k]);
+	return 1;
+}
+
+TEST(LFSR, DecipherChannel) {
+	srand(42);
+	int solved = 0, total = 0;
+	for (int i = 0; i < 2000; i++) {
+		int rtn = check_channel(i % 32, 100 + rand() % 100000, i % 3 == 0 ? 0 : rand() % 6);
+		if (rtn < 0)
+			return rtn;
+		solved += rtn;
+		total++;
+	}
+
+	// Holes can leave a set of samples ambiguous between channels, but most should resolve
+	ASSERT_GT(solved, total * 3 / 4);
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "../ootx_fusion.h"
+#include "test_case.h"
+
+#define PERIOD (1. / 50.)
+#define ROTATIONS 100
+
+static int truth(int k) { return (k * 7 % 5) > 1; }
+
+// Syncs of the same rotation reach each device a little apart
+static size_t vote(survive_ootx_fusion *fusion, int dev, int k, int bit, int8_t *decoded, size_t cnt) {
+	return cnt + survive_ootx_fusion_vote(fusion, 10 + k * PERIOD + dev * .002, bit, decoded + cnt);
+}
+
+TEST(OOTXFusion, MajorityWins) {
+	survive_ootx_fusion fusion;
+	survive_ootx_fusion_init(&fusion, PERIOD);
+
+	// Each rotation, a different one of three devices gets the bit wrong
+	int8_t decoded[ROTATIONS + OOTX_FUSION_SLOTS];
+	size_t cnt = 0;
+	for (int k = 0; k < ROTATIONS; k++) {
+		for (int dev = 0; dev < 3; dev++)
+			cnt = vote(&fusion, dev, k, truth(k) ^ (k % 3 == dev), decoded, cnt);
+	}
+
+	ASSERT_EQ(cnt, ROTATIONS - OOTX_FUSION_DELAY);
+	for (size_t k = 0; k < cnt; k++)
+		ASSERT_EQ(decoded[k], truth(k));
+
+	ASSERT_EQ(fusion.stats.votes, 3 * ROTATIONS);
+	ASSERT_EQ(fusion.stats.late_votes, 0);
+	ASSERT_EQ(fusion.stats.shared_bits, cnt);
+	ASSERT_EQ(fusion.stats.split_bits, cnt);
+	ASSERT_EQ(fusion.stats.tied_bits, 0);
+	ASSERT_EQ(fusion.stats.unseen_bits, 0);
+	return 0;
+}
+
+TEST(OOTXFusion, TiesAndUnseenAreGuesses) {
+	survive_ootx_fusion fusion;
+	survive_ootx_fusion_init(&fusion, PERIOD);
+
+	// Two devices that disagree on even rotations; nobody sees 50 to 52, and only device 1 sees 60
+	int8_t decoded[ROTATIONS + OOTX_FUSION_SLOTS];
+	size_t cnt = 0;
+	for (int k = 0; k < ROTATIONS; k++) {
+		if (k >= 50 && k <= 52)
+			continue;
+		for (int dev = 0; dev < 2; dev++) {
+			if (k == 60 && dev == 0)
+				continue;
+			cnt = vote(&fusion, dev, k, truth(k) ^ (k % 2 == 0 && dev == 1), decoded, cnt);
+		}
+	}
+
+	ASSERT_EQ(cnt, ROTATIONS - OOTX_FUSION_DELAY);
+	for (size_t k = 0; k < cnt; k++) {
+		if (k >= 50 && k <= 52) {
+			ASSERT_EQ(decoded[k], -1);
+		} else if (k == 60) {
+			ASSERT_EQ(decoded[k], !truth(k));
+		} else if (k % 2 == 0) {
+			ASSERT_EQ(decoded[k], -1);
+		} else {
+			ASSERT_EQ(decoded[k], truth(k));
+		}
+	}
+
+	// 49 even rotations are decided, less the three that weren't tied
+	ASSERT_EQ(fusion.stats.tied_bits, 46);
+	ASSERT_EQ(fusion.stats.unseen_bits, 3);
+	ASSERT_EQ(fusion.stats.split_bits, 46);
+
+	// A rotation that was decided already doesn't count any more
+	ASSERT_EQ(vote(&fusion, 0, 0, 1, decoded, 0), 0);
+	ASSERT_EQ(fusion.stats.late_votes, 1);
+	return 0;
+}
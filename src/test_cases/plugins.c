@@ -0,0 +1,44 @@
+#include "../survive_internal.h"
+#include "test_case.h"
+#include <stdio.h>
+
+/**
+ * With the plugin manifest the build writes next to the plugins, a session only loads the plugins its configuration
+ * names. There is no manifest in static builds, and SURVIVE_PLUGINS_EAGER ignores it; the test passes trivially then.
+ */
+
+#define CONFIG_FILE "test-plugins-config.json"
+
+static int check_loaded_plugins() {
+	ASSERT_EQ(survive_plugin_loaded_for("DriverRegSimulator"), 1);
+	ASSERT_EQ(survive_plugin_loaded_for("PoserBaryCentricSVD"), 1);
+	ASSERT_EQ(survive_plugin_loaded_for("DisambiguatorStateBased"), 1);
+
+	ASSERT_EQ(survive_plugin_loaded_for("PoserMPFIT"), 0);
+	ASSERT_EQ(survive_plugin_loaded_for("DriverRegPlayback"), 0);
+	ASSERT_EQ(survive_plugin_loaded_for("DriverRegDummy"), 0);
+	return 0;
+}
+
+TEST(Plugins, ManifestLoadsOnlyConfigured) {
+	char *args[] = {"test-plugins", "--simulator", "--simulator-time", "0.1", "--time-factor",
+					"0",			"--poser",	   "BaryCentricSVD",	"--configfile", CONFIG_FILE};
+
+	remove(CONFIG_FILE);
+	SurviveContext *ctx = survive_init(SURVIVE_ARRAY_SIZE(args), args);
+	if (ctx == 0)
+		return survive_test_assert();
+
+	int rtn = 0;
+	if (survive_plugin_loaded_for("DriverRegSimulator") == -1) {
+		TEST_PRINTF("No plugin manifest; nothing to check\n");
+	} else {
+		rtn = survive_startup(ctx);
+		if (rtn == 0)
+			rtn = check_loaded_plugins();
+	}
+
+	survive_close(ctx);
+	remove(CONFIG_FILE);
+	return rtn;
+}
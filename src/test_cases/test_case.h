@@ -33,13 +33,19 @@ static inline int survive_test_assert() { return -1; }
 
 #define ASSERT_GE(val1, val2)                                                                                          \
 	if ((val1) < (val2)) {                                                                                             \
-		fprintf(stderr, "Assert failed: " #val1 " < " #val2 ": %f < %f\n", val1, val2);                                \
+		fprintf(stderr, "Assert failed: " #val1 " < " #val2 ": %f < %f\n", (double)(val1), (double)(val2));            \
 		return survive_test_assert();                                                                                  \
 	}
 
 #define ASSERT_GT(val1, val2)                                                                                          \
 	if ((val1) <= (val2)) {                                                                                            \
-		fprintf(stderr, "Assert failed: " #val1 " <= " #val2 ": %f <= %f\n", val1, val2);                              \
+		fprintf(stderr, "Assert failed: " #val1 " <= " #val2 ": %f <= %f\n", (double)(val1), (double)(val2));          \
+		return survive_test_assert();                                                                                  \
+	}
+
+#define ASSERT_LE(val1, val2)                                                                                          \
+	if ((val1) > (val2)) {                                                                                             \
+		fprintf(stderr, "Assert failed: " #val1 " > " #val2 ": %f > %f\n", (double)(val1), (double)(val2));            \
 		return survive_test_assert();                                                                                  \
 	}
 